@@ -0,0 +1,235 @@
+// Compares thread-per-stage streams with coroutine stages on a shared pool.
+// Each stream is decode -> detect -> output -> encode with simulated work per
+// stage; detect also borrows one of `sessions` inference slots, as with a
+// pool of model sessions. The thread design starts four threads per stream
+// (the last one standing in for AsyncVideoWriter) joined by BoundedQueues.
+// The coroutine design runs decode, detect and output with inline encoding
+// as coroutines on one thread per core, and hands inference to one thread
+// per session, as CoroutinePipeline does. Reports the OS thread count,
+// throughput, CPU use and context switches.
+//
+// Usage: bench_coro_streams [streams] [frames_per_stream] [infer_us] [sessions]
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <fstream>
+#include "../headers/bounded_queue.h"
+#include "../headers/coro_executor.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct CpuSample {
+    double cpu_sec = 0.0;
+    long ctx_switches = 0;
+};
+
+static CpuSample sampleCpu() {
+    CpuSample s;
+#ifdef _WIN32
+    FILETIME create, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &create, &exit, &kernel, &user);
+    auto toSec = [](const FILETIME& ft) {
+        ULARGE_INTEGER v; v.LowPart = ft.dwLowDateTime; v.HighPart = ft.dwHighDateTime;
+        return v.QuadPart / 1e7;
+    };
+    s.cpu_sec = toSec(kernel) + toSec(user);
+#else
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    s.cpu_sec = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    s.ctx_switches = ru.ru_nvcsw + ru.ru_nivcsw;
+#endif
+    return s;
+}
+
+// Threads in this process, or -1 where /proc is not available.
+static int osThreads() {
+    ifstream status("/proc/self/status");
+    string key;
+    while (status >> key) {
+        if (key == "Threads:") {
+            int n = -1;
+            status >> n;
+            return n;
+        }
+        status.ignore(4096, '\n');
+    }
+    return -1;
+}
+
+static void busyWork(int work_us) {
+    auto until = Clock::now() + chrono::microseconds(work_us);
+    while (Clock::now() < until) {
+    }
+}
+
+struct Work {
+    int decode_us = 300;
+    int pre_us = 200;
+    int infer_us = 2000;
+    int output_us = 300;
+    int encode_us = 500;
+};
+
+// Counting semaphore standing in for InferEnginePool::acquire().
+class Slots {
+public:
+    explicit Slots(int n) : free_(n) {}
+    void acquire() {
+        unique_lock<mutex> lock(mtx_);
+        cv_.wait(lock, [this] { return free_ > 0; });
+        free_--;
+    }
+    void release() {
+        { lock_guard<mutex> lock(mtx_); free_++; }
+        cv_.notify_one();
+    }
+private:
+    mutex mtx_;
+    condition_variable cv_;
+    int free_;
+};
+
+static void report(const char* name, int threads, long frames, double elapsed, CpuSample cpu0, CpuSample cpu1) {
+    cout << "  " << setw(10) << name << "  threads " << setw(4) << threads
+         << "  " << setw(9) << frames / elapsed << " frames/s"
+         << "  cpu " << setw(7) << (cpu1.cpu_sec - cpu0.cpu_sec) / elapsed * 100 << " %"
+         << "  ctx switches " << (cpu1.ctx_switches - cpu0.ctx_switches) << endl;
+}
+
+static void threadPerStage(int streams, int frames, int sessions, const Work& work) {
+    Slots slots(sessions);
+    vector<unique_ptr<BoundedQueue<int>>> decoded, detected, rendered;
+    for (int s = 0; s < streams; s++) {
+        decoded.push_back(make_unique<BoundedQueue<int>>(4));
+        detected.push_back(make_unique<BoundedQueue<int>>(4));
+        rendered.push_back(make_unique<BoundedQueue<int>>(8));
+    }
+
+    CpuSample cpu0 = sampleCpu();
+    auto start = Clock::now();
+    vector<thread> threads;
+    for (int s = 0; s < streams; s++) {
+        threads.emplace_back([&, s] {
+            for (int i = 0; i < frames; i++) {
+                busyWork(work.decode_us);
+                decoded[s]->push(i);
+            }
+            decoded[s]->close();
+        });
+        threads.emplace_back([&, s] {
+            int f;
+            while (decoded[s]->pop(f)) {
+                busyWork(work.pre_us);
+                slots.acquire();
+                busyWork(work.infer_us);
+                slots.release();
+                detected[s]->push(f);
+            }
+            detected[s]->close();
+        });
+        threads.emplace_back([&, s] {
+            int f;
+            while (detected[s]->pop(f)) {
+                busyWork(work.output_us);
+                rendered[s]->push(f);
+            }
+            rendered[s]->close();
+        });
+        threads.emplace_back([&, s] {
+            int f;
+            while (rendered[s]->pop(f)) busyWork(work.encode_us);
+        });
+    }
+    int os_threads = osThreads();
+    for (auto& t : threads) t.join();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+    report("threads", os_threads > 0 ? os_threads : static_cast<int>(threads.size()) + 1,
+           static_cast<long>(streams) * frames, elapsed, cpu0, sampleCpu());
+}
+
+static CoTask decodeStage(CoExecutor& ex, CoQueue<int>& out, int frames, const Work& work) {
+    for (int i = 0; i < frames; i++) {
+        busyWork(work.decode_us);
+        if (!co_await out.push(i)) break;
+        co_await ex.schedule();
+    }
+    out.close();
+}
+
+static CoTask detectStage(CoExecutor& ex, CoExecutor& infer, CoQueue<int>& in, CoQueue<int>& out,
+                          CoQueue<int>& slots, const Work& work) {
+    int f;
+    while (co_await in.pop(f)) {
+        busyWork(work.pre_us);
+        int slot;
+        co_await slots.pop(slot);
+        co_await infer.schedule();
+        busyWork(work.infer_us);
+        co_await ex.schedule();
+        slots.tryPush(slot);
+        if (!co_await out.push(f)) break;
+    }
+    out.close();
+}
+
+static CoTask outputStage(CoQueue<int>& in, const Work& work) {
+    int f;
+    while (co_await in.pop(f)) busyWork(work.output_us + work.encode_us);
+}
+
+static void coroutines(int streams, int frames, int sessions, const Work& work) {
+    CoExecutor ex, infer(sessions);
+    CoQueue<int> slots(ex, sessions);
+    for (int i = 0; i < sessions; i++) slots.tryPush(i);
+    vector<unique_ptr<CoQueue<int>>> decoded, detected;
+    for (int s = 0; s < streams; s++) {
+        decoded.push_back(make_unique<CoQueue<int>>(ex, 4));
+        detected.push_back(make_unique<CoQueue<int>>(ex, 4));
+    }
+
+    CpuSample cpu0 = sampleCpu();
+    auto start = Clock::now();
+    for (int s = 0; s < streams; s++) {
+        ex.spawn(decodeStage(ex, *decoded[s], frames, work));
+        ex.spawn(detectStage(ex, infer, *decoded[s], *detected[s], slots, work));
+        ex.spawn(outputStage(*detected[s], work));
+    }
+    int os_threads = osThreads();
+    ex.wait();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+    report("coroutines", os_threads > 0 ? os_threads : ex.threads() + infer.threads() + 1,
+           static_cast<long>(streams) * frames, elapsed, cpu0, sampleCpu());
+    cout << "              resumes " << ex.resumes() << endl;
+}
+
+int main(int argc, char** argv) {
+    int streams = argc > 1 ? stoi(argv[1]) : 32;
+    int frames = argc > 2 ? stoi(argv[2]) : 100;
+    Work work;
+    if (argc > 3) work.infer_us = stoi(argv[3]);
+    int cores = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    int sessions = argc > 4 ? stoi(argv[4]) : cores;
+
+    cout << fixed << setprecision(2);
+    cout << streams << " streams x " << frames << " frames, work us decode=" << work.decode_us
+         << " pre=" << work.pre_us << " infer=" << work.infer_us << " output=" << work.output_us
+         << " encode=" << work.encode_us
+         << ", " << sessions << " sessions, " << cores << " hardware threads:" << endl;
+    threadPerStage(streams, frames, sessions, work);
+    coroutines(streams, frames, sessions, work);
+    return 0;
+}
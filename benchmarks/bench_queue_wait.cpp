@@ -0,0 +1,127 @@
+// Compares FrameQueue wait strategies: condition variable vs. adaptive
+// spin-then-futex. Reports one-way wake latency from a ping-pong between two
+// threads, and throughput plus CPU use for a producer feeding a consumer that
+// does a fixed amount of work per frame.
+//
+// Usage: bench_queue_wait [iterations] [work_us]
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "../headers/frame_queue.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct CpuSample {
+    double cpu_sec = 0.0;
+    long ctx_switches = 0;
+};
+
+static CpuSample sampleCpu() {
+    CpuSample s;
+#ifdef _WIN32
+    FILETIME create, exit, kernel, user;
+    GetProcessTimes(GetCurrentProcess(), &create, &exit, &kernel, &user);
+    auto toSec = [](const FILETIME& ft) {
+        ULARGE_INTEGER v; v.LowPart = ft.dwLowDateTime; v.HighPart = ft.dwHighDateTime;
+        return v.QuadPart / 1e7;
+    };
+    s.cpu_sec = toSec(kernel) + toSec(user);
+#else
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    s.cpu_sec = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 + ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+    s.ctx_switches = ru.ru_nvcsw + ru.ru_nivcsw;
+#endif
+    return s;
+}
+
+static const char* name(WaitStrategy s) {
+    return s == WaitStrategy::ConditionVariable ? "condvar" : "spin+futex";
+}
+
+static void busyWork(int work_us) {
+    auto until = Clock::now() + chrono::microseconds(work_us);
+    while (Clock::now() < until) {
+    }
+}
+
+// Two queues of capacity 1; each side waits for the other's frame before replying.
+static void pingPong(WaitStrategy strategy, int iterations) {
+    FrameQueue ping(1, strategy), pong(1, strategy);
+    cv::Mat frame = cv::Mat::zeros(4, 4, CV_8UC3);
+
+    thread echo([&] {
+        FrameEnvelope f;
+        while (ping.pop(f)) {
+            if (!pong.push(f)) break;
+        }
+    });
+
+    CpuSample cpu0 = sampleCpu();
+    auto start = Clock::now();
+    FrameEnvelope f;
+    for (int i = 0; i < iterations; i++) {
+        ping.push(FrameEnvelope(frame, 0, static_cast<uint64_t>(i)));
+        pong.pop(f);
+    }
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+    CpuSample cpu1 = sampleCpu();
+
+    ping.close();
+    pong.close();
+    echo.join();
+
+    cout << "  " << setw(10) << name(strategy)
+         << "  one-way wake " << setw(7) << (elapsed / iterations / 2) * 1e6 << " us"
+         << "  cpu " << setw(6) << (cpu1.cpu_sec - cpu0.cpu_sec) / elapsed * 100 << " %"
+         << "  ctx switches " << (cpu1.ctx_switches - cpu0.ctx_switches) << endl;
+}
+
+// Producer feeds a consumer that spends work_us per frame, queue capacity 8.
+static void streaming(WaitStrategy strategy, int iterations, int work_us) {
+    FrameQueue fq(8, strategy);
+    cv::Mat frame = cv::Mat::zeros(4, 4, CV_8UC3);
+
+    CpuSample cpu0 = sampleCpu();
+    auto start = Clock::now();
+    thread consumer([&] {
+        FrameEnvelope f;
+        while (fq.pop(f)) busyWork(work_us);
+    });
+    for (int i = 0; i < iterations; i++) {
+        fq.push(FrameEnvelope(frame, 0, static_cast<uint64_t>(i)));
+    }
+    fq.close();
+    consumer.join();
+    double elapsed = chrono::duration<double>(Clock::now() - start).count();
+    CpuSample cpu1 = sampleCpu();
+
+    cout << "  " << setw(10) << name(strategy)
+         << "  " << setw(9) << iterations / elapsed << " frames/s"
+         << "  cpu " << setw(6) << (cpu1.cpu_sec - cpu0.cpu_sec) / elapsed * 100 << " %"
+         << "  ctx switches " << (cpu1.ctx_switches - cpu0.ctx_switches) << endl;
+}
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? stoi(argv[1]) : 100000;
+    int work_us = argc > 2 ? stoi(argv[2]) : 20;
+
+    cout << fixed << setprecision(2);
+    cout << "Ping-pong (" << iterations << " round trips):" << endl;
+    for (auto s : {WaitStrategy::ConditionVariable, WaitStrategy::SpinThenPark}) pingPong(s, iterations);
+
+    cout << "Streaming (" << iterations << " frames, " << work_us << " us work per frame):" << endl;
+    for (auto s : {WaitStrategy::ConditionVariable, WaitStrategy::SpinThenPark}) streaming(s, iterations, work_us);
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Compares greedy and optimal track/detection matching. Each scene has n
+// objects drifting with jitter; a fraction of them move in crowded groups
+// where boxes overlap several neighbours. Reports time per Tracker::update
+// and how many track ids changed hands or were lost along the way.
+//
+// Usage: bench_tracker [frames] [crowded_percent]
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include "../headers/tracker.h"
+
+using namespace std;
+using Clock = chrono::steady_clock;
+
+struct Object {
+    cv::Rect2f box;
+    float vx, vy;
+};
+
+// n objects on a canvas scaled so density stays the same as n grows;
+// crowded objects start in tight clusters of four.
+static vector<Object> makeScene(int n, int crowded_percent, mt19937& rng) {
+    const float side = 120.0f * sqrt(static_cast<float>(n));
+    uniform_real_distribution<float> pos(0.0f, side), vel(-4.0f, 4.0f), offset(-20.0f, 20.0f);
+    vector<Object> objects;
+    int crowded = n * crowded_percent / 100;
+    while (static_cast<int>(objects.size()) < crowded) {
+        float x = pos(rng), y = pos(rng);
+        for (int k = 0; k < 4 && static_cast<int>(objects.size()) < crowded; k++) {
+            objects.push_back({cv::Rect2f(x + offset(rng), y + offset(rng), 60, 60), vel(rng), vel(rng)});
+        }
+    }
+    while (static_cast<int>(objects.size()) < n) {
+        objects.push_back({cv::Rect2f(pos(rng), pos(rng), 60, 60), vel(rng), vel(rng)});
+    }
+    return objects;
+}
+
+static void run(TrackMatch match, int n, int frames, int crowded_percent) {
+    mt19937 rng(42);
+    vector<Object> objects = makeScene(n, crowded_percent, rng);
+    normal_distribution<float> jitter(0.0f, 3.0f);
+
+    TrackerConfig config;
+    config.match = match;
+    config.allowed_classes.clear();
+    Tracker tracker(config);
+
+    // Object index -> track id from the first frame; an id showing up on a
+    // different object later is a switch.
+    vector<int> id_of(n, 0);
+    int switches = 0;
+    double seconds = 0.0;
+    vector<Detection> detections(n);
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < n; i++) {
+            auto& o = objects[i];
+            o.box.x += o.vx;
+            o.box.y += o.vy;
+            detections[i] = {cv::Rect2f(o.box.x + jitter(rng), o.box.y + jitter(rng), o.box.width, o.box.height),
+                             0.9f, 2};
+        }
+        auto start = Clock::now();
+        const auto& tracks = tracker.update(detections);
+        seconds += chrono::duration<double>(Clock::now() - start).count();
+
+        for (const auto& t : tracks) {
+            if (t.lost != 0) continue;
+            for (int i = 0; i < n; i++) {
+                if (t.box.x != detections[i].box.x || t.box.y != detections[i].box.y) continue;
+                if (id_of[i] == 0) id_of[i] = t.id;
+                else if (id_of[i] != t.id) { switches++; id_of[i] = t.id; }
+                break;
+            }
+        }
+    }
+
+    cout << "  " << setw(5) << n << " objects  " << setw(8) << (match == TrackMatch::Greedy ? "greedy" : "optimal")
+         << "  " << setw(9) << seconds / frames * 1e6 << " us/update"
+         << "  id switches " << switches << endl;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? stoi(argv[1]) : 300;
+    int crowded_percent = argc > 2 ? stoi(argv[2]) : 30;
+
+    cout << fixed << setprecision(1);
+    cout << frames << " frames, " << crowded_percent << "% of objects in crowded groups:" << endl;
+    for (int n : {10, 100, 1000}) {
+        for (auto m : {TrackMatch::Greedy, TrackMatch::Optimal}) run(m, n, frames, crowded_percent);
+    }
+    return 0;
+}
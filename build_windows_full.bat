@@ -31,11 +31,11 @@ if "%OPENCV_DIR%"=="" (
 set PATH=%ORT_DIR%\bin;%OPENCV_DIR%\x64\vc16\bin;%PATH%
 
 echo [*] Building inference_engine.exe
-cl /nologo /std:c++17 /EHsc ^
+cl /nologo /std:c++20 /EHsc ^
   /I headers ^
   /I "%ORT_DIR%\include" ^
   /I "%OPENCV_DIR%\include" ^
-  src\main.cpp src\infer_engine.cpp src\preprocess.cpp src\nms.cpp src\frame_queue.cpp src\frame.cpp ^
+  src\main.cpp src\infer_engine.cpp src\infer_engine_pool.cpp src\preprocess.cpp src\frame_envelope.cpp src\nms.cpp src\frame_queue.cpp src\queue_stats.cpp src\multi_lane_queue.cpp src\adaptive_wait.cpp src\tracker.cpp src\render.cpp src\video_writer.cpp src\pipeline.cpp src\pacing.cpp src\offline.cpp src\image_batch.cpp src\deadline_source.cpp src\frame_skip.cpp src\coro_executor.cpp src\coro_pipeline.cpp src\work_stealing_pool.cpp src\result_sink.cpp src\shm_ingest.cpp src\assignment.cpp src\frame.cpp ^
   "%ORT_DIR%\lib\onnxruntime.lib" ^
   "%OPENCV_DIR%\x64\vc16\lib\opencv_world4*.lib" ^
   /Fe:inference_engine.exe
@@ -46,7 +46,23 @@ if errorlevel 1 (
   exit /b 1
 )
 
-echo [OK] Build completed: inference_engine.exe
+echo [*] Building yolo_detect.dll (C API in headers\yolo_detect.h)
+cl /nologo /std:c++20 /EHsc /LD ^
+  /I headers ^
+  /I "%ORT_DIR%\include" ^
+  /I "%OPENCV_DIR%\include" ^
+  src\yolo_detect.cpp src\infer_engine.cpp src\preprocess.cpp src\frame_envelope.cpp src\nms.cpp src\tracker.cpp src\assignment.cpp src\work_stealing_pool.cpp ^
+  "%ORT_DIR%\lib\onnxruntime.lib" ^
+  "%OPENCV_DIR%\x64\vc16\lib\opencv_world4*.lib" ^
+  /Fe:yolo_detect.dll
+
+if errorlevel 1 (
+  echo [x] Library build failed.
+  pause
+  exit /b 1
+)
+
+echo [OK] Build completed: inference_engine.exe, yolo_detect.dll
 echo Run examples:
 echo   inference_engine.exe --model yolov8n.onnx --video 0
 echo   inference_engine.exe --model yolov8n.onnx --video data\sample_video.mp4 --conf 0.3
@@ -0,0 +1,54 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Pause hint for spin loops (PAUSE on x86, YIELD on ARM).
+void cpuRelax();
+
+// Blocks while `word` still holds `expected`, or until timeout_ms elapses
+// (negative waits forever). Returns false on timeout. Uses futex on Linux and
+// WaitOnAddress on Windows; `shared` selects a futex usable across processes
+// when the word lives in shared memory. May return spuriously.
+bool futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms = -1, bool shared = false);
+void futexWake(std::atomic<uint32_t>& word, int count, bool shared = false);
+
+// Event count that spins briefly with pause instructions before parking the
+// thread on a futex. Notifiers only enter the kernel when someone is actually
+// parked, so a hand-off between two busy threads costs no syscalls. The spin
+// budget adapts to observed wait times: it moves towards twice the length of
+// recent short waits and decays to kMinSpin when waits are long.
+class AdaptiveWaiter {
+public:
+    static constexpr uint32_t kMinSpin = 16;
+    static constexpr uint32_t kMaxSpin = 8192;
+
+    // Returns once pred() is true. pred() must only read state that is
+    // published before the matching notify call.
+    template <typename Pred>
+    void wait(Pred pred) {
+        for (;;) {
+            uint32_t seen = epoch_.load(std::memory_order_acquire);
+            if (pred()) return;
+            if (spinFor(seen)) continue;
+            park(seen);
+        }
+    }
+
+    void notifyOne() { notify(1); }
+    void notifyAll() { notify(INT32_MAX); }
+
+    uint32_t spinBudget() const { return spin_budget_.load(std::memory_order_relaxed); }
+    uint64_t parks() const { return parks_.load(std::memory_order_relaxed); }
+
+private:
+    bool spinFor(uint32_t seen);
+    void park(uint32_t seen);
+    void notify(int count);
+    void adjustBudget(uint64_t target_spins);
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<uint32_t> sleepers_{0};
+    std::atomic<uint32_t> spin_budget_{256};
+    std::atomic<uint32_t> ns_per_spin_{10};
+    std::atomic<uint64_t> parks_{0};
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <vector>
+
+// One admissible row/column pairing and how good it is (higher is better).
+// Pairs that are not listed can never be matched.
+struct AssignmentEdge {
+    int row;
+    int col;
+    float score;
+};
+
+// Matching of rows to columns over the listed edges that maximises the summed
+// score, e.g. tracks to detections scored by overlap. Returns the matched
+// column of each row, or -1.
+//
+// The edges split into independent clusters (rows and columns connected by
+// some chain of edges); each is solved on its own with a shortest augmenting
+// path solver in the style of Jonker-Volgenant. Cost therefore grows with
+// the size of the largest cluster of mutually overlapping boxes, not with
+// the total number of objects.
+std::vector<int> solveAssignment(int rows, int cols, const std::vector<AssignmentEdge>& edges);
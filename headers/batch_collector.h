@@ -0,0 +1,90 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "queue_stats.h"
+
+// Bounded queue whose consumers take items in batches, for dynamic batching
+// of independent requests. popBatch() waits for a first item, then keeps
+// collecting until it has max_batch items or the oldest of them has waited
+// max_delay, whichever comes first. A full batch therefore goes out at
+// once, and a lone request is delayed by at most max_delay.
+template <typename T>
+class BatchCollector {
+public:
+    using Clock = QueueStats::Clock;
+
+    explicit BatchCollector(size_t capacity) : capacity_(capacity) {}
+
+    // Blocks while full. Returns false once closed.
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_full_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back({std::move(item), Clock::now()});
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Appends up to max_batch items to out. Returns the number taken, 0 once
+    // closed and drained. Items left behind when out is full stay queued for
+    // the next call, with their original arrival time.
+    size_t popBatch(std::vector<T>& out, size_t max_batch, std::chrono::microseconds max_delay) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) {
+            return 0;
+        }
+        const auto deadline = items_.front().arrived + max_delay;
+        not_empty_.wait_until(lock, deadline, [&] { return items_.size() >= max_batch || closed_; });
+        size_t taken = 0;
+        while (!items_.empty() && taken < max_batch) {
+            wait_us_.record(QueueStats::elapsedMicros(items_.front().arrived));
+            out.push_back(std::move(items_.front().item));
+            items_.pop_front();
+            taken++;
+        }
+        lock.unlock();
+        not_full_.notify_all();
+        // Someone else may be able to start on what is left.
+        if (taken == max_batch) not_empty_.notify_one();
+        return taken;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return items_.size();
+    }
+
+    // Time items spent queued before their batch was taken.
+    Log2Histogram::Snapshot waitStats() const { return wait_us_.snapshot(); }
+
+private:
+    struct Entry {
+        T item;
+        Clock::time_point arrived;
+    };
+
+    mutable std::mutex mtx_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<Entry> items_;
+    size_t capacity_;
+    bool closed_ = false;
+    Log2Histogram wait_us_;
+};
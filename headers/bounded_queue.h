@@ -0,0 +1,129 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "queue_stats.h"
+
+// Blocking bounded MPMC queue for handing work between pipeline stages.
+// Same semantics as FrameQueue but for arbitrary movable items: push blocks
+// while full, pop blocks while empty, and after close() pushes fail while
+// pops drain what is left.
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity), stats_(capacity) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        bool blocked = items_.size() >= capacity_ && !closed_;
+        uint64_t wait_us = 0;
+        if (blocked) {
+            auto wait_start = QueueStats::Clock::now();
+            not_full_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+            wait_us = QueueStats::elapsedMicros(wait_start);
+        }
+        if (closed_) {
+            return false;
+        }
+        stats_.recordPush(items_.size(), blocked, wait_us);
+        items_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Like push() but fails instead of waiting while the queue is full; the
+    // rejected item is counted as a drop.
+    bool tryPush(T item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (closed_) {
+            return false;
+        }
+        if (items_.size() >= capacity_) {
+            stats_.recordDrop();
+            return false;
+        }
+        stats_.recordPush(items_.size(), false, 0);
+        items_.push_back(std::move(item));
+        lock.unlock();
+        not_empty_.notify_one();
+        return true;
+    }
+
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        bool blocked = items_.empty() && !closed_;
+        uint64_t wait_us = 0;
+        if (blocked) {
+            auto wait_start = QueueStats::Clock::now();
+            not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+            wait_us = QueueStats::elapsedMicros(wait_start);
+        }
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        stats_.recordPop(blocked, wait_us);
+        lock.unlock();
+        not_full_.notify_one();
+        return true;
+    }
+
+    // Blocks for the first item like pop(), then takes whatever else is
+    // already queued, up to max_items in total. Returns the number taken.
+    size_t popUpTo(std::vector<T>& out, size_t max_items) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        bool blocked = items_.empty() && !closed_;
+        uint64_t wait_us = 0;
+        if (blocked) {
+            auto wait_start = QueueStats::Clock::now();
+            not_empty_.wait(lock, [this] { return !items_.empty() || closed_; });
+            wait_us = QueueStats::elapsedMicros(wait_start);
+        }
+        size_t taken = 0;
+        while (!items_.empty() && taken < max_items) {
+            out.push_back(std::move(items_.front()));
+            items_.pop_front();
+            stats_.recordPop(taken == 0 && blocked, taken == 0 ? wait_us : 0);
+            taken++;
+        }
+        lock.unlock();
+        if (taken > 0) not_full_.notify_all();
+        return taken;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return closed_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return items_.size();
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    QueueStatsSnapshot stats() const { return stats_.snapshot(size()); }
+
+private:
+    mutable std::mutex mtx_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<T> items_;
+    size_t capacity_;
+    bool closed_ = false;
+    QueueStats stats_;
+};
@@ -0,0 +1,278 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// C++20 coroutines on a small fixed thread pool. A pipeline stage written as
+// a coroutine suspends instead of blocking when its input queue is empty, its
+// output queue is full or no inference session is free, so dozens of streams
+// can share as many threads as there are cores instead of needing a thread
+// per stage per stream.
+
+class CoExecutor;
+
+// Fire-and-forget coroutine started with CoExecutor::spawn(). The frame is
+// destroyed when the coroutine finishes; CoExecutor::wait() tells when all
+// of them have.
+class CoTask {
+public:
+    struct promise_type {
+        CoExecutor* executor = nullptr;
+
+        CoTask get_return_object() { return CoTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept;
+        void return_void() {}
+        void unhandled_exception();
+    };
+
+    CoTask(CoTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    CoTask(const CoTask&) = delete;
+    CoTask& operator=(const CoTask&) = delete;
+    ~CoTask() { if (handle_) handle_.destroy(); }
+
+private:
+    friend class CoExecutor;
+    explicit CoTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Fixed pool of threads resuming coroutines from one FIFO run queue.
+class CoExecutor {
+public:
+    // threads <= 0 uses one per hardware thread.
+    explicit CoExecutor(int threads = 0);
+    ~CoExecutor();
+
+    CoExecutor(const CoExecutor&) = delete;
+    CoExecutor& operator=(const CoExecutor&) = delete;
+
+    // Starts the task on a pool thread.
+    void spawn(CoTask task);
+
+    // Queues a suspended coroutine to be resumed on a pool thread.
+    void post(std::coroutine_handle<> handle);
+
+    // co_await schedule() re-queues the calling coroutine behind whatever
+    // is already runnable; long-running loops use it to stay fair.
+    auto schedule() {
+        struct Awaiter {
+            CoExecutor& executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    // Blocks until every spawned task has finished. Rethrows the first
+    // exception that escaped a task.
+    void wait();
+    // Like wait() but gives up after timeout_sec; returns true if all
+    // tasks have finished.
+    bool waitFor(double timeout_sec);
+
+    int threads() const { return static_cast<int>(workers_.size()); }
+    uint64_t resumes() const { return resumes_.load(std::memory_order_relaxed); }
+
+private:
+    friend struct CoTask::promise_type;
+
+    void workerLoop();
+    void taskDone();
+    void taskFailed(std::exception_ptr error);
+
+    std::mutex mtx_;
+    std::condition_variable ready_cv_;
+    std::condition_variable done_cv_;
+    std::deque<std::coroutine_handle<>> ready_;
+    bool stopping_ = false;
+    size_t outstanding_ = 0;
+    std::exception_ptr error_;
+    std::atomic<uint64_t> resumes_{0};
+    std::vector<std::thread> workers_;
+};
+
+inline auto CoTask::promise_type::final_suspend() noexcept {
+    struct Awaiter {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+            CoExecutor* executor = handle.promise().executor;
+            handle.destroy();
+            executor->taskDone();
+        }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{};
+}
+
+inline void CoTask::promise_type::unhandled_exception() {
+    executor->taskFailed(std::current_exception());
+}
+
+// Bounded MPMC queue for coroutines, the awaitable counterpart of
+// BoundedQueue: co_await push() suspends while the queue is full, co_await
+// pop() while it is empty. After close() pushes fail and pops drain what is
+// left. Suspended coroutines are resumed through the executor, never inline.
+template <typename T>
+class CoQueue {
+public:
+    CoQueue(CoExecutor& executor, size_t capacity) : executor_(executor), capacity_(capacity) {}
+
+    class PushAwaiter {
+    public:
+        PushAwaiter(CoQueue& queue, T item) : queue_(queue), item_(std::move(item)) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return queue_.suspendPush(*this);
+        }
+        // False if the queue was closed.
+        bool await_resume() const noexcept { return ok_; }
+
+    private:
+        friend class CoQueue;
+        CoQueue& queue_;
+        T item_;
+        bool ok_ = false;
+        std::coroutine_handle<> handle_;
+    };
+
+    class PopAwaiter {
+    public:
+        PopAwaiter(CoQueue& queue, T& out) : queue_(queue), out_(out) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return queue_.suspendPop(*this);
+        }
+        // False once the queue is closed and drained.
+        bool await_resume() const noexcept { return ok_; }
+
+    private:
+        friend class CoQueue;
+        CoQueue& queue_;
+        T& out_;
+        bool ok_ = false;
+        std::coroutine_handle<> handle_;
+    };
+
+    PushAwaiter push(T item) { return PushAwaiter(*this, std::move(item)); }
+    PopAwaiter pop(T& out) { return PopAwaiter(*this, out); }
+
+    // Push for callers that must not suspend, e.g. plain threads; fails if
+    // the queue is full or closed.
+    bool tryPush(T item) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (closed_ || (waiting_pop_.empty() && items_.size() >= capacity_)) return false;
+        if (!waiting_pop_.empty()) {
+            PopAwaiter* consumer = waiting_pop_.front();
+            waiting_pop_.pop_front();
+            consumer->out_ = std::move(item);
+            consumer->ok_ = true;
+            executor_.post(consumer->handle_);
+        } else {
+            items_.push_back(std::move(item));
+        }
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        closed_ = true;
+        for (PopAwaiter* waiter : waiting_pop_) {
+            waiter->ok_ = false;
+            executor_.post(waiter->handle_);
+        }
+        for (PushAwaiter* waiter : waiting_push_) {
+            waiter->ok_ = false;
+            executor_.post(waiter->handle_);
+        }
+        waiting_pop_.clear();
+        waiting_push_.clear();
+    }
+
+    bool isClosed() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return closed_;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return items_.size();
+    }
+
+    // How often push/pop had to suspend.
+    uint64_t pushSuspends() const { return push_suspends_.load(std::memory_order_relaxed); }
+    uint64_t popSuspends() const { return pop_suspends_.load(std::memory_order_relaxed); }
+
+private:
+    // Each returns false when the operation completed without suspending.
+    // A waiter must not be touched after its handle has been posted.
+    bool suspendPush(PushAwaiter& waiter) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (closed_) {
+            waiter.ok_ = false;
+            return false;
+        }
+        waiter.ok_ = true;
+        if (!waiting_pop_.empty()) {
+            // Queue is empty and a consumer waits: hand the item over.
+            PopAwaiter* consumer = waiting_pop_.front();
+            waiting_pop_.pop_front();
+            consumer->out_ = std::move(waiter.item_);
+            consumer->ok_ = true;
+            executor_.post(consumer->handle_);
+            return false;
+        }
+        if (items_.size() < capacity_) {
+            items_.push_back(std::move(waiter.item_));
+            return false;
+        }
+        waiting_push_.push_back(&waiter);
+        push_suspends_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool suspendPop(PopAwaiter& waiter) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!items_.empty()) {
+            waiter.out_ = std::move(items_.front());
+            items_.pop_front();
+            waiter.ok_ = true;
+            if (!waiting_push_.empty()) {
+                // Room was made: move the oldest blocked producer's item in.
+                PushAwaiter* producer = waiting_push_.front();
+                waiting_push_.pop_front();
+                items_.push_back(std::move(producer->item_));
+                executor_.post(producer->handle_);
+            }
+            return false;
+        }
+        if (closed_) {
+            waiter.ok_ = false;
+            return false;
+        }
+        waiting_pop_.push_back(&waiter);
+        pop_suspends_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    CoExecutor& executor_;
+    mutable std::mutex mtx_;
+    std::deque<T> items_;
+    std::deque<PushAwaiter*> waiting_push_;
+    std::deque<PopAwaiter*> waiting_pop_;
+    size_t capacity_;
+    bool closed_ = false;
+    std::atomic<uint64_t> push_suspends_{0};
+    std::atomic<uint64_t> pop_suspends_{0};
+};
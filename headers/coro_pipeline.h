@@ -0,0 +1,66 @@
+#pragma once
+#include <atomic>
+#include <exception>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include "coro_executor.h"
+#include "frame_envelope.h"
+#include "frame_skip.h"
+#include "infer_engine_pool.h"
+#include "nms.h"
+#include "pipeline.h"
+#include "queue_stats.h"
+#include "result_sink.h"
+#include "tracker.h"
+#include "video_writer.h"
+
+// Runs each stream as three coroutines on one shared CoExecutor:
+//   decode -> detect (preprocess, inference, postprocess) -> output (track, draw, encode)
+// connected by CoQueues of config.queue_capacity. A coroutine suspends
+// instead of blocking a thread when its queue is empty or full, when no
+// inference session is free, and while its inference runs: the call is
+// handed to a second executor with one thread per session, and the
+// coroutine resumes on the pool once it completes. Encoding runs inline in
+// the output coroutine. The thread count is therefore `threads` plus one per
+// session however many streams there are. Frames of a stream stay in order
+// because each of its stages is a single coroutine.
+//
+// Decoding runs as fast as downstream accepts (--pace max), so a slow
+// encoder holds decoding back rather than dropping frames. Frames carry no
+// deadline here: main rejects --latency-slo/--stream-slo with this pipeline. There is no
+// display window: pool threads cannot own HighGUI windows.
+class CoroutinePipeline {
+public:
+    CoroutinePipeline(const std::vector<std::string>& videos, InferEnginePool& engines,
+                      const PipelineConfig& config, int threads = 0);
+    ~CoroutinePipeline();
+
+    // Blocks until every stream has ended or `running` is cleared. Returns 0,
+    // or 1 if a stage of some stream failed; that stream's other stages
+    // are shut down and the rest carry on.
+    int run(std::atomic<bool>& running);
+
+    void reportStats(std::ostream& os) const;
+
+private:
+    struct Stream;
+
+    CoTask decode(Stream& stream, std::atomic<bool>& running);
+    CoTask detect(Stream& stream);
+    CoTask output(Stream& stream);
+    void stageFailed(const Stream& stream, const char* stage, std::exception_ptr error);
+
+    InferEnginePool& engines_;
+    PipelineConfig config_;
+    CoExecutor executor_;
+    CoExecutor infer_executor_;     // runs the inference calls, one thread per session
+    CoQueue<InferEngine*> sessions_;
+    FrameSkipController skip_;
+    std::vector<std::unique_ptr<Stream>> streams_;
+    std::unique_ptr<ResultSink> results_;
+    Log2Histogram infer_wait_us_;   // time a detect coroutine waited for a session
+    Log2Histogram latency_us_;
+    std::atomic<int> failed_stages_{0};
+};
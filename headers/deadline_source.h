@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "frame_source.h"
+#include "queue_stats.h"
+
+// Wraps a FrameSource and enforces a per-stream latency SLO: frames whose
+// capture-to-dequeue age already exceeds their stream's SLO are discarded in
+// pop() instead of being returned, so no preprocessing or inference is spent
+// on results that would arrive too late to be useful. Under overload this
+// leaves the compute to fresh frames.
+class DeadlineSource : public FrameSource {
+public:
+    // slo_ms <= 0 disables the check. Frames from source ids outside
+    // [0, streams) are always passed through.
+    DeadlineSource(FrameSource& inner, int streams, double slo_ms);
+
+    // Overrides the SLO of one stream; call before consumers start.
+    void setStreamSlo(int stream, double slo_ms);
+
+    bool pop(FrameEnvelope& frame) override;
+    void close() override { inner_.close(); }
+    bool isClosed() const override { return inner_.isClosed(); }
+
+    uint64_t passed(int stream) const;
+    uint64_t dropped(int stream) const;
+
+    // The inner source's stats, then per-stream SLO, pass/drop counts and
+    // dequeue age.
+    void reportStats(std::ostream& os) const override;
+
+private:
+    struct StreamState {
+        double slo_ms = 0.0;
+        std::atomic<uint64_t> passed{0};
+        std::atomic<uint64_t> dropped{0};
+        Log2Histogram age_us;  // capture-to-dequeue, all frames
+    };
+
+    FrameSource& inner_;
+    std::vector<std::unique_ptr<StreamState>> streams_;
+};
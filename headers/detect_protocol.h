@@ -0,0 +1,72 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Wire format between the local detection server (tools/detect_server.cpp)
+// and its clients, over a Unix domain stream socket in host byte order.
+//
+// A client sends a DetectRequest followed, for inline payloads, by
+// height * stride bytes of 8-bit BGR pixels. With a shared-memory payload
+// nothing follows: the pixels are read in place from shm_offset in the POSIX
+// shared-memory object shm_name, which the client created and keeps mapped.
+// The server replies with a DetectResponse and `count` DetectBox records.
+// Requests on one connection may be answered out of order; match them by id.
+// A client must not touch a shared-memory frame until its reply has arrived.
+
+constexpr uint32_t kDetectRequestMagic = 0x51524459;   // "YDRQ"
+constexpr uint32_t kDetectResponseMagic = 0x53524459;  // "YDRS"
+constexpr int kDetectMaxSide = 8192;
+// Largest row padding an inline payload may carry. Inline strides beyond
+// width * 3 + this are rejected before anything is read; a shared-memory
+// frame may be a view into a wider image and is bounded by its segment.
+constexpr int kDetectMaxRowPadding = 64;
+
+enum class DetectPayload : uint32_t {
+    Inline = 0,
+    SharedMemory = 1,
+};
+
+enum class DetectStatus : int32_t {
+    Ok = 0,
+    BadRequest = 1,       // malformed header, image size or payload kind; the connection is closed
+    SharedMemoryError = 2,
+    InferenceFailed = 3,
+};
+
+struct DetectRequest {
+    uint32_t magic = kDetectRequestMagic;
+    uint32_t id = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t stride = 0;        // bytes per row, width * 3 to width * 3 + kDetectMaxRowPadding inline
+    DetectPayload payload = DetectPayload::Inline;
+    uint64_t shm_offset = 0;
+    char shm_name[64] = {};    // NUL-terminated, e.g. "/cam0_frames"
+};
+
+struct DetectResponse {
+    uint32_t magic = kDetectResponseMagic;
+    uint32_t id = 0;
+    DetectStatus status = DetectStatus::Ok;
+    uint32_t count = 0;
+};
+
+// A detection in source pixels.
+struct DetectBox {
+    float x, y, w, h;
+    float conf;
+    int32_t cls;
+};
+
+static_assert(sizeof(DetectRequest) == 96, "DetectRequest layout");
+static_assert(sizeof(DetectResponse) == 16, "DetectResponse layout");
+static_assert(sizeof(DetectBox) == 24, "DetectBox layout");
+
+// Blocking helpers that retry on short transfers and EINTR. Both return
+// false on error or end of stream.
+bool readFull(int fd, void* data, size_t size);
+bool writeFull(int fd, const void* data, size_t size);
+
+// Connects to the server's socket; returns the descriptor or -1.
+int connectDetectServer(const std::string& socket_path);
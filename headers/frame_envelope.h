@@ -0,0 +1,54 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include "opencv_minimal.h"
+
+// Scale and padding applied by Preprocessor when letterboxing a frame into the
+// model input. Carried with each frame so postprocessing can map boxes back
+// without reading state from a shared Preprocessor.
+struct LetterboxTransform {
+    float scale = 1.0f;
+    cv::Point padding;
+    cv::Size source_size;
+
+    // Maps a box in model-input pixels back to the source frame, clipped to it.
+    cv::Rect2f toSource(const cv::Rect2f& model_box) const;
+};
+
+// A frame plus the metadata that has to travel with it through every stage.
+struct FrameEnvelope {
+    using Clock = std::chrono::steady_clock;
+
+    // Whether the frame goes through the model, when the producer already
+    // asked the frame-skip controller. A Skip frame was never decoded and
+    // carries no image; it travels so that its results still get a record.
+    enum class Inference : uint8_t { Undecided, Run, Skip };
+
+    cv::Mat image;
+    int source_id = 0;
+    uint64_t seq = 0;
+    Clock::time_point capture_time = Clock::now();
+    double timestamp_ms = -1.0;  // container timestamp, negative if unknown
+    double source_fps = 0.0;     // nominal rate of the source, 0 if unknown
+    LetterboxTransform letterbox;
+    // Owner of memory the image points into when it is not the image's own,
+    // e.g. a shared-memory slot that goes back to its producer once released.
+    // Queues share such pixels instead of copying them.
+    std::shared_ptr<void> buffer;
+    Inference inference = Inference::Undecided;
+
+    FrameEnvelope() = default;
+    FrameEnvelope(const cv::Mat& img, int source, uint64_t sequence)
+        : image(img), source_id(source), seq(sequence) {}
+
+    // Drops the pixels once nothing downstream needs them.
+    void releaseImage() {
+        image.release();
+        buffer.reset();
+    }
+
+    double ageMs(Clock::time_point now = Clock::now()) const {
+        return std::chrono::duration<double, std::milli>(now - capture_time).count();
+    }
+};
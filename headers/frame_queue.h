@@ -1,31 +1,64 @@
 #pragma once
+#include <atomic>
 #include <queue>
 #include <mutex>
 #include <condition_variable>
 #include "opencv_minimal.h"
+#include "adaptive_wait.h"
+#include "frame_envelope.h"
+#include "frame_source.h"
+#include "queue_stats.h"
 
-class FrameQueue {
+// How a blocked push/pop waits. ConditionVariable parks on every wait and
+// notifies through the kernel on every hand-off; SpinThenPark spins briefly
+// first and only makes a syscall when the other side is actually asleep.
+enum class WaitStrategy {
+    ConditionVariable,
+    SpinThenPark,
+};
+
+class FrameQueue : public FrameSource, public FrameSink {
 public:
-    explicit FrameQueue(size_t max_size = 10);
-    ~FrameQueue();
+    explicit FrameQueue(size_t max_size = 10, WaitStrategy strategy = WaitStrategy::ConditionVariable);
+    ~FrameQueue() override;
 
+    bool push(const FrameEnvelope& frame) override;
     bool push(const cv::Mat& frame);
 
+    bool pop(FrameEnvelope& frame) override;
     bool pop(cv::Mat& frame);
 
     bool empty() const;
     size_t size() const;
 
-    void close();
+    void close() override;
+
+    bool isClosed() const override;
+
+    QueueStatsSnapshot stats() const;
+    void resetStats();
+    void reportStats(std::ostream& os) const override;
 
-    bool isClosed() const;
+    WaitStrategy waitStrategy() const { return strategy_; }
 
 private:
+    void waitForSpace(std::unique_lock<std::mutex>& lock);
+    void waitForFrame(std::unique_lock<std::mutex>& lock);
+    void notifySpace();
+    void notifyFrame();
+
     mutable std::mutex mtx;
     std::condition_variable cv_push;
     std::condition_variable cv_pop;
 
-    std::queue<cv::Mat> q;
+    std::queue<FrameEnvelope> q;
     size_t max_size;
-    bool closed;
+    std::atomic<bool> closed;
+
+    WaitStrategy strategy_;
+    AdaptiveWaiter space_waiter_;
+    AdaptiveWaiter frame_waiter_;
+
+    QueueStats stats_;
+    std::atomic<size_t> size_{0};
 };
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <vector>
+#include "frame_envelope.h"
+#include "queue_stats.h"
+
+struct FrameSkipConfig {
+    double target_fps = 0.0;          // per stream; 0 follows the source's frame rate
+    int max_stride = 1;               // largest k; 1 runs inference on every frame
+    double hysteresis = 0.2;          // spare capacity needed before k is lowered
+    double update_interval_sec = 1.0; // how often k is reconsidered
+
+    bool enabled() const { return max_stride > 1; }
+};
+
+// Picks an inference stride k from measured processing cost: only every k-th
+// frame of a stream is run through the model, the frames in between reuse the
+// tracks of the last inferred one. k rises as soon as the consumer can no
+// longer keep up with the target rate and falls one step at a time, only once
+// the smaller stride leaves `hysteresis` spare capacity, so it does not flip
+// back and forth around the break-even point.
+class FrameSkipController {
+public:
+    // Frames of unknown rate are assumed to arrive at this many fps.
+    static constexpr double kDefaultFps = 30.0;
+
+    // parallelism is how many frames the measured stage handles at once.
+    FrameSkipController(const FrameSkipConfig& config, int streams = 1, int parallelism = 1);
+
+    // Decides whether the next frame of `stream` is inferred. Call once per
+    // frame, in that stream's order. source_fps may be 0 if unknown.
+    bool shouldInfer(int stream, double source_fps);
+    // Same, unless the producer already decided for this frame.
+    bool shouldInfer(const FrameEnvelope& frame);
+
+    // Reports the wall time one frame took on the measured stage.
+    void recordFrame(bool inferred, double service_ms);
+
+    bool enabled() const { return config_.enabled(); }
+    int stride() const;
+    // Frames per second all streams together should be kept up with.
+    double demandFps() const;
+    uint64_t inferred() const;
+    uint64_t skipped() const;
+
+    void reportStats(std::ostream& os) const;
+
+    // Smallest stride whose capacity covers demand_fps, raised immediately
+    // but lowered by at most one step and only with hysteresis headroom.
+    static int chooseStride(double demand_fps, double infer_ms, double skip_ms, int parallelism,
+                            int current, int max_stride, double hysteresis);
+    // Frames per second at stride k when inferred frames cost infer_ms and
+    // skipped ones skip_ms.
+    static double capacityFps(int k, double infer_ms, double skip_ms, int parallelism);
+
+private:
+    double demandLocked() const;
+
+    FrameSkipConfig config_;
+    int parallelism_;
+    mutable std::mutex mtx_;
+    int stride_ = 1;
+    std::vector<int> since_inferred_;
+    std::vector<double> stream_fps_;
+    double infer_ms_ = 0.0;  // moving averages
+    double skip_ms_ = 0.0;
+    QueueStats::Clock::time_point last_update_;
+    uint64_t inferred_ = 0;
+    uint64_t skipped_ = 0;
+    uint64_t stride_changes_ = 0;
+};
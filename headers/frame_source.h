@@ -0,0 +1,37 @@
+#pragma once
+#include <ostream>
+#include "frame_envelope.h"
+
+// Anything the consumer stage can pull frames from: a single FrameQueue, a
+// MultiLaneQueue that multiplexes several cameras, or a ShmFrameQueue fed by
+// another process.
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    // Blocks until a frame is available; returns false once closed and drained.
+    virtual bool pop(FrameEnvelope& frame) = 0;
+
+    virtual void close() = 0;
+    virtual bool isClosed() const = 0;
+
+    virtual void reportStats(std::ostream& os) const = 0;
+};
+
+// Anything the producer stage can push frames into.
+class FrameSink {
+public:
+    virtual ~FrameSink() = default;
+
+    // Blocks while full (or drops, depending on the implementation); returns
+    // false once the sink is closed and the producer should stop.
+    virtual bool push(const FrameEnvelope& frame) = 0;
+
+    // False if a frame pushed now would be discarded rather than queued.
+    // Producers check it before decoding so that such frames are skipped
+    // without paying for the colour conversion and copy. Only a full
+    // drop-newest lane reports false; blocking queues always accept.
+    virtual bool accepts() const { return true; }
+
+    virtual void close() = 0;
+};
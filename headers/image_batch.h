@@ -0,0 +1,28 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+#include "infer_engine_pool.h"
+
+// Batch mode for still images: a pool of decode threads feeds inference
+// workers that preprocess and infer several images per call, and a writer
+// thread streams the detections to a CSV file as they complete.
+struct ImageBatchConfig {
+    int decode_threads = 0;      // 0: one per hardware thread
+    int infer_workers = 1;       // each infers with a session of its own
+    int batch_size = 8;          // images per inference call
+    size_t queue_capacity = 64;  // decoded images waiting for inference
+    float conf_threshold = 0.25f;
+    float nms_threshold = 0.45f;
+    double stats_interval_sec = 5.0;
+    std::string results_path = "detections.csv";
+};
+
+// A directory (not recursive; common image extensions, sorted by name) or a
+// text file with one image path per line. Empty if neither can be read.
+std::vector<std::string> listImages(const std::string& dir_or_list);
+
+// Returns false if nothing could be processed or the results file could not
+// be written.
+bool processImages(const std::vector<std::string>& images, InferEnginePool& engines,
+                   const ImageBatchConfig& config, std::atomic<bool>& running);
@@ -3,6 +3,7 @@
 #include "opencv_minimal.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 class InferEngine {
 public:
@@ -13,8 +14,22 @@ public:
     bool loadModel(const std::string& model_path);
     cv::Mat infer(const cv::Mat& input_blob);
 
+    // Runs `batch` images whose blobs are concatenated in `batch_blob` in one
+    // call and returns one prediction matrix per image. Needs a model exported
+    // with a dynamic batch dimension; otherwise the images run one by one.
+    std::vector<cv::Mat> inferBatch(const cv::Mat& batch_blob, int batch);
+    bool supportsBatch() const { return dynamic_batch_; }
+
+    // Runs `batch` consecutive blobs and writes the predictions straight into
+    // caller memory, batch * getOutputRows() * getOutputCols() floats. Needs
+    // a model whose output shape is fixed apart from the batch dimension.
+    bool inferInto(const float* blob, int batch, float* predictions);
+    bool hasFixedOutput() const { return output_rows_ > 0 && output_cols_ > 0; }
+
     int getInputWidth() const { return input_width_; }
     int getInputHeight() const { return input_height_; }
+    int getOutputRows() const { return output_rows_; }
+    int getOutputCols() const { return output_cols_; }
 
 private:
     std::unique_ptr<Ort::Session> session_;
@@ -22,4 +37,7 @@ private:
     std::string model_path_;
     int input_width_ = 640;
     int input_height_ = 640;
+    bool dynamic_batch_ = false;
+    int output_rows_ = 0;  // 0 if the model leaves it dynamic
+    int output_cols_ = 0;
 };
@@ -0,0 +1,52 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "infer_engine.h"
+
+// Several sessions of the same model for parallel inference workers. A
+// single session serialises most of the work inside Run(), so each worker
+// borrows a session of its own for the duration of one infer() call.
+class InferEnginePool {
+public:
+    // Borrowed session; goes back to the pool when destroyed.
+    class Lease {
+    public:
+        Lease(InferEnginePool& pool, size_t slot) : pool_(&pool), slot_(slot) {}
+        Lease(Lease&& other) noexcept : pool_(other.pool_), slot_(other.slot_) { other.pool_ = nullptr; }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { if (pool_) pool_->release(slot_); }
+
+        InferEngine& engine() const { return *pool_->engines_[slot_]; }
+        InferEngine* operator->() const { return &engine(); }
+
+    private:
+        InferEnginePool* pool_;
+        size_t slot_;
+    };
+
+    InferEnginePool() = default;
+
+    // Loads `sessions` copies of the model. Returns false if any fails, in
+    // which case the pool keeps whatever sessions it had before.
+    bool load(const std::string& model_path, size_t sessions);
+
+    // Blocks until a session is free.
+    Lease acquire();
+
+    InferEngine& at(size_t i) { return *engines_[i]; }
+    size_t size() const { return engines_.size(); }
+    int getInputWidth() const { return engines_.empty() ? 640 : engines_[0]->getInputWidth(); }
+    int getInputHeight() const { return engines_.empty() ? 640 : engines_[0]->getInputHeight(); }
+
+private:
+    void release(size_t slot);
+
+    std::vector<std::unique_ptr<InferEngine>> engines_;
+    std::vector<size_t> free_;
+    std::mutex mtx_;
+    std::condition_variable available_;
+};
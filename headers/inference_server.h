@@ -0,0 +1,96 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "batch_collector.h"
+#include "detect_protocol.h"
+#include "infer_engine_pool.h"
+#include "nms.h"
+#include "opencv_minimal.h"
+#include "queue_stats.h"
+
+struct InferenceServerConfig {
+    std::string socket_path = "/tmp/yolo_detect.sock";
+    int max_batch = 8;            // frames per inference call
+    double max_delay_ms = 2.0;    // how long the oldest request may wait for others to join its batch
+    size_t queue_capacity = 256;  // requests waiting for a batch; readers block beyond this
+    float conf_threshold = 0.25f;
+    float nms_threshold = 0.45f;
+    double stats_interval_sec = 5.0;
+};
+
+// Serves detection to other local processes over a Unix domain socket (see
+// detect_protocol.h). Each connection has a reader thread that parses
+// requests into a BatchCollector; one batch worker per model session takes
+// up to max_batch requests at a time, whichever clients they came from,
+// runs them through one InferEngine::inferBatch call and writes each reply
+// to its own connection. Shared-memory frames are wrapped in place, never
+// copied, and their mapping stays open for the life of the connection; a
+// segment the client has grown is mapped again, the old view kept until the
+// connection closes since queued requests may still point into it.
+//
+// Linux only.
+class InferenceServer {
+public:
+    InferenceServer(InferEnginePool& engines, const InferenceServerConfig& config);
+    ~InferenceServer();
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // Binds and listens on the socket, replacing a stale one. Returns false
+    // on failure.
+    bool start();
+
+    // Accepts clients and serves them until `running` is cleared.
+    void run(std::atomic<bool>& running);
+
+    void reportStats(std::ostream& os) const;
+
+    // Reader threads not yet joined; finished ones are reaped as the accept
+    // loop goes round.
+    size_t readerThreads() const;
+
+private:
+    struct Connection;
+
+    struct Reader {
+        std::weak_ptr<Connection> conn;
+        std::shared_ptr<std::atomic<bool>> done;
+        std::thread thread;
+    };
+
+    // One frame waiting for a batch. The image is either the server's own
+    // copy or a view into the client's shared memory, which conn keeps mapped.
+    struct Request {
+        std::shared_ptr<Connection> conn;
+        uint32_t id = 0;
+        cv::Mat image;
+        QueueStats::Clock::time_point arrived;
+    };
+
+    void readLoop(std::shared_ptr<Connection> conn, std::shared_ptr<std::atomic<bool>> done);
+    void reapReaders();
+    void batchWorker(InferEngine& engine);
+    void reply(Connection& conn, uint32_t id, DetectStatus status, const std::vector<Detection>* detections);
+
+    InferEnginePool& engines_;
+    InferenceServerConfig config_;
+    int listen_fd_ = -1;
+    BatchCollector<Request> pending_;
+
+    mutable std::mutex readers_mtx_;
+    std::vector<Reader> readers_;
+
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> failed_{0};
+    Log2Histogram batch_size_;
+    Log2Histogram infer_us_;     // per batch, preprocess to last reply
+    Log2Histogram service_us_;   // per request, arrival to reply
+};
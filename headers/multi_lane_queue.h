@@ -0,0 +1,96 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "frame_source.h"
+#include "queue_stats.h"
+
+// What a lane does when a producer pushes into it while it is full.
+enum class DropPolicy {
+    Block,       // wait for the consumer, like FrameQueue
+    DropOldest,  // evict the oldest queued frame; keeps latency low for live cameras
+    DropNewest,  // discard the incoming frame
+};
+
+struct LaneConfig {
+    size_t capacity = 8;
+    DropPolicy policy = DropPolicy::Block;
+    unsigned weight = 1;  // frames served per scheduling round
+};
+
+// One bounded lane per source, served in weighted round-robin order on pop so
+// that a 60 fps camera cannot starve a 5 fps one sharing the same consumer.
+// Frames are routed by FrameEnvelope::source_id, which must be the id returned
+// by addLane().
+class MultiLaneQueue : public FrameSource, public FrameSink {
+public:
+    MultiLaneQueue() = default;
+    ~MultiLaneQueue() override;
+
+    // Lanes must be added before producers and consumers start.
+    int addLane(const LaneConfig& config);
+    size_t laneCount() const { return lanes.size(); }
+
+    // Returns false if the lane or the whole queue is closed. A frame dropped
+    // under DropNewest still returns true; the drop is counted in the lane stats.
+    bool push(const FrameEnvelope& frame) override;
+
+    bool pop(FrameEnvelope& frame) override;
+
+    // False while a DropNewest lane is full, i.e. its next push would be
+    // discarded.
+    bool accepts(int lane) const;
+
+    // Marks one source as finished; the queue closes when every lane has.
+    void closeLane(int lane);
+    void close() override;
+    bool isClosed() const override;
+
+    size_t size() const;
+    size_t laneSize(int lane) const;
+
+    QueueStatsSnapshot laneStats(int lane) const;
+    void reportStats(std::ostream& os) const override;
+
+private:
+    struct Lane {
+        explicit Lane(const LaneConfig& cfg) : config(cfg), stats(cfg.capacity) {}
+
+        LaneConfig config;
+        std::deque<FrameEnvelope> q;
+        std::condition_variable cv_space;
+        bool closed = false;
+        QueueStats stats;
+        std::atomic<size_t> size{0};
+    };
+
+    bool allLanesClosed() const;
+
+    mutable std::mutex mtx;
+    std::condition_variable cv_pop;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    size_t total_size = 0;
+    size_t cursor = 0;
+    unsigned served_in_round = 0;
+    bool closed = false;
+};
+
+// Sink for one producer feeding one lane: stamps frames with the lane id and
+// closes only that lane, so a producer written against FrameSink can be
+// pointed at a shared MultiLaneQueue unchanged.
+class LaneSink : public FrameSink {
+public:
+    LaneSink(MultiLaneQueue& queue, int lane) : queue_(queue), lane_(lane) {}
+
+    bool push(const FrameEnvelope& frame) override;
+    bool accepts() const override { return queue_.accepts(lane_); }
+    void close() override { queue_.closeLane(lane_); }
+
+    int lane() const { return lane_; }
+
+private:
+    MultiLaneQueue& queue_;
+    int lane_;
+};
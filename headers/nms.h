@@ -2,6 +2,8 @@
 
 #include <vector>
 #include "opencv_minimal.h"
+#include "frame_envelope.h"
+#include "work_stealing_pool.h"
 
 struct Detection {
     cv::Rect2f box;
@@ -13,5 +15,18 @@ std::vector<Detection> postprocess(
     const cv::Mat& predictions,
     cv::Size original_image_size,
     float conf_threshold = 0.25f,
-    float iou_threshold = 0.45f
+    float iou_threshold = 0.45f,
+    WorkStealingPool* pool = nullptr
+);
+
+// Same as above, but maps boxes back through the letterbox the frame was
+// preprocessed with instead of stretching the model input over the image.
+// With a pool, anchors are decoded in partitions on its workers; the result
+// is the same as without.
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    const LetterboxTransform& letterbox,
+    float conf_threshold = 0.25f,
+    float iou_threshold = 0.45f,
+    WorkStealingPool* pool = nullptr
 );
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+#include "infer_engine_pool.h"
+#include "tracker.h"
+
+// Offline processing of archived video: the file is cut into segments that
+// are decoded, inferred and tracked in parallel, and the per-segment results
+// are stitched into one ordered detection stream.
+//
+// OpenCV does not expose keyframe positions, but seeking with
+// CAP_PROP_POS_FRAMES makes the backend start decoding at the preceding
+// keyframe, so each segment pays at most one GOP of extra decoding. Each
+// segment also starts `overlap` frames early to warm up its tracker; those
+// frames are not emitted and are used to carry track ids across the
+// boundary.
+struct OfflineConfig {
+    int workers = 0;        // 0: one per hardware thread
+    int segments = 0;       // 0: four per worker
+    int overlap = 15;       // tracker warm-up frames before each segment
+    float conf_threshold = 0.25f;
+    float nms_threshold = 0.45f;
+    TrackerConfig tracker;
+    std::string detections_path = "detections.csv";
+};
+
+struct Segment {
+    int index = 0;
+    int64_t begin = 0;      // first frame emitted
+    int64_t end = 0;        // one past the last
+};
+
+// Splits [0, frame_count) into at most `segments` contiguous, non-empty ranges.
+std::vector<Segment> planSegments(int64_t frame_count, int segments);
+
+struct FrameResult {
+    int64_t frame = 0;
+    double timestamp_ms = -1.0;
+    std::vector<Track> tracks;   // tracks matched in this frame
+};
+
+struct SegmentResult {
+    Segment segment;
+    std::vector<FrameResult> frames;  // [begin, end) in order
+    FrameResult handoff;              // frame begin - 1 as seen by this segment's tracker
+    bool has_handoff = false;
+};
+
+// Rewrites per-segment track ids into ids that are unique across the file.
+// A track in segment k keeps the id of the segment k-1 track it overlaps on
+// the frame both of them saw (the one just before segment k); all other
+// tracks get fresh ids. Segments must be added in order.
+class TrackStitcher {
+public:
+    explicit TrackStitcher(float match_iou = 0.5f) : match_iou_(match_iou) {}
+
+    void stitch(SegmentResult& result);
+
+    int tracksCreated() const { return next_id_ - 1; }
+    int tracksCarried() const { return carried_; }
+
+private:
+    float match_iou_;
+    int next_id_ = 1;
+    int carried_ = 0;
+    FrameResult last_;          // last emitted frame, with global ids
+    bool has_last_ = false;
+};
+
+// Processes `video_path` and writes one CSV line per track per frame to
+// config.detections_path. Returns false if the file cannot be opened, has
+// no known frame count, or no frame could be processed.
+bool processOffline(const std::string& video_path, InferEnginePool& engines,
+                    const OfflineConfig& config, std::atomic<bool>& running);
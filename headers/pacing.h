@@ -0,0 +1,56 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// How fast the producer hands frames downstream.
+enum class PacingMode {
+    Max,       // decode as fast as downstream accepts
+    Realtime,  // follow the container timestamps (file playback at 1x)
+    Fixed,     // a fixed frame rate
+};
+
+struct Pacing {
+    PacingMode mode = PacingMode::Max;
+    double fps = 0.0;  // Fixed only
+};
+
+// Parses "max", "realtime" or "fixed=N". Throws std::invalid_argument.
+Pacing parsePacing(const std::string& spec);
+std::string toString(const Pacing& pacing);
+
+// Sleeps the producer until each frame is due and measures the rate it
+// actually achieved. The schedule is anchored at the first frame; if the
+// producer falls more than kMaxLagMs behind (downstream was blocked), the
+// schedule is re-anchored instead of bursting to catch up.
+class Pacer {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr double kMaxLagMs = 250.0;
+
+    // source_fps is the container frame rate; Realtime falls back to it for
+    // frames without a usable timestamp.
+    Pacer(const Pacing& pacing, double source_fps);
+
+    // Blocks until the frame is due. timestamp_ms is its container
+    // timestamp, negative if unknown.
+    void wait(double timestamp_ms);
+
+    // Frames per second the schedule aims for, 0 when unpaced.
+    double targetFps() const;
+    double achievedFps() const;
+    uint64_t frames() const { return frames_; }
+    // Frames that were already overdue when wait() was called.
+    uint64_t lateFrames() const { return late_; }
+
+private:
+    Pacing pacing_;
+    double source_fps_;
+    Clock::time_point anchor_;
+    double anchor_ts_ms_ = 0.0;     // timestamp that is due at anchor_
+    double last_ts_ms_ = 0.0;
+    Clock::time_point first_;
+    Clock::time_point last_;
+    uint64_t frames_ = 0;
+    uint64_t late_ = 0;
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "opencv_minimal.h"
+#include "bounded_queue.h"
+#include "frame_envelope.h"
+#include "frame_skip.h"
+#include "frame_source.h"
+#include "infer_engine_pool.h"
+#include "nms.h"
+#include "preprocess.h"
+#include "queue_stats.h"
+#include "render.h"
+#include "reorder_buffer.h"
+#include "tracker.h"
+#include "work_stealing_pool.h"
+
+// Worker threads per stage. Tracking and output (display + encoding) always
+// run on one thread each because they depend on frame order.
+struct StageThreads {
+    int preprocess = 1;
+    int inference = 1;
+    int postprocess = 1;
+    int render = 1;
+};
+
+// Parses "pre=2,infer=1,post=1,render=2"; stages not mentioned keep their
+// current value. Throws std::invalid_argument on unknown stages or counts < 1.
+void parseStageThreads(const std::string& spec, StageThreads& threads);
+
+struct PipelineConfig {
+    float conf_threshold = 0.25f;
+    float nms_threshold = 0.45f;
+    double stats_interval_sec = 5.0;
+    size_t queue_capacity = 4;          // between consecutive stages
+    size_t reorder_window = 16;         // max frames in flight ahead of tracking
+    StageThreads threads;
+    TrackerConfig tracker;
+    int streams = 1;                    // sources, numbered by FrameEnvelope::source_id
+    OutputOptions output;               // video.path becomes "output_<id>.mp4" etc. with several streams
+    FrameSkipConfig skip;               // inference stride, measured on the inference stage
+    int decode_stride = 1;              // frames in between are grabbed but not decoded (coro pipeline)
+    WorkStealingPool* cpu_pool = nullptr; // runs preprocess bands, decode partitions, overlaps, drawing
+};
+
+// Output file for one stream: the configured path itself for a single
+// stream, otherwise with "_<id>" inserted before the extension.
+std::string streamOutputPath(const std::string& base, int stream, int streams);
+
+// One frame on its way through the pipeline. index is assigned in pop order
+// and is what the ordered stages resequence on; ok is cleared when a stage
+// fails so the frame still flows through and keeps the sequence contiguous.
+// Frames with inferred cleared skip the model and reuse the stream's tracks.
+struct FrameTask {
+    uint64_t index = 0;
+    bool ok = true;
+    bool inferred = true;
+    FrameEnvelope frame;
+    cv::Mat blob;
+    cv::Mat predictions;
+    std::vector<Detection> detections;
+    std::vector<Track> tracks;
+    cv::Mat rendered;
+};
+
+// Runs preprocess -> inference -> postprocess -> track -> render -> output as
+// separate stages connected by bounded queues, so throughput is limited by
+// the slowest stage rather than the sum of all of them. Stages with more than
+// one thread may finish frames out of order; tracking and output put them
+// back in order first. Inference workers borrow sessions from the pool, so
+// with as many sessions as workers they run fully in parallel.
+//
+// Several streams can share one pipeline: frames are routed by source_id to
+// a tracker, video file and window of their own, while the workers and
+// sessions are shared. Frames of one stream stay in order because the
+// source hands them out in order and the pipeline preserves pop order.
+class StagedPipeline {
+public:
+    StagedPipeline(FrameSource& source, InferEnginePool& engines, const PipelineConfig& config);
+
+    // Blocks until the source is closed and drained, or `running` is cleared
+    // (ESC in the display window clears it too). Closes the source on return.
+    void run(std::atomic<bool>& running);
+
+    void reportStats(std::ostream& os) const;
+
+    // For a producer that takes the skip decision before decoding.
+    FrameSkipController& skipController() { return skip_; }
+
+private:
+    struct Stage {
+        std::string name;
+        int threads = 1;
+        std::atomic<int> active{0};
+        std::atomic<uint64_t> frames{0};
+        Log2Histogram service_us;
+    };
+
+    // Per-stream output state; only touched by the output thread, and read
+    // by reportStats() from that thread or after the workers have joined.
+    struct StreamOutput {
+        std::string window;
+        std::unique_ptr<AsyncVideoWriter> writer;
+        uint64_t frames = 0;
+        QueueStats::Clock::time_point first_frame;
+        QueueStats::Clock::time_point last_frame;
+        Log2Histogram latency_us;
+    };
+
+    using TaskQueue = BoundedQueue<FrameTask>;
+
+    void preprocessWorker(std::atomic<bool>& running);
+    void inferenceWorker();
+    void postprocessWorker();
+    void trackWorker();
+    void renderWorker();
+    void outputWorker(std::atomic<bool>& running);
+
+    // Called by each worker as it exits; returns true for the last one.
+    static bool leaveStage(Stage& stage);
+
+    FrameSource& source_;
+    InferEnginePool& engines_;
+    PipelineConfig config_;
+    const Preprocessor preprocessor_;
+    std::vector<Tracker> trackers_;
+    std::vector<std::unique_ptr<StreamOutput>> outputs_;
+    std::unique_ptr<ResultSink> results_;
+
+    Stage pre_, infer_, post_, track_, render_, output_;
+    TaskQueue pre_to_infer_, infer_to_post_, track_to_render_, render_to_output_;
+    ReorderBuffer<FrameTask> post_to_track_;
+
+    FrameSkipController skip_;
+    std::mutex source_mtx_;
+    uint64_t next_index_ = 0;
+    Log2Histogram latency_us_;
+};
@@ -1,17 +1,38 @@
 #pragma once
 #include "opencv_minimal.h"
+#include "frame_envelope.h"
+#include "work_stealing_pool.h"
 #include <string>
 #include <vector>
 
 class Preprocessor {
 public:
-    Preprocessor(int input_width = 640, int input_height = 640);
+    // With a pool, the conversion to the planar float blob runs in row bands
+    // on its workers.
+    Preprocessor(int input_width = 640, int input_height = 640, WorkStealingPool* pool = nullptr);
     cv::Mat process(const cv::Mat& image);
     std::pair<float, cv::Point> getScaleAndPadding() const;
 
+    // Stateless variants: the letterbox transform is returned to the caller
+    // instead of being remembered, so one Preprocessor can serve many threads.
+    cv::Mat process(const cv::Mat& image, LetterboxTransform& transform) const;
+    cv::Mat process(FrameEnvelope& frame) const;
+
+    // Writes the blob into caller memory, 3 * input_width * input_height
+    // floats. Accepts 8-bit BGR, grey or BGRA images. Returns false (and
+    // leaves blob alone) for an empty image or any other type.
+    bool processInto(const cv::Mat& image, float* blob, LetterboxTransform& transform) const;
+
+    // Letterboxes each frame into consecutive slots of one blob for
+    // InferEngine::inferBatch. ok[i] tells whether frame i was processed; a
+    // frame that was not leaves its slot zeroed and its letterbox reset, and
+    // its predictions must not be decoded.
+    cv::Mat processBatch(std::vector<FrameEnvelope>& frames, std::vector<bool>& ok) const;
+
 private:
     int input_width_;
     int input_height_;
+    WorkStealingPool* pool_;
 
     float scale_;
     cv::Point padding_; 
@@ -0,0 +1,127 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+// Histogram with power-of-two buckets, updated with relaxed atomics so it can be
+// recorded from any thread without a lock. Bucket 0 holds zero, bucket i holds
+// values in [2^(i-1), 2^i); the last bucket absorbs everything larger.
+class Log2Histogram {
+public:
+    static constexpr size_t kBuckets = 32;
+
+    struct Snapshot {
+        std::array<uint64_t, kBuckets> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        double mean() const;
+        // Upper bound of the bucket containing the p-th percentile (p in [0, 1]).
+        uint64_t percentile(double p) const;
+    };
+
+    void record(uint64_t value);
+    void reset();
+    Snapshot snapshot() const;
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Histogram with one bucket per value in [0, capacity]; used for queue occupancy
+// where the range is small and exact counts are more useful than log buckets.
+class LinearHistogram {
+public:
+    struct Snapshot {
+        std::unique_ptr<uint64_t[]> buckets;
+        size_t num_buckets = 0;
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+
+        double mean() const;
+        uint64_t percentile(double p) const;
+    };
+
+    explicit LinearHistogram(size_t capacity);
+
+    void record(uint64_t value);
+    void reset();
+    Snapshot snapshot() const;
+
+private:
+    size_t num_buckets_;
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Point-in-time copy of a queue's counters. Wait times are in microseconds.
+struct QueueStatsSnapshot {
+    size_t capacity = 0;
+    size_t size = 0;
+    double elapsed_sec = 0.0;
+
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint64_t dropped = 0;
+    uint64_t push_blocked = 0;  // pushes that found the queue full and had to wait
+    uint64_t pop_blocked = 0;   // pops that found the queue empty and had to wait
+
+    Log2Histogram::Snapshot push_wait_us;
+    Log2Histogram::Snapshot pop_wait_us;
+    LinearHistogram::Snapshot occupancy;  // queue size observed at each push
+
+    double pushRate() const { return elapsed_sec > 0 ? pushed / elapsed_sec : 0.0; }
+    double popRate() const { return elapsed_sec > 0 ? popped / elapsed_sec : 0.0; }
+
+    // "producer-bound" when consumers mostly wait on an empty queue,
+    // "consumer-bound" when producers mostly wait on a full one.
+    std::string bottleneck() const;
+};
+
+std::ostream& operator<<(std::ostream& os, const QueueStatsSnapshot& s);
+
+// Counters a queue updates on its hot path. All members are lock-free so that
+// stats() can be called concurrently with push/pop.
+class QueueStats {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit QueueStats(size_t capacity);
+
+    void recordPush(size_t occupancy, bool blocked, uint64_t wait_us);
+    void recordPop(bool blocked, uint64_t wait_us);
+    void recordDrop();
+
+    QueueStatsSnapshot snapshot(size_t current_size) const;
+    void reset();
+
+    static uint64_t elapsedMicros(Clock::time_point since) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - since).count());
+    }
+
+private:
+    size_t capacity_;
+    std::atomic<int64_t> start_ns_;
+
+    std::atomic<uint64_t> pushed_{0};
+    std::atomic<uint64_t> popped_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> push_blocked_{0};
+    std::atomic<uint64_t> pop_blocked_{0};
+
+    Log2Histogram push_wait_us_;
+    Log2Histogram pop_wait_us_;
+    LinearHistogram occupancy_;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "opencv_minimal.h"
+#include "result_sink.h"
+#include "tracker.h"
+#include "video_writer.h"
+#include "work_stealing_pool.h"
+
+// What happens to each processed frame besides detection and tracking. A
+// copy of the frame is only drawn on when something will show or save it.
+struct OutputOptions {
+    bool display = true;                    // imshow + waitKey
+    bool encode = true;                     // write the annotated video
+    VideoWriterConfig video;
+    ResultSinkConfig results;               // detections and tracks per frame, shared by all streams
+
+    bool draw() const { return display || encode; }
+};
+
+const std::vector<std::string>& cocoClassNames();
+
+// Draws boxes and "class conf id=N" labels for tracks at least min_age frames old.
+// With a pool the image is drawn in horizontal bands, each clipped to its rows.
+void drawTracks(cv::Mat& image, const std::vector<Track>& tracks, int min_age, WorkStealingPool* pool = nullptr);
+
+// A drawn copy of frame; with a pool each band is copied and drawn by one task.
+cv::Mat renderTracks(const cv::Mat& frame, const std::vector<Track>& tracks, int min_age,
+                     WorkStealingPool* pool = nullptr);
@@ -0,0 +1,103 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <utility>
+#include "queue_stats.h"
+
+// Puts items finished out of order by parallel workers back into index
+// order for a single ordered consumer. Indices must start at 0 and be
+// contiguous.
+//
+// The window bounds how far work may run ahead of the consumer: admit(i)
+// blocks until i < next + window, where next is the index the consumer is
+// waiting for. Calling admit() before work on an item starts caps both the
+// memory held here and the extra latency a slow item can cause. Admission
+// happens upstream of all the workers, so the item the consumer is waiting
+// for has always been admitted and can never be blocked behind later ones.
+template <typename T>
+class ReorderBuffer {
+public:
+    explicit ReorderBuffer(size_t window) : window_(window == 0 ? 1 : window) {}
+
+    // Returns false if the buffer was closed while waiting.
+    bool admit(uint64_t index) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (index >= next_ + window_ && !closed_) {
+            admit_blocked_++;
+            auto wait_start = QueueStats::Clock::now();
+            window_open_.wait(lock, [&] { return index < next_ + window_ || closed_; });
+            admit_wait_us_.record(QueueStats::elapsedMicros(wait_start));
+        }
+        return !closed_;
+    }
+
+    void push(uint64_t index, T item) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            pending_.emplace(index, std::move(item));
+            held_.record(pending_.size());
+        }
+        ready_.notify_one();
+    }
+
+    // Blocks until the next item in order is available. After close() the
+    // remaining items are returned in index order even if some are missing;
+    // returns false once nothing is left.
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx_);
+        ready_.wait(lock, [this] {
+            return (!pending_.empty() && pending_.begin()->first == next_) || closed_;
+        });
+        if (pending_.empty()) {
+            return false;
+        }
+        auto it = pending_.begin();
+        item = std::move(it->second);
+        next_ = it->first + 1;
+        pending_.erase(it);
+        lock.unlock();
+        window_open_.notify_all();
+        return true;
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            closed_ = true;
+        }
+        ready_.notify_all();
+        window_open_.notify_all();
+    }
+
+    size_t window() const { return window_; }
+
+    size_t held() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return pending_.size();
+    }
+
+    void reportStats(std::ostream& os) const {
+        auto held = held_.snapshot();
+        auto wait = admit_wait_us_.snapshot();
+        std::lock_guard<std::mutex> lock(mtx_);
+        os << "[Reorder] window=" << window_ << " next=" << next_
+           << " held: mean=" << held.mean() << " max=" << held.max
+           << " admit blocked " << admit_blocked_ << "x, wait us mean=" << wait.mean()
+           << " p99<=" << wait.percentile(0.99) << std::endl;
+    }
+
+private:
+    mutable std::mutex mtx_;
+    std::condition_variable ready_;
+    std::condition_variable window_open_;
+    std::map<uint64_t, T> pending_;
+    size_t window_;
+    uint64_t next_ = 0;
+    bool closed_ = false;
+
+    uint64_t admit_blocked_ = 0;
+    Log2Histogram held_;
+    Log2Histogram admit_wait_us_;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <utility>
+
+// Single-threaded counterpart of ReorderBuffer for a consumer that already
+// owns its input: items are added as they arrive and handed to emit in index
+// order. Items after a missing index are held until the gap is filled or
+// flush() is called. Indices must start at 0 and be contiguous.
+template <typename T>
+class Resequencer {
+public:
+    template <typename Emit>
+    void add(uint64_t index, T item, Emit emit) {
+        pending_.emplace(index, std::move(item));
+        for (auto it = pending_.begin(); it != pending_.end() && it->first == next_; it = pending_.begin()) {
+            T ready = std::move(it->second);
+            pending_.erase(it);
+            next_++;
+            emit(ready);
+        }
+    }
+
+    // Emits whatever is left, in index order, once the input is exhausted.
+    template <typename Emit>
+    void flush(Emit emit) {
+        for (auto& entry : pending_) emit(entry.second);
+        pending_.clear();
+    }
+
+    size_t held() const { return pending_.size(); }
+    uint64_t next() const { return next_; }
+
+private:
+    std::map<uint64_t, T> pending_;
+    uint64_t next_ = 0;
+};
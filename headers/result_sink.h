@@ -0,0 +1,130 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "nms.h"
+#include "queue_stats.h"
+#include "tracker.h"
+
+enum class ResultFormat {
+    JsonLines,  // one JSON object per frame and line
+    Binary,     // length-prefixed little-endian records, see appendBinaryRecord()
+};
+
+struct ResultSinkConfig {
+    std::string path;                 // empty: no result file
+    ResultFormat format = ResultFormat::JsonLines;
+    size_t buffer_bytes = 1 << 20;    // records are collected and written in chunks of this size
+    double flush_sec = 1.0;           // a partly filled buffer is written after this long
+    uint64_t rotate_bytes = 0;        // start a new file after this many bytes, 0: never
+    double rotate_sec = 0.0;          // start a new file after this many seconds, 0: never
+    size_t queue_capacity = 1024;     // frames waiting to be serialised
+    bool drop_when_behind = true;     // false: block the caller instead
+
+    bool enabled() const { return !path.empty(); }
+};
+
+// What the pipeline knows about one frame once it has been tracked.
+struct FrameRecord {
+    int stream = 0;
+    uint64_t seq = 0;
+    double timestamp_ms = -1.0;
+    bool inferred = true;             // false: detections are empty and tracks carried over
+    std::vector<Detection> detections;
+    std::vector<Track> tracks;
+};
+
+// Writes per-frame detections and tracks to a file on a thread of its own,
+// like AsyncVideoWriter does for the annotated video: write() only moves the
+// result into a bounded queue, serialising and file I/O never happen on the
+// caller's thread. Records are appended to an in-memory buffer that goes to
+// disk in one write when it is full or flush_sec has passed.
+//
+// With rotation on, files are named "<stem>_<n><ext>" from n = 0 and a new
+// one is started once the current file reaches rotate_bytes or has been open
+// for rotate_sec. A record never straddles two files, and binary files each
+// start with their own header.
+class ResultSink {
+public:
+    explicit ResultSink(const ResultSinkConfig& config);
+    ~ResultSink();
+
+    ResultSink(const ResultSink&) = delete;
+    ResultSink& operator=(const ResultSink&) = delete;
+
+    // Queues a result. Returns false if it was dropped or the sink closed.
+    bool write(FrameRecord result);
+
+    // Writes what is still queued and closes the file.
+    void close();
+
+    bool failed() const { return failed_.load(); }
+    uint64_t written() const { return written_.load(); }
+    uint64_t dropped() const { return dropped_.load(); }
+    uint64_t bytes() const { return bytes_.load(); }
+    int files() const { return files_.load(); }
+
+    void reportStats(std::ostream& os) const;
+
+    // Name of the index-th file for a base path when rotating.
+    static std::string rotatedPath(const std::string& base, int index);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void run();
+    bool openNext();
+    void flush();
+    void closeFile();
+
+    ResultSinkConfig config_;
+    std::mutex mtx_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    std::deque<FrameRecord> queue_;
+    bool closed_ = false;
+
+    // Owned by the writer thread.
+    std::FILE* file_ = nullptr;
+    std::string buffer_;
+    uint64_t file_bytes_ = 0;
+    Clock::time_point file_opened_;
+    Clock::time_point last_flush_;
+
+    std::atomic<bool> failed_{false};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<int> files_{0};
+    Log2Histogram write_us_;
+    std::thread thread_;
+};
+
+// Serialisers, appending to out. JSON Lines look like
+//   {"stream":0,"seq":12,"ts_ms":400.00,"inferred":true,
+//    "detections":[{"cls":2,"conf":0.912,"box":[x,y,w,h]}],
+//    "tracks":[{"id":3,"cls":2,"conf":0.912,"age":5,"lost":0,"box":[x,y,w,h]}]}
+// with boxes in source pixels and the smoothed box for tracks.
+void appendJsonLine(std::string& out, const FrameRecord& result);
+
+// Binary records are in host byte order, i.e. little-endian on x86 and ARM:
+//   u32 record bytes (excluding this field), i32 stream, u64 seq,
+//   f64 timestamp_ms, u8 inferred, u32 detections, u32 tracks,
+//   detections: f32 x, y, w, h, conf, i32 cls               (24 bytes each)
+//   tracks: i32 id, f32 x, y, w, h, conf, i32 cls, age, lost (36 bytes each)
+// Each file starts with kBinaryMagic and a u32 version.
+void appendBinaryRecord(std::string& out, const FrameRecord& result);
+
+constexpr char kBinaryMagic[4] = {'Y', 'D', 'E', 'T'};
+constexpr uint32_t kBinaryVersion = 1;
+
+// Parses "jsonl" or "bin". Throws std::invalid_argument otherwise.
+ResultFormat parseResultFormat(const std::string& name);
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "frame_source.h"
+#include "queue_stats.h"
+
+// Single-producer/single-consumer frame ring in POSIX shared memory, so that
+// decoding and inference can run in separate processes. Frames are copied
+// into fixed-size slots; a slot holds any image up to slot_bytes.
+//
+// Both sides block on futex words inside the segment. Waits time out
+// periodically to check that the peer process is still alive. If it has
+// died, the survivor waits up to the re-attach timeout for a restarted peer
+// to attach to the same segment and carries on from where the ring stood;
+// with no timeout set, or once it expires, push/pop fail instead of hanging.
+// The consumer unlinks the segment when it is destroyed after an orderly
+// close(); a segment abandoned by a crash stays until the next process with
+// the same name attaches to it, or until unlink() removes it.
+class ShmFrameQueue : public FrameSource, public FrameSink {
+public:
+    enum class Role { Producer, Consumer };
+
+    // Creates the segment if it does not exist yet, otherwise attaches to it.
+    // slot_count/slot_bytes are only used by whichever side creates it.
+    // Throws std::runtime_error if the segment cannot be created or mapped.
+    ShmFrameQueue(const std::string& name, Role role,
+                  size_t slot_count = 8, size_t slot_bytes = 1920 * 1080 * 3);
+    ~ShmFrameQueue() override;
+
+    ShmFrameQueue(const ShmFrameQueue&) = delete;
+    ShmFrameQueue& operator=(const ShmFrameQueue&) = delete;
+
+    // Producer side. Returns false if the queue is closed, the consumer died,
+    // or the frame does not fit in a slot.
+    bool push(const FrameEnvelope& frame) override;
+
+    // Consumer side. Returns false once closed and drained, or if the
+    // producer died.
+    bool pop(FrameEnvelope& frame) override;
+
+    void close() override;
+    bool isClosed() const override;
+
+    bool peerAlive() const;
+
+    // How long a blocked push/pop waits for a dead peer to be replaced.
+    // 0, the default, gives up as soon as the peer is found dead.
+    void setReattachTimeout(int ms) { reattach_ms_ = ms; }
+    size_t size() const;
+    size_t slotCount() const;
+    size_t slotBytes() const;
+
+    QueueStatsSnapshot stats() const;
+    void reportStats(std::ostream& os) const override;
+
+    static void unlink(const std::string& name);
+
+    // How often blocked calls wake up to check on the peer.
+    static constexpr int kPeerCheckMs = 100;
+
+private:
+    struct Header;
+    struct SlotHeader;
+
+    SlotHeader* slot(uint64_t index) const;
+    bool waitOn(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters, uint32_t seen);
+    bool awaitPeer();
+
+    std::string name_;
+    Role role_;
+    int fd_ = -1;
+    void* base_ = nullptr;
+    size_t mapped_bytes_ = 0;
+    Header* header_ = nullptr;
+    int reattach_ms_ = 0;
+    std::unique_ptr<QueueStats> stats_;
+};
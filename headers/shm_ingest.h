@@ -0,0 +1,56 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "frame_source.h"
+
+// Frames written into shared memory by an external process through the C API
+// in yolo_ingest.h. Each frame is a view of its slot, not a copy; the slot
+// goes back to the producer once every envelope holding it has let go (see
+// FrameEnvelope::releaseImage). Frames in flight are therefore bounded by the
+// slot count: with every slot held, the producer waits or drops.
+class ShmIngestSource : public FrameSource {
+public:
+    // Attaches to the segment as its consumer, creating it if the producer
+    // has not yet. slot_count/slot_bytes are only used by whichever side
+    // creates it. Throws std::runtime_error if it cannot be opened.
+    explicit ShmIngestSource(const std::string& name, int source_id = 0,
+                             size_t slot_count = 8, size_t slot_bytes = 1920 * 1080 * 3);
+    ~ShmIngestSource() override;
+
+    ShmIngestSource(const ShmIngestSource&) = delete;
+    ShmIngestSource& operator=(const ShmIngestSource&) = delete;
+
+    // Returns false once the producer closed the stream and it is drained,
+    // the producer died, or close() was called.
+    bool pop(FrameEnvelope& frame) override;
+
+    // Like pop, but also returns false after timeout_ms without a frame;
+    // isClosed() tells the two apart.
+    bool popFor(FrameEnvelope& frame, int timeout_ms);
+
+    void close() override;
+    bool isClosed() const override;
+
+    uint64_t taken() const;
+    uint64_t released() const;
+    void reportStats(std::ostream& os) const override;
+
+    // How often a blocked pop wakes up to check on the producer.
+    static constexpr int kPeerCheckMs = 100;
+
+private:
+    struct Segment;
+
+    std::string name_;
+    int source_id_;
+    std::shared_ptr<Segment> segment_;  // outlives this source while frames are in flight
+    std::atomic<bool> closed_{false};
+    std::atomic<uint64_t> taken_{0};
+};
+
+// Producer-thread body for --video shm:<name>: forwards ingested frames into
+// the pipeline's queue until the stream ends or running is cleared, then
+// closes the sink.
+void ingestProducer(FrameSink& sink, const std::string& name, int source_id, std::atomic<bool>& running);
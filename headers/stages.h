@@ -0,0 +1,27 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include "frame_source.h"
+#include "frame_skip.h"
+#include "infer_engine.h"
+#include "pacing.h"
+#include "render.h"
+#include "work_stealing_pool.h"
+
+// The two halves of the serial pipeline, defined in src/frame.cpp.
+
+// Decodes a video file or camera ("0") into the sink, decoding only every
+// decode_stride-th frame and none the sink would discard. Closes the sink
+// when done. Given the consumer's frame-skip controller, which only makes
+// sense when nothing is drawn, the producer takes the skip decision for
+// stream `stream` itself and sends skipped frames on undecoded, without
+// pixels.
+void producer(FrameSink& fq, const std::string& video_path, std::atomic<bool>& running,
+              const Pacing& pacing, int decode_stride, FrameSkipController* skip = nullptr, int stream = 0);
+
+// Preprocess, infer, postprocess, track and output on one thread until the
+// source is closed and drained or running is cleared.
+void consumer(FrameSource& source, InferEngine& engine, std::atomic<bool>& running,
+              float conf_threshold, float nms_threshold, double stats_interval_sec,
+              const OutputOptions& output, FrameSkipController& skip,
+              const TrackerConfig& tracker, WorkStealingPool* cpu_pool);
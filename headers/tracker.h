@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "opencv_minimal.h"
+#include "nms.h"
+#include "work_stealing_pool.h"
+
+struct Track {
+    int id;
+    cv::Rect2f box;
+    float conf;
+    int cls;
+    int age;
+    int lost;
+    cv::Rect2f smooth;
+};
+
+// How tracks are paired with detections once the admissible pairs (same
+// class, confident enough, overlapping by at least match_iou) are known.
+enum class TrackMatch {
+    Greedy,   // each track in turn takes its best free detection; order-dependent
+    Optimal   // the pairing with the highest summed IoU
+};
+
+struct TrackerConfig {
+    TrackMatch match = TrackMatch::Optimal;
+    std::vector<int> allowed_classes = {2, 3, 5, 7};  // empty tracks every class
+    float alpha = 0.7f;       // weight of the new detection in the smoothed box
+    float match_iou = 0.4f;
+    float enter_conf = 0.5f;  // to start a track, or match one that has not been confirmed
+    float keep_conf = 0.3f;   // to keep matching an established track
+    // Above 0, tracks still unmatched after the first pass get a second one
+    // against the leftover detections between low_conf and keep_conf, so a
+    // partly occluded object keeps its track. These never start a track.
+    float low_conf = 0.0f;
+    int min_age_draw = 2;
+    int grace_lost = 3;       // frames a track may go unmatched before it is dropped
+};
+
+// "greedy" or "optimal"; throws std::invalid_argument otherwise.
+TrackMatch parseTrackMatch(const std::string& name);
+
+// IoU tracker that matches tracks to detections of the same class and
+// smooths boxes exponentially. Only pairs whose boxes can overlap are
+// scored: detections are swept in order of their left edge.
+class Tracker {
+public:
+    explicit Tracker(const TrackerConfig& config = TrackerConfig());
+
+    const std::vector<Track>& update(const std::vector<Detection>& detections);
+
+    const std::vector<Track>& tracks() const { return tracks_; }
+    const TrackerConfig& config() const { return config_; }
+
+    // Computes track/detection overlaps on the pool once there are enough
+    // pairs to be worth it.
+    void setPool(WorkStealingPool* pool) { pool_ = pool; }
+
+private:
+    // One round of matching; the low pass only pairs established tracks left
+    // unmatched with detections below their confidence gate.
+    void matchPass(const std::vector<Detection>& filtered, const std::vector<int>& by_left, float max_width,
+                   bool low_pass, std::vector<int>& track_assigned, std::vector<int>& det_assigned) const;
+
+    TrackerConfig config_;
+    WorkStealingPool* pool_ = nullptr;
+    std::vector<Track> tracks_;
+    int next_id_ = 1;
+};
+
+float iouRect(const cv::Rect2f& a, const cv::Rect2f& b);
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include "opencv_minimal.h"
+#include "bounded_queue.h"
+
+struct VideoWriterConfig {
+    std::string path = "output.mp4";  // the container follows the extension
+    std::string codec = "MJPG";       // FourCC
+    double fps = 0.0;                 // 0: use the source's rate (30 if unknown)
+    size_t queue_capacity = 8;
+    bool drop_when_behind = true;     // false: block the caller instead
+};
+
+// Encodes on the caller's thread. The file is opened on the first frame, at
+// the configured fps or the source fps carried with it. cv::VideoWriter has
+// no per-frame timestamps, so to keep the output's timing faithful to the
+// source, gaps in the source timestamps (dropped or skipped frames) are
+// filled by repeating the last written frame, at most one second's worth.
+// One thread writes; the counters may be read from any.
+class VideoEncoder {
+public:
+    // Throws std::invalid_argument for a malformed codec.
+    explicit VideoEncoder(const VideoWriterConfig& config);
+    ~VideoEncoder();
+
+    VideoEncoder(const VideoEncoder&) = delete;
+    VideoEncoder& operator=(const VideoEncoder&) = delete;
+
+    // timestamp_ms < 0 and source_fps <= 0 mean unknown. Returns false if
+    // the file could not be opened.
+    bool write(const cv::Mat& frame, double timestamp_ms, double source_fps);
+
+    // Finishes the file.
+    void close();
+
+    const std::string& path() const { return config_.path; }
+    bool failed() const { return failed_.load(); }
+    uint64_t written() const { return written_.load(); }
+    uint64_t repeated() const { return repeated_.load(); }
+    Log2Histogram::Snapshot encodeMicros() const { return encode_us_.snapshot(); }
+
+    void reportStats(std::ostream& os) const;
+
+private:
+    bool open(const cv::Mat& first, double source_fps);
+
+    VideoWriterConfig config_;
+    cv::VideoWriter writer_;
+    double fps_ = 0.0;
+    cv::Mat last_;
+    double first_ts_ = -1.0;
+    uint64_t frames_out_ = 0;  // written + repeated
+    std::atomic<bool> failed_{false};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> repeated_{0};
+    Log2Histogram encode_us_;
+};
+
+// A VideoEncoder on a thread of its own behind a bounded queue, so encoding
+// never runs on the detection path. When the encoder falls behind it either
+// drops frames or, with drop_when_behind off, blocks write() until there is
+// room.
+class AsyncVideoWriter {
+public:
+    explicit AsyncVideoWriter(const VideoWriterConfig& config);
+    ~AsyncVideoWriter();
+
+    AsyncVideoWriter(const AsyncVideoWriter&) = delete;
+    AsyncVideoWriter& operator=(const AsyncVideoWriter&) = delete;
+
+    // Queues a frame; the writer keeps a reference, so the caller must not
+    // modify it afterwards. timestamp_ms < 0 and source_fps <= 0 mean
+    // unknown. Returns false if the frame was dropped or the writer closed.
+    bool write(const cv::Mat& frame, double timestamp_ms, double source_fps);
+
+    // Encodes what is still queued and finishes the file.
+    void close();
+
+    bool failed() const { return encoder_.failed(); }
+    uint64_t written() const { return encoder_.written(); }
+    uint64_t repeated() const { return encoder_.repeated(); }
+    uint64_t dropped() const { return queue_.stats().dropped; }
+
+    void reportStats(std::ostream& os) const;
+
+private:
+    struct Item {
+        cv::Mat frame;
+        double timestamp_ms = -1.0;
+        double source_fps = 0.0;
+    };
+
+    void run();
+
+    VideoWriterConfig config_;
+    BoundedQueue<Item> queue_;
+    VideoEncoder encoder_;
+    std::thread thread_;
+};
+
+// Parses a FourCC such as "MJPG", "mp4v" or "avc1". Throws
+// std::invalid_argument unless it is exactly four characters.
+int parseFourcc(const std::string& codec);
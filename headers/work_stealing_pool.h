@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool for the CPU work around inference (preprocessing, decoding
+// predictions, tracking, drawing). Each worker owns a deque: it pushes and
+// pops its own tasks at the back and, when it runs dry, steals from the
+// front of a randomly chosen other worker. A burst of work from one stream
+// therefore spreads over every idle core instead of staying on the thread
+// that produced it.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threads <= 0 uses one per hardware thread.
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queues a task: on the calling worker's own deque, or spread round-robin
+    // when called from outside the pool.
+    void submit(Task task);
+
+    // Runs body(begin, end) over [0, count) in chunks of at most `grain`
+    // and returns when all chunks are done. The calling thread works on
+    // chunks too, so this also makes progress when every worker is busy and
+    // may be called from inside a task. Rethrows the first exception a
+    // chunk threw.
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    int threads() const { return static_cast<int>(workers_.size()); }
+    uint64_t executed() const { return executed_.load(std::memory_order_relaxed); }
+    uint64_t stolen() const { return stolen_.load(std::memory_order_relaxed); }
+
+    void reportStats(std::ostream& os) const;
+
+private:
+    struct Worker {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(int index);
+    // Runs one queued task if there is one: the worker's own newest task
+    // first, otherwise the oldest task of a random victim.
+    bool runOne(int self);
+    // Index of the calling thread in this pool, -1 for outside threads.
+    int currentWorker() const;
+
+    std::vector<std::unique_ptr<Worker>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> next_queue_{0};
+    std::atomic<size_t> queued_{0};
+    std::mutex sleep_mtx_;
+    std::condition_variable sleep_cv_;
+    bool stopping_ = false;
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+};
+
+// Runs body over [0, count) on the pool, or inline when there is none.
+inline void parallelFor(WorkStealingPool* pool, size_t count, size_t grain,
+                        const std::function<void(size_t, size_t)>& body) {
+    if (pool && count > grain) pool->parallelFor(count, grain, body);
+    else if (count > 0) body(0, count);
+}
@@ -0,0 +1,189 @@
+/*
+ * C interface to the detection library (yolo_detect.dll / libyolo_detect.so):
+ * preprocessing, ONNX Runtime inference, box decoding with NMS, and the IoU
+ * tracker, for embedding in another application.
+ *
+ * Frames are passed as a pointer to 8-bit BGR pixels with a row stride and
+ * are read in place. Results go into buffers the caller owns; the library
+ * keeps no pointers into them after a call returns.
+ *
+ *     yolo_engine* engine;
+ *     if (yolo_engine_create("yolov8n.onnx", NULL, &engine) != YOLO_OK) {
+ *         fprintf(stderr, "%s\n", yolo_last_error());
+ *     }
+ *     yolo_image image = {frame_data, width, height, stride};
+ *     yolo_detection boxes[256];
+ *     int32_t count;
+ *     yolo_detect(engine, &image, boxes, 256, &count);   // count may exceed 256
+ *
+ * An engine or tracker may be used from one thread at a time; create one per
+ * thread to run several in parallel.
+ *
+ * The option structures start with struct_size, which
+ * yolo_*_default_options() sets. The library reads only that many bytes and
+ * keeps its defaults for anything beyond, so options may gain fields at the
+ * end without breaking callers built against an older header. Every other
+ * structure changes layout only together with yolo_abi_version().
+ */
+#ifndef YOLO_DETECT_H
+#define YOLO_DETECT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(YOLO_DETECT_STATIC)
+#define YOLO_API
+#elif defined(_WIN32)
+#ifdef YOLO_DETECT_BUILD
+#define YOLO_API __declspec(dllexport)
+#else
+#define YOLO_API __declspec(dllimport)
+#endif
+#else
+#define YOLO_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define YOLO_ABI_VERSION 2
+
+typedef enum {
+    YOLO_OK = 0,
+    YOLO_ERROR_INVALID_ARGUMENT = -1,
+    YOLO_ERROR_MODEL = -2,      /* the model could not be loaded */
+    YOLO_ERROR_INFERENCE = -3,
+    YOLO_ERROR_INTERNAL = -4
+} yolo_status;
+
+typedef struct yolo_engine yolo_engine;
+typedef struct yolo_tracker yolo_tracker;
+
+typedef struct {
+    const uint8_t* data;   /* BGR, 3 bytes per pixel */
+    int32_t width;
+    int32_t height;
+    int32_t stride;        /* bytes from one row to the next, at least width * 3 */
+} yolo_image;
+
+typedef struct {
+    float x, y, width, height;
+} yolo_box;
+
+typedef struct {
+    yolo_box box;          /* source-image pixels */
+    float conf;
+    int32_t cls;           /* COCO class index */
+} yolo_detection;
+
+typedef struct {
+    int32_t id;
+    int32_t cls;
+    int32_t age;           /* frames matched since the track started */
+    int32_t lost;          /* frames since the last match */
+    float conf;
+    yolo_box box;          /* last matched detection */
+    yolo_box smooth;       /* exponentially smoothed box, for drawing */
+} yolo_track;
+
+/* How a frame was letterboxed into the model input; needed to map model
+ * boxes back to the frame. */
+typedef struct {
+    float scale;
+    int32_t pad_x;
+    int32_t pad_y;
+    int32_t source_width;
+    int32_t source_height;
+} yolo_letterbox;
+
+typedef struct {
+    uint32_t struct_size;  /* sizeof(yolo_engine_options) */
+    float conf_threshold;  /* default 0.25 */
+    float nms_threshold;   /* default 0.45 */
+    int32_t cpu_threads;   /* pool for preprocessing and decoding; 0 runs on the caller (default) */
+} yolo_engine_options;
+
+/* How yolo_tracker_options pairs tracks with the detections they overlap. */
+typedef enum {
+    YOLO_TRACK_MATCH_OPTIMAL = 0,  /* the pairing with the highest summed IoU */
+    YOLO_TRACK_MATCH_GREEDY = 1    /* each track in turn takes its best free detection; faster */
+} yolo_track_match;
+
+typedef struct {
+    uint32_t struct_size;  /* sizeof(yolo_tracker_options) */
+    const int32_t* classes;  /* classes to track; NULL tracks every class */
+    int32_t class_count;
+    float alpha;           /* weight of a new detection in the smoothed box */
+    float match_iou;
+    float enter_conf;      /* to start a track, or match one not yet confirmed */
+    float keep_conf;       /* to keep matching an established track */
+    int32_t grace_lost;    /* frames a track may go unmatched before it is dropped */
+    /* Not in the first ABI version 2 layout; older callers get the defaults. */
+    int32_t match;         /* yolo_track_match; default YOLO_TRACK_MATCH_OPTIMAL */
+    float low_conf;        /* above 0, established tracks left unmatched may take a detection
+                            * scoring between this and keep_conf; default 0 (off) */
+} yolo_tracker_options;
+
+YOLO_API int32_t yolo_abi_version(void);
+
+/* Message for the last failed call on this thread. */
+YOLO_API const char* yolo_last_error(void);
+
+YOLO_API void yolo_engine_default_options(yolo_engine_options* options);
+
+/* options may be NULL for the defaults; otherwise start from
+ * yolo_engine_default_options(). A struct_size smaller than the first
+ * layout with the field is rejected. */
+YOLO_API yolo_status yolo_engine_create(const char* model_path, const yolo_engine_options* options,
+                                        yolo_engine** engine);
+YOLO_API void yolo_engine_destroy(yolo_engine* engine);
+
+/* Model input size, and the per-image sizes of the buffers that
+ * yolo_preprocess and yolo_infer write. prediction_floats is 0 if the model
+ * has a dynamic output shape, in which case only yolo_detect* work. */
+YOLO_API void yolo_engine_input_size(const yolo_engine* engine, int32_t* width, int32_t* height);
+YOLO_API size_t yolo_engine_blob_floats(const yolo_engine* engine);
+YOLO_API size_t yolo_engine_prediction_floats(const yolo_engine* engine, int32_t* rows, int32_t* cols);
+
+/* Whole pipeline for one frame. Writes up to capacity detections, best
+ * first, and sets *count to how many were found. */
+YOLO_API yolo_status yolo_detect(yolo_engine* engine, const yolo_image* image,
+                                 yolo_detection* detections, int32_t capacity, int32_t* count);
+
+/* n frames in one inference call when the model has a dynamic batch
+ * dimension. Frame i's detections go to detections + i * capacity and its
+ * count to counts[i]. */
+YOLO_API yolo_status yolo_detect_batch(yolo_engine* engine, const yolo_image* images, int32_t n,
+                                       yolo_detection* detections, int32_t capacity, int32_t* counts);
+
+/* The three steps of yolo_detect, for callers that schedule them. blob holds
+ * yolo_engine_blob_floats() floats per image, predictions
+ * yolo_engine_prediction_floats() per image. */
+YOLO_API yolo_status yolo_preprocess(const yolo_engine* engine, const yolo_image* image, float* blob,
+                                     yolo_letterbox* letterbox);
+YOLO_API yolo_status yolo_infer(yolo_engine* engine, const float* blob, int32_t batch, float* predictions);
+YOLO_API yolo_status yolo_postprocess(const yolo_engine* engine, const float* predictions,
+                                      const yolo_letterbox* letterbox,
+                                      yolo_detection* detections, int32_t capacity, int32_t* count);
+
+YOLO_API void yolo_tracker_default_options(yolo_tracker_options* options);
+
+/* options may be NULL for the defaults (vehicles only: car, motorcycle, bus,
+ * truck); otherwise start from yolo_tracker_default_options(). The class
+ * list is copied. */
+YOLO_API yolo_status yolo_tracker_create(const yolo_tracker_options* options, yolo_tracker** tracker);
+YOLO_API void yolo_tracker_destroy(yolo_tracker* tracker);
+
+/* Advances the tracker by one frame. Writes up to capacity tracks and sets
+ * *count to how many there are. These include tracks not matched this frame
+ * but still within grace_lost frames; they have lost > 0 and keep their last
+ * box, so check lost before treating a track as seen. */
+YOLO_API yolo_status yolo_tracker_update(yolo_tracker* tracker, const yolo_detection* detections, int32_t n,
+                                         yolo_track* tracks, int32_t capacity, int32_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* YOLO_DETECT_H */
@@ -0,0 +1,301 @@
+/*
+ * Shared-memory frame ingestion for external producers (Linux, C99 or C++;
+ * strict -std=c99 builds need _GNU_SOURCE for syscall() and usleep()).
+ *
+ * A capture process that already holds frames in memory writes them straight
+ * into slots of a POSIX shared-memory segment; the detection pipeline wraps
+ * each slot as a cv::Mat without copying and hands it back once the frame has
+ * been preprocessed (or drawn, when output is on). Run the pipeline with
+ * --video shm:<name>.
+ *
+ *     yolo_ingest q;
+ *     if (yolo_ingest_open(&q, "cam0", YOLO_INGEST_PRODUCER, 8, 1920 * 1080 * 3) != 0) ...
+ *     for (;;) {
+ *         uint8_t* pixels;
+ *         int slot = yolo_ingest_acquire(&q, 1000, &pixels);   // waits for a free slot
+ *         if (slot == YOLO_INGEST_CLOSED) break;
+ *         if (slot < 0) continue;                              // timed out
+ *         ... write a BGR frame to pixels, rows `stride` bytes apart ...
+ *         yolo_ingest_publish(&q, slot, width, height, stride, timestamp_ms);
+ *     }
+ *     yolo_ingest_close(&q);
+ *     yolo_ingest_detach(&q);
+ *
+ * One producer and one consumer per segment; use one segment per camera.
+ * Whichever side opens first creates the segment with its slot count and
+ * size. Slots are handed back in any order, so a slow frame does not hold
+ * up the others. Both sides sleep on futex words in the segment (eventfds
+ * cannot be shared by name between unrelated processes).
+ */
+#ifndef YOLO_INGEST_H
+#define YOLO_INGEST_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define YOLO_INGEST_MAGIC 0x474E4959u /* "YING" */
+#define YOLO_INGEST_VERSION 1u
+#define YOLO_INGEST_MAX_SLOTS 64u
+#define YOLO_INGEST_ALIGN 4096u
+
+enum { YOLO_INGEST_PRODUCER = 0, YOLO_INGEST_CONSUMER = 1 };
+enum { YOLO_INGEST_TIMEOUT = -1, YOLO_INGEST_CLOSED = -2 };
+enum { YOLO_SLOT_FREE = 0, YOLO_SLOT_WRITING = 1, YOLO_SLOT_READY = 2, YOLO_SLOT_IN_USE = 3 };
+
+typedef struct {
+    uint32_t state;        /* YOLO_SLOT_* */
+    int32_t width;
+    int32_t height;
+    int32_t stride;        /* bytes per row, at least width * 3 */
+    uint64_t seq;
+    int64_t publish_ns;    /* CLOCK_MONOTONIC */
+    double timestamp_ms;   /* stream time, negative if unknown */
+    uint8_t pad_[24];
+} yolo_ingest_slot;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t ready;        /* set once the creator has filled in the header */
+    uint64_t slot_bytes;
+    uint64_t data_offset;  /* slot i's pixels start at data_offset + i * slot_bytes */
+    uint8_t pad0_[32];
+
+    uint32_t published;    /* futex: frames published; ring[published % slot_count] is the newest */
+    uint32_t taken;        /* frames the consumer has taken */
+    uint32_t released;     /* futex: bumped whenever a slot becomes free */
+    uint32_t closed;
+    int32_t producer_pid;
+    int32_t consumer_pid;
+    uint64_t next_seq;
+    uint8_t pad1_[32];
+
+    uint32_t ring[YOLO_INGEST_MAX_SLOTS];        /* slot indices in publish order */
+    yolo_ingest_slot slots[YOLO_INGEST_MAX_SLOTS];
+} yolo_ingest_header;
+
+typedef struct {
+    yolo_ingest_header* header;
+    uint8_t* base;
+    size_t size;
+    int role;
+    uint32_t scan;         /* producer: where the search for a free slot starts */
+    char name[64];
+} yolo_ingest;
+
+static inline uint32_t yolo_ingest_load_(const uint32_t* p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static inline void yolo_ingest_store_(uint32_t* p, uint32_t v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+static inline void yolo_ingest_wait_(uint32_t* word, uint32_t seen, int timeout_ms) {
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, word, FUTEX_WAIT, seen, timeout_ms >= 0 ? &ts : NULL, NULL, 0);
+}
+
+static inline void yolo_ingest_wake_(uint32_t* word) {
+    syscall(SYS_futex, word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+static inline int64_t yolo_ingest_now_ns_(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Creates the segment, or attaches to it if it exists (then slots and
+ * slot_bytes are ignored). name may omit the leading '/'. Returns 0 or a
+ * negative errno. */
+static inline int yolo_ingest_open(yolo_ingest* q, const char* name, int role, uint32_t slots, uint64_t slot_bytes) {
+    memset(q, 0, sizeof(*q));
+    snprintf(q->name, sizeof(q->name), "%s%s", name[0] == '/' ? "" : "/", name);
+    q->role = role;
+    if (slots == 0 || slots > YOLO_INGEST_MAX_SLOTS || slot_bytes == 0) return -EINVAL;
+
+    const size_t header_bytes = (sizeof(yolo_ingest_header) + YOLO_INGEST_ALIGN - 1) / YOLO_INGEST_ALIGN * YOLO_INGEST_ALIGN;
+    slot_bytes = (slot_bytes + YOLO_INGEST_ALIGN - 1) / YOLO_INGEST_ALIGN * YOLO_INGEST_ALIGN;
+    int created = 1;
+    int fd = shm_open(q->name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0) {
+        q->size = header_bytes + (size_t)slots * slot_bytes;
+        if (ftruncate(fd, (off_t)q->size) != 0) {
+            int err = errno;
+            close(fd);
+            shm_unlink(q->name);
+            return -err;
+        }
+    } else if (errno == EEXIST) {
+        struct stat st;
+        int i;
+        created = 0;
+        fd = shm_open(q->name, O_RDWR, 0600);
+        if (fd < 0) return -errno;
+        /* The creator may still be sizing it. */
+        for (i = 0; i < 200; i++) {
+            if (fstat(fd, &st) == 0 && (size_t)st.st_size >= header_bytes) break;
+            usleep(10000);
+        }
+        if ((size_t)st.st_size < header_bytes) {
+            close(fd);
+            return -EAGAIN;
+        }
+        q->size = (size_t)st.st_size;
+    } else {
+        return -errno;
+    }
+
+    void* base = mmap(NULL, q->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) return -err;
+    q->base = (uint8_t*)base;
+    q->header = (yolo_ingest_header*)base;
+
+    yolo_ingest_header* h = q->header;
+    if (created) {
+        h->magic = YOLO_INGEST_MAGIC;
+        h->version = YOLO_INGEST_VERSION;
+        h->slot_count = slots;
+        h->slot_bytes = slot_bytes;
+        h->data_offset = header_bytes;
+        yolo_ingest_store_(&h->ready, 1);
+    } else {
+        int i;
+        for (i = 0; i < 200 && !yolo_ingest_load_(&h->ready); i++) usleep(10000);
+        if (!yolo_ingest_load_(&h->ready) || h->magic != YOLO_INGEST_MAGIC || h->version != YOLO_INGEST_VERSION) {
+            munmap(base, q->size);
+            q->header = NULL;
+            return -EPROTO;
+        }
+    }
+    /* Slots a previous process in this role died holding are free again. */
+    {
+        uint32_t i, held = role == YOLO_INGEST_PRODUCER ? YOLO_SLOT_WRITING : YOLO_SLOT_IN_USE;
+        for (i = 0; i < h->slot_count; i++) {
+            if (yolo_ingest_load_(&h->slots[i].state) == held) yolo_ingest_store_(&h->slots[i].state, YOLO_SLOT_FREE);
+        }
+    }
+    if (role == YOLO_INGEST_PRODUCER) {
+        /* A new producer starts a new stream on a segment left closed. */
+        yolo_ingest_store_(&h->closed, 0);
+        __atomic_store_n(&h->producer_pid, (int32_t)getpid(), __ATOMIC_RELEASE);
+    } else {
+        __atomic_store_n(&h->consumer_pid, (int32_t)getpid(), __ATOMIC_RELEASE);
+    }
+    return 0;
+}
+
+static inline void yolo_ingest_detach(yolo_ingest* q) {
+    if (!q->header) return;
+    if (q->role == YOLO_INGEST_PRODUCER) __atomic_store_n(&q->header->producer_pid, 0, __ATOMIC_RELEASE);
+    else __atomic_store_n(&q->header->consumer_pid, 0, __ATOMIC_RELEASE);
+    munmap(q->base, q->size);
+    q->header = NULL;
+}
+
+static inline uint8_t* yolo_ingest_pixels(const yolo_ingest* q, int slot) {
+    return q->base + q->header->data_offset + (size_t)slot * q->header->slot_bytes;
+}
+
+/* Producer: waits up to timeout_ms (-1: forever) for a free slot. Returns its
+ * index and pixel pointer, YOLO_INGEST_TIMEOUT or YOLO_INGEST_CLOSED. */
+static inline int yolo_ingest_acquire(yolo_ingest* q, int timeout_ms, uint8_t** pixels) {
+    yolo_ingest_header* h = q->header;
+    for (;;) {
+        uint32_t seen = yolo_ingest_load_(&h->released);
+        uint32_t i;
+        if (yolo_ingest_load_(&h->closed)) return YOLO_INGEST_CLOSED;
+        for (i = 0; i < h->slot_count; i++) {
+            uint32_t s = (q->scan + i) % h->slot_count;
+            if (yolo_ingest_load_(&h->slots[s].state) == YOLO_SLOT_FREE) {
+                yolo_ingest_store_(&h->slots[s].state, YOLO_SLOT_WRITING);
+                q->scan = s + 1;
+                *pixels = yolo_ingest_pixels(q, (int)s);
+                return (int)s;
+            }
+        }
+        if (timeout_ms == 0) return YOLO_INGEST_TIMEOUT;
+        yolo_ingest_wait_(&h->released, seen, timeout_ms);
+        if (timeout_ms > 0 && yolo_ingest_load_(&h->released) == seen) return YOLO_INGEST_TIMEOUT;
+    }
+}
+
+/* Producer: hands a filled slot to the pipeline. Returns 0, or -EINVAL if
+ * the frame does not fit the slot (the slot stays acquired). */
+static inline int yolo_ingest_publish(yolo_ingest* q, int slot, int width, int height, int stride, double timestamp_ms) {
+    yolo_ingest_header* h = q->header;
+    yolo_ingest_slot* s = &h->slots[slot];
+    if (width <= 0 || height <= 0 || stride < width * 3 || (uint64_t)stride * height > h->slot_bytes) return -EINVAL;
+    s->width = width;
+    s->height = height;
+    s->stride = stride;
+    s->seq = h->next_seq++;
+    s->publish_ns = yolo_ingest_now_ns_();
+    s->timestamp_ms = timestamp_ms;
+    yolo_ingest_store_(&s->state, YOLO_SLOT_READY);
+    uint32_t n = h->published;
+    h->ring[n % h->slot_count] = (uint32_t)slot;
+    yolo_ingest_store_(&h->published, n + 1);
+    yolo_ingest_wake_(&h->published);
+    return 0;
+}
+
+/* Producer: ends the stream; the pipeline drains what was published. */
+static inline void yolo_ingest_close(yolo_ingest* q) {
+    yolo_ingest_store_(&q->header->closed, 1);
+    yolo_ingest_wake_(&q->header->published);
+}
+
+/* Consumer: waits up to timeout_ms for the next published frame. Returns its
+ * slot, YOLO_INGEST_TIMEOUT, or YOLO_INGEST_CLOSED once closed and drained. */
+static inline int yolo_ingest_take(yolo_ingest* q, int timeout_ms) {
+    yolo_ingest_header* h = q->header;
+    for (;;) {
+        uint32_t published = yolo_ingest_load_(&h->published);
+        uint32_t taken = h->taken;
+        if (taken != published) {
+            uint32_t slot = h->ring[taken % h->slot_count];
+            yolo_ingest_store_(&h->slots[slot].state, YOLO_SLOT_IN_USE);
+            yolo_ingest_store_(&h->taken, taken + 1);
+            return (int)slot;
+        }
+        if (yolo_ingest_load_(&h->closed)) {
+            /* A frame may have been published just before closing. */
+            if (yolo_ingest_load_(&h->published) != taken) continue;
+            return YOLO_INGEST_CLOSED;
+        }
+        if (timeout_ms == 0) return YOLO_INGEST_TIMEOUT;
+        yolo_ingest_wait_(&h->published, published, timeout_ms);
+        if (timeout_ms > 0 && yolo_ingest_load_(&h->published) == published && !yolo_ingest_load_(&h->closed)) {
+            return YOLO_INGEST_TIMEOUT;
+        }
+    }
+}
+
+/* Consumer: gives a taken slot back to the producer. Any thread, any order. */
+static inline void yolo_ingest_release(yolo_ingest* q, int slot) {
+    yolo_ingest_header* h = q->header;
+    yolo_ingest_store_(&h->slots[slot].state, YOLO_SLOT_FREE);
+    __atomic_add_fetch(&h->released, 1, __ATOMIC_RELEASE);
+    yolo_ingest_wake_(&h->released);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* YOLO_INGEST_H */
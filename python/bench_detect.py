@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Frames per second of the detection paths available from Python.
+
+  cv2.dnn      the path models/convert_model.py tests an export with
+               (blobFromImage + forward), plus decoding and NMS in NumPy
+  ultralytics  YOLO(...).predict, if --weights is given and it is installed
+  bindings     Detector.detect from python/yolo_detect.py, one frame a call
+  batch        Detector.detect_batch, --batch frames a call
+  threads      --threads threads with a Detector each, to show the GIL is
+               released during inference
+
+    python python/bench_detect.py --model yolov8n.onnx --image data/frame.jpg
+"""
+
+import argparse
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+import cv2
+
+from yolo_detect import Detector
+
+
+def cv2_dnn_detector(model_path, imgsz, conf, nms):
+    net = cv2.dnn.readNetFromONNX(str(model_path))
+
+    def detect(frame):
+        blob = cv2.dnn.blobFromImage(frame, 1 / 255.0, (imgsz, imgsz), swapRB=True, crop=False)
+        net.setInput(blob)
+        out = net.forward()[0].T  # 8400 x 84
+        scores = out[:, 4:]
+        cls = scores.argmax(axis=1)
+        best = scores[np.arange(len(cls)), cls]
+        keep = best >= conf
+        boxes, best, cls = out[keep, :4], best[keep], cls[keep]
+        sx, sy = frame.shape[1] / imgsz, frame.shape[0] / imgsz
+        xywh = np.column_stack(((boxes[:, 0] - boxes[:, 2] / 2) * sx, (boxes[:, 1] - boxes[:, 3] / 2) * sy,
+                                boxes[:, 2] * sx, boxes[:, 3] * sy))
+        idx = cv2.dnn.NMSBoxes(xywh.tolist(), best.tolist(), conf, nms)
+        return [(xywh[i], best[i], cls[i]) for i in np.array(idx).flatten()]
+
+    return detect
+
+
+def timed(name, frames, run):
+    run(frames[:2])  # warm-up: first-call allocations and lazy initialisation
+    start = time.perf_counter()
+    detections = run(frames)
+    seconds = time.perf_counter() - start
+    print(f"{name:<12} {len(frames) / seconds:8.1f} fps  {seconds * 1000 / len(frames):7.2f} ms/frame"
+          f"  {detections / len(frames):5.1f} detections/frame")
+    return len(frames) / seconds
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare Python detection paths")
+    parser.add_argument("--model", default="yolov8n.onnx")
+    parser.add_argument("--weights", default=None, help="YOLOv8 .pt weights to also time ultralytics")
+    parser.add_argument("--image", default=None, help="Frame to run on (default: a synthetic 1280x720 frame)")
+    parser.add_argument("--frames", type=int, default=100)
+    parser.add_argument("--batch", type=int, default=8)
+    parser.add_argument("--threads", type=int, default=4)
+    parser.add_argument("--imgsz", type=int, default=640)
+    parser.add_argument("--conf", type=float, default=0.25)
+    parser.add_argument("--nms", type=float, default=0.45)
+    args = parser.parse_args()
+
+    if args.image:
+        frame = cv2.imread(args.image)
+        if frame is None:
+            raise SystemExit(f"Could not read {args.image}")
+    else:
+        rng = np.random.default_rng(0)
+        frame = rng.integers(0, 256, (720, 1280, 3), dtype=np.uint8)
+    frames = [frame] * args.frames
+    print(f"[INFO] {args.frames} frames of {frame.shape[1]}x{frame.shape[0]}, model {args.model}")
+
+    results = {}
+    dnn = cv2_dnn_detector(args.model, args.imgsz, args.conf, args.nms)
+    results["cv2.dnn"] = timed("cv2.dnn", frames, lambda fs: sum(len(dnn(f)) for f in fs))
+
+    if args.weights:
+        try:
+            from ultralytics import YOLO
+            model = YOLO(args.weights)
+            predict = lambda f: len(model.predict(f, imgsz=args.imgsz, conf=args.conf, iou=args.nms,
+                                                  verbose=False)[0].boxes)
+            results["ultralytics"] = timed("ultralytics", frames, lambda fs: sum(predict(f) for f in fs))
+        except ImportError:
+            print("[WARN] ultralytics not installed, skipping it")
+
+    detector = Detector(args.model, conf=args.conf, nms=args.nms)
+    results["bindings"] = timed("bindings", frames, lambda fs: sum(len(detector.detect(f)) for f in fs))
+
+    def batched(fs):
+        return sum(len(d) for i in range(0, len(fs), args.batch) for d in detector.detect_batch(fs[i:i + args.batch]))
+    results["batch"] = timed("batch", frames, batched)
+    detector.close()
+
+    # One Detector per thread; with the GIL held during inference these
+    # would run one at a time.
+    detectors = [Detector(args.model, conf=args.conf, nms=args.nms) for _ in range(args.threads)]
+
+    def threaded(fs):
+        chunks = [fs[t::args.threads] for t in range(args.threads)]
+        with ThreadPoolExecutor(args.threads) as pool:
+            counts = pool.map(lambda t: sum(len(detectors[t].detect(f)) for f in chunks[t]), range(args.threads))
+            return sum(counts)
+    results["threads"] = timed(f"threads x{args.threads}", frames, threaded)
+    for d in detectors:
+        d.close()
+
+    base = results["cv2.dnn"]
+    print("[INFO] speed-up over cv2.dnn: " + ", ".join(f"{k} {v / base:.1f}x" for k, v in results.items() if k != "cv2.dnn"))
+
+
+if __name__ == "__main__":
+    main()
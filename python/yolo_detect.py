@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+"""Python bindings for the detection library (headers/yolo_detect.h).
+
+Loads libyolo_detect.so / yolo_detect.dll through ctypes, so there is no
+extension module to compile. Frames are HxWx3 uint8 BGR NumPy arrays, as
+cv2 returns them; their memory is passed to the library by pointer and row
+stride, so a frame, or a crop of one made by slicing, is not copied. Results
+are written straight into NumPy arrays allocated here. The GIL is released
+for the duration of every library call, so several threads, each with its
+own Detector, run in parallel.
+
+    from yolo_detect import Detector
+    detector = Detector("yolov8n.onnx")
+    dets = detector.detect(frame)            # structured array: box, conf, cls
+    for x, y, w, h in dets["box"]: ...
+    batches = detector.detect_batch(frames)  # one array per frame
+"""
+
+import ctypes
+import os
+from pathlib import Path
+
+import numpy as np
+
+ABI_VERSION = 2
+
+# Same layout as yolo_detection / yolo_track.
+DETECTION_DTYPE = np.dtype([("box", np.float32, (4,)), ("conf", np.float32), ("cls", np.int32)])
+TRACK_DTYPE = np.dtype([("id", np.int32), ("cls", np.int32), ("age", np.int32), ("lost", np.int32),
+                        ("conf", np.float32), ("box", np.float32, (4,)), ("smooth", np.float32, (4,))])
+
+
+class _Image(ctypes.Structure):
+    _fields_ = [("data", ctypes.c_void_p), ("width", ctypes.c_int32),
+                ("height", ctypes.c_int32), ("stride", ctypes.c_int32)]
+
+
+class _Letterbox(ctypes.Structure):
+    _fields_ = [("scale", ctypes.c_float), ("pad_x", ctypes.c_int32), ("pad_y", ctypes.c_int32),
+                ("source_width", ctypes.c_int32), ("source_height", ctypes.c_int32)]
+
+
+class _EngineOptions(ctypes.Structure):
+    _fields_ = [("struct_size", ctypes.c_uint32), ("conf_threshold", ctypes.c_float), ("nms_threshold", ctypes.c_float),
+                ("cpu_threads", ctypes.c_int32)]
+
+
+class _TrackerOptions(ctypes.Structure):
+    _fields_ = [("struct_size", ctypes.c_uint32),
+                ("classes", ctypes.POINTER(ctypes.c_int32)), ("class_count", ctypes.c_int32),
+                ("alpha", ctypes.c_float), ("match_iou", ctypes.c_float), ("enter_conf", ctypes.c_float),
+                ("keep_conf", ctypes.c_float), ("grace_lost", ctypes.c_int32),
+                ("match", ctypes.c_int32), ("low_conf", ctypes.c_float)]
+
+# yolo_track_match
+_TRACK_MATCH = {"optimal": 0, "greedy": 1}
+
+
+class DetectError(RuntimeError):
+    pass
+
+
+_LIB_NAMES = ("libyolo_detect.so", "yolo_detect.dll", "libyolo_detect.dylib")
+_lib = None
+
+
+def _load_library(path=None):
+    """Finds the library: an explicit path, $YOLO_DETECT_LIB, then next to
+    this file and in the repository root."""
+    global _lib
+    if _lib is not None and path is None:
+        return _lib
+    here = Path(__file__).resolve().parent
+    candidates = [path, os.environ.get("YOLO_DETECT_LIB")]
+    candidates += [str(d / name) for d in (here, here.parent) for name in _LIB_NAMES]
+    tried = []
+    for candidate in filter(None, candidates):
+        if not Path(candidate).exists():
+            tried.append(candidate)
+            continue
+        lib = ctypes.CDLL(candidate)  # CDLL, not PyDLL: calls run without the GIL
+        _declare(lib)
+        if lib.yolo_abi_version() != ABI_VERSION:
+            raise DetectError(f"{candidate} has ABI version {lib.yolo_abi_version()}, expected {ABI_VERSION}")
+        if path is None:
+            _lib = lib
+        return lib
+    raise DetectError("yolo_detect library not found; build it (see README) or set YOLO_DETECT_LIB. Tried: "
+                      + ", ".join(tried))
+
+
+def _declare(lib):
+    p, i32, sz = ctypes.c_void_p, ctypes.c_int32, ctypes.c_size_t
+    i32p = ctypes.POINTER(ctypes.c_int32)
+    signatures = {
+        "yolo_abi_version": (i32, []),
+        "yolo_last_error": (ctypes.c_char_p, []),
+        "yolo_engine_default_options": (None, [ctypes.POINTER(_EngineOptions)]),
+        "yolo_engine_create": (i32, [ctypes.c_char_p, ctypes.POINTER(_EngineOptions), ctypes.POINTER(p)]),
+        "yolo_engine_destroy": (None, [p]),
+        "yolo_engine_input_size": (None, [p, i32p, i32p]),
+        "yolo_engine_blob_floats": (sz, [p]),
+        "yolo_engine_prediction_floats": (sz, [p, i32p, i32p]),
+        "yolo_detect": (i32, [p, ctypes.POINTER(_Image), p, i32, i32p]),
+        "yolo_detect_batch": (i32, [p, ctypes.POINTER(_Image), i32, p, i32, i32p]),
+        "yolo_preprocess": (i32, [p, ctypes.POINTER(_Image), p, ctypes.POINTER(_Letterbox)]),
+        "yolo_infer": (i32, [p, p, i32, p]),
+        "yolo_postprocess": (i32, [p, p, ctypes.POINTER(_Letterbox), p, i32, i32p]),
+        "yolo_tracker_default_options": (None, [ctypes.POINTER(_TrackerOptions)]),
+        "yolo_tracker_create": (i32, [ctypes.POINTER(_TrackerOptions), ctypes.POINTER(p)]),
+        "yolo_tracker_destroy": (None, [p]),
+        "yolo_tracker_update": (i32, [p, p, i32, p, i32, i32p]),
+    }
+    for name, (restype, argtypes) in signatures.items():
+        fn = getattr(lib, name)
+        fn.restype = restype
+        fn.argtypes = argtypes
+
+
+def _check(lib, status, what):
+    if status != 0:
+        raise DetectError(f"{what}: {lib.yolo_last_error().decode(errors='replace')}")
+
+
+def _as_image(frame):
+    """Describes frame to the library without copying it. Only arrays whose
+    pixels are not packed within a row (e.g. a channel slice or a flip) are
+    made contiguous first. Returns the array too, to keep it alive."""
+    a = np.asarray(frame)
+    if a.dtype != np.uint8 or a.ndim != 3 or a.shape[2] != 3:
+        raise ValueError(f"expected an HxWx3 uint8 BGR frame, got {a.dtype} {a.shape}")
+    if a.strides[2] != 1 or a.strides[1] != 3 or a.strides[0] < 3 * a.shape[1]:
+        a = np.ascontiguousarray(a)
+    return _Image(a.ctypes.data, a.shape[1], a.shape[0], a.strides[0]), a
+
+
+class Letterbox:
+    """How preprocess() fitted a frame into the model input."""
+
+    def __init__(self, c):
+        self._c = c
+        self.scale = c.scale
+        self.padding = (c.pad_x, c.pad_y)
+        self.source_size = (c.source_width, c.source_height)
+
+
+class Detector:
+    """One model session with its preprocessing and box decoding. Not for
+    concurrent use: give each thread its own Detector."""
+
+    def __init__(self, model_path, conf=0.25, nms=0.45, cpu_threads=0, max_detections=1000, library=None):
+        self._engine = None
+        self._lib = _load_library(library)
+        options = _EngineOptions()
+        self._lib.yolo_engine_default_options(ctypes.byref(options))
+        options.conf_threshold, options.nms_threshold, options.cpu_threads = conf, nms, cpu_threads
+        handle = ctypes.c_void_p()
+        _check(self._lib, self._lib.yolo_engine_create(str(model_path).encode(), ctypes.byref(options),
+                                                       ctypes.byref(handle)), "Detector")
+        self._engine = handle
+        self.max_detections = max_detections
+        w, h, rows, cols = (ctypes.c_int32() for _ in range(4))
+        self._lib.yolo_engine_input_size(handle, ctypes.byref(w), ctypes.byref(h))
+        self._lib.yolo_engine_prediction_floats(handle, ctypes.byref(rows), ctypes.byref(cols))
+        self.input_size = (w.value, h.value)
+        self.output_shape = (rows.value, cols.value)  # (0, 0) if the model's output is dynamic
+
+    def close(self):
+        if self._engine:
+            self._lib.yolo_engine_destroy(self._engine)
+            self._engine = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def detect(self, frame):
+        """Detections in frame, best first, as a DETECTION_DTYPE array in
+        frame pixels. At most max_detections are returned."""
+        image, frame = _as_image(frame)
+        out = np.empty(self.max_detections, DETECTION_DTYPE)
+        count = ctypes.c_int32()
+        _check(self._lib, self._lib.yolo_detect(self._engine, ctypes.byref(image), out.ctypes.data,
+                                                self.max_detections, ctypes.byref(count)), "detect")
+        return out[:min(count.value, self.max_detections)]
+
+    def detect_batch(self, frames):
+        """detect() for a list of frames, run as one inference call when the
+        model has a dynamic batch dimension. Frames may differ in size."""
+        frames = list(frames)
+        if not frames:
+            return []
+        described = [_as_image(f) for f in frames]
+        images = (_Image * len(frames))(*(d[0] for d in described))
+        out = np.empty((len(frames), self.max_detections), DETECTION_DTYPE)
+        counts = np.zeros(len(frames), np.int32)
+        _check(self._lib, self._lib.yolo_detect_batch(
+            self._engine, images, len(frames), out.ctypes.data, self.max_detections,
+            counts.ctypes.data_as(ctypes.POINTER(ctypes.c_int32))), "detect_batch")
+        return [out[i, :min(int(c), self.max_detections)] for i, c in enumerate(counts)]
+
+    def preprocess(self, frame):
+        """Letterboxed, normalised 3xHxW float32 model input, and the Letterbox
+        to pass to postprocess()."""
+        image, frame = _as_image(frame)
+        w, h = self.input_size
+        blob = np.empty((3, h, w), np.float32)
+        letterbox = _Letterbox()
+        _check(self._lib, self._lib.yolo_preprocess(self._engine, ctypes.byref(image), blob.ctypes.data,
+                                                    ctypes.byref(letterbox)), "preprocess")
+        return blob, Letterbox(letterbox)
+
+    def infer(self, blobs):
+        """Raw predictions for a 3xHxW blob or an Nx3xHxW stack of them, shaped
+        (N, rows, cols). Needs a model whose output shape is fixed."""
+        blobs = np.ascontiguousarray(blobs, dtype=np.float32)
+        batch = 1 if blobs.ndim == 3 else blobs.shape[0]
+        if blobs.size != batch * 3 * self.input_size[0] * self.input_size[1]:
+            raise ValueError(f"expected blobs of 3x{self.input_size[1]}x{self.input_size[0]}, got {blobs.shape}")
+        if self.output_shape[0] <= 0:
+            raise DetectError("infer: the model's output shape is dynamic; use detect()")
+        predictions = np.empty((batch,) + self.output_shape, np.float32)
+        _check(self._lib, self._lib.yolo_infer(self._engine, blobs.ctypes.data, batch, predictions.ctypes.data),
+               "infer")
+        return predictions
+
+    def postprocess(self, predictions, letterbox):
+        """Decodes one frame's predictions, with NMS, into frame pixels."""
+        predictions = np.ascontiguousarray(predictions, dtype=np.float32)
+        if predictions.size != self.output_shape[0] * self.output_shape[1]:
+            raise ValueError(f"expected predictions of {self.output_shape}, got {predictions.shape}")
+        out = np.empty(self.max_detections, DETECTION_DTYPE)
+        count = ctypes.c_int32()
+        _check(self._lib, self._lib.yolo_postprocess(self._engine, predictions.ctypes.data,
+                                                     ctypes.byref(letterbox._c), out.ctypes.data,
+                                                     self.max_detections, ctypes.byref(count)), "postprocess")
+        return out[:min(count.value, self.max_detections)]
+
+
+class Tracker:
+    """IoU tracker over successive detect() results. classes=None keeps the
+    library default (vehicles); pass [] to track every class. match is
+    "optimal" or "greedy"; low_conf above 0 lets established tracks take
+    weaker detections down to that score in a second pass."""
+
+    def __init__(self, classes=None, match_iou=None, enter_conf=None, keep_conf=None, grace_lost=None,
+                 match=None, low_conf=None, max_tracks=1000, library=None):
+        self._tracker = None
+        self._lib = _load_library(library)
+        options = _TrackerOptions()
+        self._lib.yolo_tracker_default_options(ctypes.byref(options))
+        if classes is not None:
+            self._classes = (ctypes.c_int32 * max(1, len(classes)))(*classes)
+            options.classes = self._classes if classes else None
+            options.class_count = len(classes)
+        if match is not None:
+            if match not in _TRACK_MATCH:
+                raise ValueError("match must be 'optimal' or 'greedy', got %r" % (match,))
+            match = _TRACK_MATCH[match]
+        for name, value in (("match_iou", match_iou), ("enter_conf", enter_conf),
+                            ("keep_conf", keep_conf), ("grace_lost", grace_lost),
+                            ("match", match), ("low_conf", low_conf)):
+            if value is not None:
+                # A library older than this module reads only struct_size
+                # bytes and would ignore the field.
+                field = getattr(_TrackerOptions, name)
+                if field.offset + field.size > options.struct_size:
+                    raise DetectError("Tracker: the loaded library has no %s option" % name)
+                setattr(options, name, value)
+        handle = ctypes.c_void_p()
+        _check(self._lib, self._lib.yolo_tracker_create(ctypes.byref(options), ctypes.byref(handle)), "Tracker")
+        self._tracker = handle
+        self.max_tracks = max_tracks
+
+    def close(self):
+        if self._tracker:
+            self._lib.yolo_tracker_destroy(self._tracker)
+            self._tracker = None
+
+    def __del__(self):
+        self.close()
+
+    def update(self, detections):
+        """Advances by one frame; returns the tracks as a TRACK_DTYPE array.
+        Tracks not matched this frame but still within grace_lost have
+        lost > 0 and their last box; filter on lost == 0 for the ones seen."""
+        detections = np.ascontiguousarray(detections, dtype=DETECTION_DTYPE)
+        out = np.empty(self.max_tracks, TRACK_DTYPE)
+        count = ctypes.c_int32()
+        _check(self._lib, self._lib.yolo_tracker_update(self._tracker, detections.ctypes.data, len(detections),
+                                                        out.ctypes.data, self.max_tracks, ctypes.byref(count)),
+               "update")
+        return out[:min(count.value, self.max_tracks)]
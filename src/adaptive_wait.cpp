@@ -0,0 +1,146 @@
+#include "../headers/adaptive_wait.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ADAPTIVE_WAIT_X86 1
+#endif
+
+#if defined(__linux__)
+#include <cerrno>
+#include <ctime>
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#endif
+using namespace std;
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bits");
+
+void cpuRelax() {
+#if defined(ADAPTIVE_WAIT_X86)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+bool futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms, bool shared) {
+#if defined(__linux__)
+    struct timespec ts;
+    struct timespec* timeout = nullptr;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+        timeout = &ts;
+    }
+    int op = shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE;
+    long rc = syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, expected, timeout, nullptr, 0);
+    return !(rc == -1 && errno == ETIMEDOUT);
+#elif defined(_WIN32)
+    (void)shared;
+    DWORD ms = timeout_ms < 0 ? INFINITE : static_cast<DWORD>(timeout_ms);
+    if (!WaitOnAddress(&word, &expected, sizeof(expected), ms)) {
+        return GetLastError() != ERROR_TIMEOUT;
+    }
+    return true;
+#else
+    (void)shared;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (word.load(std::memory_order_acquire) == expected) {
+        if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) return false;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+    return true;
+#endif
+}
+
+void futexWake(std::atomic<uint32_t>& word, int count, bool shared) {
+#if defined(__linux__)
+    int op = shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, count, nullptr, nullptr, 0);
+#elif defined(_WIN32)
+    (void)shared;
+    if (count == 1) WakeByAddressSingle(&word);
+    else WakeByAddressAll(&word);
+#else
+    (void)word; (void)count; (void)shared;
+#endif
+}
+
+namespace {
+// CPUs this process may run on, which can be fewer than the machine has.
+unsigned usableCpuCount() {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        return static_cast<unsigned>(CPU_COUNT(&set));
+    }
+#endif
+    return std::thread::hardware_concurrency();
+}
+
+int64_t nanosSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+}
+
+void AdaptiveWaiter::adjustBudget(uint64_t target_spins) {
+    int32_t budget = static_cast<int32_t>(spin_budget_.load(std::memory_order_relaxed));
+    int32_t target = static_cast<int32_t>(std::clamp<uint64_t>(target_spins, kMinSpin, kMaxSpin));
+    spin_budget_.store(static_cast<uint32_t>(budget + (target - budget) / 8), std::memory_order_relaxed);
+}
+
+bool AdaptiveWaiter::spinFor(uint32_t seen) {
+    // With a single CPU the thread we wait for cannot run while we spin.
+    static const bool can_spin = usableCpuCount() > 1;
+    if (!can_spin) {
+        return false;
+    }
+
+    uint32_t budget = spin_budget_.load(std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < budget; i++) {
+        cpuRelax();
+        if (epoch_.load(std::memory_order_acquire) != seen) {
+            // Woken while spinning: aim for twice what this wait needed.
+            adjustBudget(2ull * (i + 1));
+            return true;
+        }
+    }
+    int64_t per_spin = nanosSince(start) / budget;
+    ns_per_spin_.store(static_cast<uint32_t>(std::max<int64_t>(1, per_spin)), std::memory_order_relaxed);
+    return false;
+}
+
+void AdaptiveWaiter::park(uint32_t seen) {
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    if (epoch_.load(std::memory_order_seq_cst) == seen) {
+        parks_.fetch_add(1, std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        futexWait(epoch_, seen);
+        // If a somewhat longer spin would have caught this wake, grow the
+        // budget towards it; waits far beyond kMaxSpin pull it back to kMinSpin.
+        uint64_t waited_spins = spin_budget_.load(std::memory_order_relaxed) +
+            static_cast<uint64_t>(nanosSince(start)) / ns_per_spin_.load(std::memory_order_relaxed);
+        adjustBudget(waited_spins <= kMaxSpin / 2 ? 2 * waited_spins : kMinSpin);
+    }
+    sleepers_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void AdaptiveWaiter::notify(int count) {
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_seq_cst) > 0) {
+        futexWake(epoch_, count);
+    }
+}
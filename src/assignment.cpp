@@ -0,0 +1,149 @@
+#include "../headers/assignment.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+using namespace std;
+
+namespace {
+struct DisjointSets {
+    vector<int> parent;
+
+    explicit DisjointSets(int n) : parent(n) { iota(parent.begin(), parent.end(), 0); }
+
+    int find(int x) {
+        while (parent[x] != x) x = parent[x] = parent[parent[x]];
+        return x;
+    }
+    void join(int a, int b) { parent[find(a)] = find(b); }
+};
+
+// Minimum-cost assignment of every row of an n x m cost matrix (n <= m) to a
+// distinct column: shortest augmenting paths with row and column potentials,
+// O(n^2 m). Returns the column of each row.
+vector<int> solveDense(const vector<double>& cost, int n, int m) {
+    const double inf = numeric_limits<double>::infinity();
+    // 1-based; column 0 is a virtual start for each augmenting path.
+    vector<double> u(n + 1, 0.0), v(m + 1, 0.0), min_slack(m + 1);
+    vector<int> row_of(m + 1, 0), previous(m + 1, 0);
+    vector<char> visited(m + 1);
+    for (int i = 1; i <= n; i++) {
+        row_of[0] = i;
+        int col = 0;
+        fill(min_slack.begin(), min_slack.end(), inf);
+        fill(visited.begin(), visited.end(), 0);
+        do {
+            visited[col] = 1;
+            const int row = row_of[col];
+            double delta = inf;
+            int next = 0;
+            for (int j = 1; j <= m; j++) {
+                if (visited[j]) continue;
+                double slack = cost[(row - 1) * m + (j - 1)] - u[row] - v[j];
+                if (slack < min_slack[j]) {
+                    min_slack[j] = slack;
+                    previous[j] = col;
+                }
+                if (min_slack[j] < delta) {
+                    delta = min_slack[j];
+                    next = j;
+                }
+            }
+            for (int j = 0; j <= m; j++) {
+                if (visited[j]) {
+                    u[row_of[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    min_slack[j] -= delta;
+                }
+            }
+            col = next;
+        } while (row_of[col] != 0);
+        // Flip the path back to its start.
+        do {
+            int prev = previous[col];
+            row_of[col] = row_of[prev];
+            col = prev;
+        } while (col != 0);
+    }
+    vector<int> assigned(n, -1);
+    for (int j = 1; j <= m; j++) {
+        if (row_of[j] != 0) assigned[row_of[j] - 1] = j - 1;
+    }
+    return assigned;
+}
+}
+
+std::vector<int> solveAssignment(int rows, int cols, const std::vector<AssignmentEdge>& edges) {
+    vector<int> match(rows, -1);
+    if (rows <= 0 || cols <= 0 || edges.empty()) return match;
+
+    // Rows are nodes [0, rows), columns [rows, rows + cols).
+    DisjointSets sets(rows + cols);
+    for (const auto& e : edges) sets.join(e.row, rows + e.col);
+
+    // Group edges by cluster and number each cluster's rows and columns.
+    vector<int> cluster_of(rows + cols, -1), local(rows + cols, -1);
+    vector<vector<int>> members;        // per cluster: its nodes
+    vector<vector<size_t>> cluster_edges;
+    for (size_t k = 0; k < edges.size(); k++) {
+        int root = sets.find(edges[k].row);
+        if (cluster_of[root] < 0) {
+            cluster_of[root] = static_cast<int>(members.size());
+            members.emplace_back();
+            cluster_edges.emplace_back();
+        }
+        int c = cluster_of[root];
+        cluster_edges[c].push_back(k);
+        for (int node : {edges[k].row, rows + edges[k].col}) {
+            if (local[node] < 0) {
+                local[node] = static_cast<int>(members[c].size());
+                members[c].push_back(node);
+            }
+        }
+    }
+
+    vector<double> cost;
+    vector<int> row_nodes, col_nodes;
+    for (size_t c = 0; c < members.size(); c++) {
+        row_nodes.clear();
+        col_nodes.clear();
+        for (int node : members[c]) (node < rows ? row_nodes : col_nodes).push_back(node);
+
+        // A lone pair needs no solver.
+        if (cluster_edges[c].size() == 1) {
+            const auto& e = edges[cluster_edges[c][0]];
+            match[e.row] = e.col;
+            continue;
+        }
+        for (size_t r = 0; r < row_nodes.size(); r++) local[row_nodes[r]] = static_cast<int>(r);
+        for (size_t j = 0; j < col_nodes.size(); j++) local[col_nodes[j]] = static_cast<int>(j);
+
+        // The solver assigns every row of the shorter side, so pairs without
+        // an edge cost as much as leaving both unmatched: maximising the
+        // summed score is minimising summed (best - score).
+        const bool transpose = row_nodes.size() > col_nodes.size();
+        const int n = static_cast<int>(transpose ? col_nodes.size() : row_nodes.size());
+        const int m = static_cast<int>(transpose ? row_nodes.size() : col_nodes.size());
+        float best = 0.0f;
+        for (size_t k : cluster_edges[c]) best = max(best, edges[k].score);
+        cost.assign(static_cast<size_t>(n) * m, best);
+        vector<char> admissible(static_cast<size_t>(n) * m, 0);
+        for (size_t k : cluster_edges[c]) {
+            const auto& e = edges[k];
+            int r = local[e.row], j = local[rows + e.col];
+            size_t cell = transpose ? static_cast<size_t>(j) * m + r : static_cast<size_t>(r) * m + j;
+            if (!admissible[cell] || best - e.score < cost[cell]) cost[cell] = best - e.score;
+            admissible[cell] = 1;
+        }
+
+        vector<int> assigned = solveDense(cost, n, m);
+        for (int i = 0; i < n; i++) {
+            int j = assigned[i];
+            if (j < 0 || !admissible[static_cast<size_t>(i) * m + j]) continue;
+            int row = transpose ? row_nodes[j] : row_nodes[i];
+            int col = (transpose ? col_nodes[i] : col_nodes[j]) - rows;
+            match[row] = col;
+        }
+    }
+    return match;
+}
@@ -0,0 +1,82 @@
+#include "../headers/coro_executor.h"
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+CoExecutor::CoExecutor(int threads) {
+    if (threads <= 0) threads = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    for (int i = 0; i < threads; i++) {
+        workers_.emplace_back(&CoExecutor::workerLoop, this);
+    }
+}
+
+CoExecutor::~CoExecutor() {
+    {
+        lock_guard<mutex> lock(mtx_);
+        stopping_ = true;
+    }
+    ready_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+    // Coroutines still suspended at this point are abandoned with their
+    // queues; destroying them here could race with their owners.
+}
+
+void CoExecutor::spawn(CoTask task) {
+    auto handle = std::exchange(task.handle_, nullptr);
+    handle.promise().executor = this;
+    {
+        lock_guard<mutex> lock(mtx_);
+        outstanding_++;
+    }
+    post(handle);
+}
+
+void CoExecutor::post(std::coroutine_handle<> handle) {
+    {
+        lock_guard<mutex> lock(mtx_);
+        ready_.push_back(handle);
+    }
+    ready_cv_.notify_one();
+}
+
+void CoExecutor::workerLoop() {
+    for (;;) {
+        std::coroutine_handle<> handle;
+        {
+            unique_lock<mutex> lock(mtx_);
+            ready_cv_.wait(lock, [this] { return stopping_ || !ready_.empty(); });
+            if (ready_.empty()) return;
+            handle = ready_.front();
+            ready_.pop_front();
+        }
+        resumes_.fetch_add(1, memory_order_relaxed);
+        handle.resume();
+    }
+}
+
+void CoExecutor::taskDone() {
+    bool all_done;
+    {
+        lock_guard<mutex> lock(mtx_);
+        all_done = --outstanding_ == 0;
+    }
+    if (all_done) done_cv_.notify_all();
+}
+
+void CoExecutor::taskFailed(std::exception_ptr error) {
+    lock_guard<mutex> lock(mtx_);
+    if (!error_) error_ = error;
+}
+
+void CoExecutor::wait() {
+    unique_lock<mutex> lock(mtx_);
+    done_cv_.wait(lock, [this] { return outstanding_ == 0; });
+    if (error_) rethrow_exception(std::exchange(error_, nullptr));
+}
+
+bool CoExecutor::waitFor(double timeout_sec) {
+    unique_lock<mutex> lock(mtx_);
+    bool done = done_cv_.wait_for(lock, chrono::duration<double>(timeout_sec), [this] { return outstanding_ == 0; });
+    if (done && error_) rethrow_exception(std::exchange(error_, nullptr));
+    return done;
+}
@@ -0,0 +1,255 @@
+#include "../headers/coro_pipeline.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include "../headers/preprocess.h"
+#include "../headers/render.h"
+using namespace std;
+
+namespace {
+using Clock = chrono::steady_clock;
+
+// A frame between the detect and output coroutines of one stream.
+struct Detected {
+    FrameEnvelope frame;
+    bool inferred = true;
+    vector<Detection> detections;
+};
+}
+
+struct CoroutinePipeline::Stream {
+    Stream(CoExecutor& executor, size_t capacity, const TrackerConfig& tracker_config)
+        : frames(executor, capacity), detected(executor, capacity), tracker(tracker_config) {}
+
+    int id = 0;
+    string path;
+    CoQueue<FrameEnvelope> frames;
+    CoQueue<Detected> detected;
+    Tracker tracker;
+    unique_ptr<VideoEncoder> encoder;
+    atomic<uint64_t> decoded{0};
+    // Written by the output coroutine, read by reportStats() from the
+    // thread that called run().
+    atomic<uint64_t> done{0};
+    atomic<int64_t> first_ns{0};
+    atomic<int64_t> last_ns{0};
+    Log2Histogram latency_us;
+};
+
+CoroutinePipeline::CoroutinePipeline(const vector<string>& videos, InferEnginePool& engines,
+                                     const PipelineConfig& config, int threads)
+    : engines_(engines),
+      config_(config),
+      executor_(threads),
+      infer_executor_(static_cast<int>(max<size_t>(1, engines.size()))),
+      sessions_(executor_, max<size_t>(1, engines.size())),
+      skip_(config.skip, static_cast<int>(max<size_t>(1, videos.size())), static_cast<int>(engines.size())) {
+    const int count = static_cast<int>(videos.size());
+    for (int i = 0; i < count; i++) {
+        auto s = make_unique<Stream>(executor_, config.queue_capacity, config.tracker);
+        s->id = i;
+        s->path = videos[i];
+        s->tracker.setPool(config.cpu_pool);
+        if (config.output.encode) {
+            VideoWriterConfig video = config.output.video;
+            video.path = streamOutputPath(video.path, i, count);
+            s->encoder = make_unique<VideoEncoder>(video);
+        }
+        streams_.push_back(std::move(s));
+    }
+    if (config.output.results.enabled()) results_ = make_unique<ResultSink>(config.output.results);
+}
+
+CoroutinePipeline::~CoroutinePipeline() = default;
+
+void CoroutinePipeline::stageFailed(const Stream& s, const char* stage, std::exception_ptr error) {
+    failed_stages_++;
+    try {
+        rethrow_exception(error);
+    } catch (const std::exception& e) {
+        cerr << "[Stream " << s.id << "] " << stage << " failed: " << e.what() << endl;
+    } catch (...) {
+        cerr << "[Stream " << s.id << "] " << stage << " failed" << endl;
+    }
+}
+
+// Each stage closes its input and output queues however it ends, so that
+// when one stage of a stream fails its neighbours stop instead of waiting
+// on it forever. A co_await cannot appear in a handler, hence the
+// exception_ptr.
+CoTask CoroutinePipeline::decode(Stream& s, atomic<bool>& running) {
+    std::exception_ptr error;
+    try {
+        cv::VideoCapture cap;
+        if (s.path == "0") cap.open(0);
+        else cap.open(s.path);
+        if (!cap.isOpened()) {
+            cerr << "Error: Could not open video source: " << s.path << endl;
+            s.frames.close();
+            co_return;
+        }
+        const double source_fps = cap.get(cv::CAP_PROP_FPS);
+        const uint64_t stride = static_cast<uint64_t>(std::max(1, config_.decode_stride));
+        uint64_t seq = 0, grabbed = 0;
+        while (running.load()) {
+            cv::Mat image;  // fresh buffer: the previous frame is still downstream
+            if (!cap.grab()) break;
+            if (grabbed++ % stride != 0) continue;
+            if (!cap.retrieve(image) || image.empty()) break;
+            FrameEnvelope envelope(image, s.id, seq++);
+            envelope.timestamp_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+            envelope.source_fps = source_fps;
+            s.decoded++;
+            if (!co_await s.frames.push(std::move(envelope))) break;
+            // Decoding never waits on its own, so give other streams a turn.
+            co_await executor_.schedule();
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (error) stageFailed(s, "decode", error);
+    s.frames.close();
+}
+
+CoTask CoroutinePipeline::detect(Stream& s) {
+    std::exception_ptr error;
+    try {
+        const Preprocessor preprocessor(engines_.getInputWidth(), engines_.getInputHeight(), config_.cpu_pool);
+        FrameEnvelope envelope;
+        while (co_await s.frames.pop(envelope)) {
+            Detected item;
+            item.inferred = skip_.shouldInfer(s.id, envelope.source_fps);
+            if (item.inferred) {
+                auto start = Clock::now();
+                cv::Mat blob = preprocessor.process(envelope);
+                InferEngine* engine = nullptr;
+                auto wait_start = Clock::now();
+                if (!co_await sessions_.pop(engine)) break;
+                infer_wait_us_.record(QueueStats::elapsedMicros(wait_start));
+                cv::Mat predictions;
+                std::exception_ptr infer_error;
+                Clock::duration infer_time{};
+                if (!blob.empty()) {
+                    // Run on an inference thread and come back to the pool, so
+                    // that a long Run() never holds a pool thread.
+                    co_await infer_executor_.schedule();
+                    auto infer_start = Clock::now();
+                    try {
+                        predictions = engine->infer(blob);
+                    } catch (...) {
+                        infer_error = std::current_exception();
+                    }
+                    infer_time = Clock::now() - infer_start;
+                    co_await executor_.schedule();
+                }
+                sessions_.tryPush(engine);  // never full: one slot per session
+                if (infer_error) rethrow_exception(infer_error);
+                auto post_start = Clock::now();
+                if (!predictions.empty()) {
+                    item.detections = postprocess(predictions, envelope.letterbox,
+                                                  config_.conf_threshold, config_.nms_threshold, config_.cpu_pool);
+                }
+                if (config_.skip.enabled()) {
+                    // Only the work itself: waiting for a session or a thread
+                    // is queueing, which a longer stride would not fix.
+                    auto busy = (wait_start - start) + infer_time + (Clock::now() - post_start);
+                    skip_.recordFrame(true, chrono::duration<double, milli>(busy).count());
+                }
+            }
+            item.frame = std::move(envelope);
+            if (!co_await s.detected.push(std::move(item))) break;
+            envelope = FrameEnvelope();
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (error) stageFailed(s, "detect", error);
+    s.frames.close();
+    s.detected.close();
+}
+
+CoTask CoroutinePipeline::output(Stream& s) {
+    std::exception_ptr error;
+    try {
+        Detected item;
+        while (co_await s.detected.pop(item)) {
+            const vector<Track>& tracks = item.inferred ? s.tracker.update(item.detections) : s.tracker.tracks();
+            if (s.encoder) {
+                cv::Mat rendered = renderTracks(item.frame.image, tracks, config_.tracker.min_age_draw,
+                                                config_.cpu_pool);
+                s.encoder->write(rendered, item.frame.timestamp_ms, item.frame.source_fps);
+            }
+            if (results_) {
+                results_->write({s.id, item.frame.seq, item.frame.timestamp_ms, item.inferred,
+                                 std::move(item.detections), tracks});
+            }
+            uint64_t latency_us = static_cast<uint64_t>(item.frame.ageMs() * 1000.0);
+            latency_us_.record(latency_us);
+            s.latency_us.record(latency_us);
+            int64_t now_ns = chrono::duration_cast<chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+            if (s.done.fetch_add(1) == 0) s.first_ns = now_ns;
+            s.last_ns = now_ns;
+        }
+        if (s.encoder) s.encoder->close();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    if (error) stageFailed(s, "output", error);
+    s.detected.close();
+}
+
+int CoroutinePipeline::run(atomic<bool>& running) {
+    for (size_t i = 0; i < engines_.size(); i++) sessions_.tryPush(&engines_.at(i));
+    for (auto& s : streams_) {
+        executor_.spawn(decode(*s, running));
+        executor_.spawn(detect(*s));
+        executor_.spawn(output(*s));
+    }
+    cout << "Coroutine pipeline: " << streams_.size() << " streams on " << executor_.threads()
+         << " threads, " << engines_.size() << " sessions on " << infer_executor_.threads() << " more." << endl;
+    double interval = config_.stats_interval_sec > 0 ? config_.stats_interval_sec : 3600.0;
+    while (!executor_.waitFor(interval)) {
+        if (config_.stats_interval_sec > 0) reportStats(cout);
+    }
+    if (results_) results_->close();
+    reportStats(cout);
+    if (failed_stages_.load() > 0) {
+        cerr << "Coroutine pipeline finished with " << failed_stages_.load() << " failed stage(s)." << endl;
+        return 1;
+    }
+    cout << "Coroutine pipeline finished." << endl;
+    return 0;
+}
+
+void CoroutinePipeline::reportStats(std::ostream& os) const {
+    ios_base::fmtflags flags = os.flags();
+    streamsize precision = os.precision();
+    os << fixed << setprecision(2);
+    uint64_t push_suspends = 0, pop_suspends = 0;
+    for (const auto& s : streams_) {
+        double span = (s->last_ns.load() - s->first_ns.load()) / 1e9;
+        uint64_t done = s->done.load();
+        auto lat = s->latency_us.snapshot();
+        os << "[Stream " << s->id << "] decoded=" << s->decoded.load() << " frames=" << done
+           << " fps=" << (span > 0 ? (done - 1) / span : 0.0)
+           << " latency ms mean=" << lat.mean() / 1000.0
+           << " p99<=" << lat.percentile(0.99) / 1000.0 << endl;
+        if (s->encoder) s->encoder->reportStats(os);
+        push_suspends += s->frames.pushSuspends() + s->detected.pushSuspends();
+        pop_suspends += s->frames.popSuspends() + s->detected.popSuspends();
+    }
+    auto wait = infer_wait_us_.snapshot();
+    auto lat = latency_us_.snapshot();
+    os << "[Coroutines] threads=" << executor_.threads() << "+" << infer_executor_.threads() << " resumes=" << executor_.resumes()
+       << " suspends push=" << push_suspends << " pop=" << pop_suspends
+       << " session wait ms mean=" << wait.mean() / 1000.0 << " p99<=" << wait.percentile(0.99) / 1000.0 << endl;
+    os << "[Coroutines] capture-to-done latency ms mean=" << lat.mean() / 1000.0
+       << " p50<=" << lat.percentile(0.5) / 1000.0
+       << " p99<=" << lat.percentile(0.99) / 1000.0
+       << " max=" << lat.max / 1000.0 << endl;
+    if (config_.skip.enabled()) skip_.reportStats(os);
+    if (config_.cpu_pool) config_.cpu_pool->reportStats(os);
+    if (results_) results_->reportStats(os);
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -0,0 +1,61 @@
+#include "../headers/deadline_source.h"
+#include <iomanip>
+#include <ostream>
+using namespace std;
+
+DeadlineSource::DeadlineSource(FrameSource& inner, int streams, double slo_ms) : inner_(inner) {
+    for (int i = 0; i < streams; i++) {
+        streams_.push_back(make_unique<StreamState>());
+        streams_.back()->slo_ms = slo_ms;
+    }
+}
+
+void DeadlineSource::setStreamSlo(int stream, double slo_ms) {
+    streams_.at(stream)->slo_ms = slo_ms;
+}
+
+bool DeadlineSource::pop(FrameEnvelope& frame) {
+    while (inner_.pop(frame)) {
+        if (frame.source_id < 0 || frame.source_id >= static_cast<int>(streams_.size())) {
+            return true;
+        }
+        StreamState& s = *streams_[frame.source_id];
+        double age_ms = frame.ageMs();
+        s.age_us.record(static_cast<uint64_t>(age_ms * 1000.0));
+        if (s.slo_ms > 0 && age_ms > s.slo_ms) {
+            s.dropped.fetch_add(1, memory_order_relaxed);
+            continue;
+        }
+        s.passed.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+uint64_t DeadlineSource::passed(int stream) const {
+    return streams_.at(stream)->passed.load(memory_order_relaxed);
+}
+
+uint64_t DeadlineSource::dropped(int stream) const {
+    return streams_.at(stream)->dropped.load(memory_order_relaxed);
+}
+
+void DeadlineSource::reportStats(std::ostream& os) const {
+    inner_.reportStats(os);
+    ios_base::fmtflags flags = os.flags();
+    streamsize precision = os.precision();
+    os << fixed << setprecision(1);
+    for (size_t i = 0; i < streams_.size(); i++) {
+        const StreamState& s = *streams_[i];
+        auto age = s.age_us.snapshot();
+        uint64_t passed = s.passed.load(memory_order_relaxed), dropped = s.dropped.load(memory_order_relaxed);
+        os << "[Deadline] stream " << i << " slo=";
+        if (s.slo_ms > 0) os << s.slo_ms << " ms"; else os << "off";
+        os << " passed=" << passed << " dropped=" << dropped;
+        if (passed + dropped > 0) os << " (" << 100.0 * dropped / (passed + dropped) << "%)";
+        os << " dequeue age ms mean=" << age.mean() / 1000.0
+           << " p99<=" << age.percentile(0.99) / 1000.0 << endl;
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -5,6 +5,8 @@
 #include <vector>
 #include <iomanip>
 #include <chrono>
+#include <memory>
+#include <algorithm>
 using namespace std;
 
 // Include all the corrected and verified headers
@@ -12,9 +14,18 @@ using namespace std;
 #include "../headers/preprocess.h"
 #include "../headers/nms.h"
 #include "../headers/frame_queue.h"
+#include "../headers/tracker.h"
+#include "../headers/render.h"
+#include "../headers/pacing.h"
+#include "../headers/frame_skip.h"
+#include "../headers/stages.h"
 
 // The producer function reads frames from a video source and pushes them into a queue.
-void producer(FrameQueue& fq, const string& video_path, atomic<bool>& running) {
+// Only every decode_stride-th frame is decoded; the others, and frames the sink
+// would discard anyway, are grabbed but never retrieved. With a frame-skip
+// controller, frames it skips are not decoded either and go out without pixels.
+void producer(FrameSink& fq, const string& video_path, atomic<bool>& running, const Pacing& pacing,
+              int decode_stride, FrameSkipController* skip, int stream) {
     cv::VideoCapture cap;
     
     // Open video source
@@ -29,223 +40,193 @@ void producer(FrameQueue& fq, const string& video_path, atomic<bool>& running) {
         return;
     }
     
-    cout << "Producer started. Reading from: " << video_path << endl;
+    const double source_fps = cap.get(cv::CAP_PROP_FPS);
+    Pacer pacer(pacing, source_fps);
+    cout << "Producer started. Reading from: " << video_path << ", pacing " << toString(pacing);
+    if (pacer.targetFps() > 0) cout << " (" << pacer.targetFps() << " fps)";
+    cout << endl;
     
     cv::Mat frame;
     int frame_count = 0;
+    uint64_t grabbed = 0, skipped_stride = 0, skipped_full = 0, skipped_infer = 0;
+    decode_stride = std::max(1, decode_stride);
     
-    while (running.load() && cap.read(frame)) {
-        if (frame.empty()) {
+    while (running.load() && cap.grab()) {
+        double timestamp_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+        pacer.wait(timestamp_ms);
+
+        // grab() only demuxes; retrieve() does the decode to BGR and the copy.
+        if (grabbed++ % decode_stride != 0) {
+            skipped_stride++;
+            continue;
+        }
+        if (!fq.accepts()) {
+            skipped_full++;
+            continue;
+        }
+        // Asked only for frames that go downstream, so the stride counts them.
+        const bool infer = !skip || skip->shouldInfer(stream, source_fps);
+        if (infer && (!cap.retrieve(frame) || frame.empty())) {
             cout << "End of video stream reached." << endl;
             break;
         }
         
-        if (!fq.push(frame)) {
+        FrameEnvelope envelope(infer ? frame : cv::Mat(), stream, static_cast<uint64_t>(frame_count));
+        envelope.timestamp_ms = timestamp_ms;
+        envelope.source_fps = source_fps;
+        if (skip) envelope.inference = infer ? FrameEnvelope::Inference::Run : FrameEnvelope::Inference::Skip;
+        if (!infer) skipped_infer++;
+        if (!fq.push(envelope)) {
             cout << "Queue closed, producer stopping." << endl;
             break;
         }
         
         frame_count++;
         if (frame_count % 100 == 0) {
-            cout << "Producer: Processed " << frame_count << " frames" << endl;
+            cout << "Producer: Processed " << frame_count << " frames, " << pacer.achievedFps() << " fps" << endl;
         }
-        
-        this_thread::sleep_for(chrono::milliseconds(1));
     }
     
     cap.release();
-    cout << "Producer finished. Total frames processed: " << frame_count << endl;
+    fq.close();
+    cout << "Producer finished. Total frames processed: " << frame_count
+         << ", achieved " << pacer.achievedFps() << " fps";
+    if (pacer.targetFps() > 0) {
+        cout << " against a target of " << pacer.targetFps() << " fps, " << pacer.lateFrames() << " frames late";
+    }
+    cout << endl;
+    if (skipped_stride + skipped_full + skipped_infer > 0) {
+        cout << "Producer: " << grabbed << " frames grabbed, not decoded: " << skipped_stride
+             << " by --decode-stride, " << skipped_full << " with the queue full, "
+             << skipped_infer << " skipped by --max-stride" << endl;
+    }
 }
 
 // The consumer function takes frames from the queue and performs the full inference pipeline.
-namespace {
-struct Track {
-    int id;
-    cv::Rect2f box;
-    float conf;
-    int cls;
-    int age;
-    int lost;
-    cv::Rect2f smooth;
-};
-
-float iouRect(const cv::Rect2f& a, const cv::Rect2f& b) {
-    float x1 = max(a.x, b.x);
-    float y1 = max(a.y, b.y);
-    float x2 = min(a.x + a.width, b.x + b.width);
-    float y2 = min(a.y + a.height, b.y + b.height);
-    if (x2 <= x1 || y2 <= y1) return 0.0f;
-    float inter = (x2 - x1) * (y2 - y1);
-    float uni = a.width * a.height + b.width * b.height - inter;
-    return uni > 0 ? inter / uni : 0.0f;
-}
-}
-
-void consumer(FrameQueue& fq, InferEngine& engine, atomic<bool>& running,
-              float conf_threshold, float nms_threshold)
+void consumer(FrameSource& source, InferEngine& engine, atomic<bool>& running,
+              float conf_threshold, float nms_threshold, double stats_interval_sec,
+              const OutputOptions& output, FrameSkipController& skip,
+              const TrackerConfig& tracker_config, WorkStealingPool* cpu_pool)
 {
     cout << "Consumer started. Confidence threshold: " << conf_threshold 
          << ", NMS threshold: " << nms_threshold << endl;
     
-    Preprocessor preprocessor(engine.getInputWidth(), engine.getInputHeight());
-    cv::Mat frame;
+    const Preprocessor preprocessor(engine.getInputWidth(), engine.getInputHeight(), cpu_pool);
+    FrameEnvelope envelope;
     int processed_count = 0;
+    Log2Histogram latency_us;
     
-    vector<string> class_names = {
-        "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat",
-        "traffic light", "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat",
-        "dog", "horse", "sheep", "cow", "elephant", "bear", "zebra", "giraffe", "backpack",
-        "umbrella", "handbag", "tie", "suitcase", "frisbee", "skis", "snowboard", "sports ball",
-        "kite", "baseball bat", "baseball glove", "skateboard", "surfboard", "tennis racket",
-        "bottle", "wine glass", "cup", "fork", "knife", "spoon", "bowl", "banana", "apple",
-        "sandwich", "orange", "broccoli", "carrot", "hot dog", "pizza", "donut", "cake",
-        "chair", "couch", "potted plant", "bed", "dining table", "toilet", "tv", "laptop",
-        "mouse", "remote", "keyboard", "cell phone", "microwave", "oven", "toaster", "sink",
-        "refrigerator", "book", "clock", "vase", "scissors", "teddy bear", "hair drier", "toothbrush"
-    };
-
-    vector<int> allowed = {2, 3, 5, 7};
-    vector<Track> tracks;
-    int next_id = 1;
-    const float alpha = 0.7f;
-    const float match_iou = 0.4f;
-    const float enter_conf = 0.5f;
-    const float keep_conf = 0.3f;
-    const int min_age_draw = 2;
-    const int grace_lost = 3;
-    cv::VideoWriter writer;
-    bool writer_opened = false;
+    Tracker tracker(tracker_config);
+    tracker.setPool(cpu_pool);
+    const int min_age_draw = tracker.config().min_age_draw;
+    std::unique_ptr<AsyncVideoWriter> writer;
+    if (output.encode) writer = std::make_unique<AsyncVideoWriter>(output.video);
+    std::unique_ptr<ResultSink> results;
+    if (output.results.enabled()) results = std::make_unique<ResultSink>(output.results);
+    auto last_stats_print = chrono::steady_clock::now();
     
     while (running.load()) {
-        if (!fq.pop(frame)) {
-            if (fq.isClosed()) {
+        if (!source.pop(envelope)) {
+            if (source.isClosed()) {
                 cout << "Queue closed, consumer stopping." << endl;
                 break;
             }
             continue;
         }
         
-        if (frame.empty()) {
-            continue;
-        }
-        
-        cv::Mat blob = preprocessor.process(frame);
-        if (blob.empty()) {
-            continue;
-        }
-        
-        cv::Mat predictions = engine.infer(blob);
-        if (predictions.empty()) {
+        const cv::Mat& frame = envelope.image;
+        // A frame the producer skipped arrives without pixels, and only when
+        // nothing is drawn.
+        if (frame.empty() && envelope.inference != FrameEnvelope::Inference::Skip) {
             continue;
         }
         
-        vector<Detection> detections = postprocess(
-            predictions, 
-            frame.size(), 
-            conf_threshold, 
-            nms_threshold
-        );
-
-        vector<Detection> filtered;
-        for (auto& d : detections) {
-            if (find(allowed.begin(), allowed.end(), d.cls) != allowed.end()) {
-                filtered.push_back(d);
-            }
-        }
-
-        vector<int> det_assigned(filtered.size(), -1);
-        vector<int> track_assigned(tracks.size(), -1);
-
-        for (size_t ti = 0; ti < tracks.size(); ++ti) {
-            float best_iou = 0.0f; int best_j = -1;
-            for (size_t j = 0; j < filtered.size(); ++j) {
-                if (det_assigned[j] != -1) continue;
-                float conf_gate = (tracks[ti].age > 0) ? keep_conf : enter_conf;
-                if (filtered[j].conf < conf_gate) continue;
-                if (filtered[j].cls != tracks[ti].cls) continue;
-                float iou = iouRect(tracks[ti].box, filtered[j].box);
-                if (iou > best_iou) { best_iou = iou; best_j = (int)j; }
+        auto frame_start = chrono::steady_clock::now();
+        const bool infer = skip.shouldInfer(envelope);
+        vector<Detection> detections;
+        if (infer) {
+            cv::Mat blob = preprocessor.process(envelope);
+            if (blob.empty()) {
+                continue;
             }
-            if (best_j != -1 && best_iou >= match_iou) {
-                det_assigned[best_j] = (int)ti;
-                track_assigned[ti] = best_j;
+            // Headless: the pixels are not needed past preprocessing.
+            if (!output.draw()) envelope.releaseImage();
+            
+            cv::Mat predictions = engine.infer(blob);
+            if (predictions.empty()) {
+                continue;
             }
+            
+            detections = postprocess(
+                predictions, 
+                envelope.letterbox, 
+                conf_threshold, 
+                nms_threshold,
+                cpu_pool
+            );
         }
 
-        for (size_t j = 0; j < filtered.size(); ++j) {
-            if (det_assigned[j] != -1) continue;
-            if (filtered[j].conf < enter_conf) continue;
-            Track t;
-            t.id = next_id++;
-            t.box = filtered[j].box;
-            t.smooth = filtered[j].box;
-            t.conf = filtered[j].conf;
-            t.cls = filtered[j].cls;
-            t.age = 0; t.lost = 0;
-            tracks.push_back(t);
+        // Skipped frames keep the tracks of the last inferred frame.
+        const vector<Track>& tracks = infer ? tracker.update(detections) : tracker.tracks();
+        if (results) {
+            results->write({envelope.source_id, envelope.seq, envelope.timestamp_ms, infer, detections, tracks});
         }
-
-        for (size_t ti = 0; ti < tracks.size(); ++ti) {
-            int dj = track_assigned[ti];
-            if (dj != -1) {
-                auto& det = filtered[dj];
-                cv::Rect2f b = tracks[ti].smooth;
-                b.x = alpha * det.box.x + (1 - alpha) * b.x;
-                b.y = alpha * det.box.y + (1 - alpha) * b.y;
-                b.width = alpha * det.box.width + (1 - alpha) * b.width;
-                b.height = alpha * det.box.height + (1 - alpha) * b.height;
-                tracks[ti].box = det.box;
-                tracks[ti].smooth = b;
-                tracks[ti].conf = det.conf;
-                tracks[ti].cls = det.cls;
-                tracks[ti].age++;
-                tracks[ti].lost = 0;
-            } else {
-                tracks[ti].lost++;
-            }
-        }
-
-        tracks.erase(remove_if(tracks.begin(), tracks.end(), [&](const Track& t){ return t.lost > grace_lost; }), tracks.end());
         
-        cv::Mat display_frame = frame.clone();
-        for (const auto& t : tracks) {
-            if (t.age < min_age_draw) continue;
-            cv::Rect rect((int)t.smooth.x, (int)t.smooth.y, (int)t.smooth.width, (int)t.smooth.height);
-            cv::rectangle(display_frame, rect, cv::Scalar(0, 255, 0), 2);
-            string clsname = (t.cls >= 0 && t.cls < (int)class_names.size()) ? class_names[t.cls] : ("class_" + to_string(t.cls));
-            string label = clsname + " " + to_string(t.conf).substr(0, 4) + " id=" + to_string(t.id);
-            int baseline = 0;
-            cv::Size ts = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &baseline);
-            cv::Point org(rect.x, max(0, rect.y - 5));
-            if (org.y < ts.height) org.y = rect.y + ts.height + 5;
-            cv::rectangle(display_frame, cv::Point(org.x, org.y - ts.height - 5), cv::Point(org.x + ts.width, org.y + baseline), cv::Scalar(0, 255, 0), -1);
-            cv::putText(display_frame, label, org, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1);
-        }
+        // Headless runs stop here: no copy, no drawing, no waitKey.
+        if (output.draw()) {
+            cv::Mat display_frame = renderTracks(frame, tracks, min_age_draw, cpu_pool);
 
-        if (!writer_opened) {
-            int fourcc = cv::VideoWriter::fourcc('M','J','P','G');
-            double fps = 30.0;
-            writer.open("output.mp4", fourcc, fps, display_frame.size());
-            writer_opened = writer.isOpened();
+            if (writer) writer->write(display_frame, envelope.timestamp_ms, envelope.source_fps);
+            
+            if (output.display) {
+                cv::imshow("YOLOv8 Object Detection", display_frame);
+                
+                char key = cv::waitKey(1) & 0xFF;
+                if (key == 27) {
+                    cout << "ESC pressed, stopping..." << endl;
+                    running = false;
+                    break;
+                }
+            }
         }
-        if (writer_opened) writer.write(display_frame);
-        
-        cv::imshow("YOLOv8 Object Detection", display_frame);
         
-        char key = cv::waitKey(1) & 0xFF;
-        if (key == 27) {
-            cout << "ESC pressed, stopping..." << endl;
-            running = false;
-            break;
+        if (skip.enabled()) {
+            skip.recordFrame(infer, chrono::duration<double, milli>(chrono::steady_clock::now() - frame_start).count());
         }
-        
+        latency_us.record(static_cast<uint64_t>(envelope.ageMs() * 1000.0));
         processed_count++;
         if (processed_count % 50 == 0) {
-            cout << "Consumer: Processed " << processed_count << " frames" << endl;
+            cout << "Consumer: Processed " << processed_count << " frames, "
+                 << detections.size() << " detections, " << tracks.size() << " tracks" << endl;
+        }
+
+        if (stats_interval_sec > 0) {
+            auto now = chrono::steady_clock::now();
+            if (chrono::duration<double>(now - last_stats_print).count() >= stats_interval_sec) {
+                auto lat = latency_us.snapshot();
+                source.reportStats(cout);
+                cout << "Consumer: capture-to-done latency ms mean=" << lat.mean() / 1000.0
+                     << " p50<=" << lat.percentile(0.5) / 1000.0
+                     << " p99<=" << lat.percentile(0.99) / 1000.0
+                     << " max=" << lat.max / 1000.0 << endl;
+                if (skip.enabled()) skip.reportStats(cout);
+                last_stats_print = now;
+            }
         }
     }
     
-    cv::destroyAllWindows();
-    if (writer_opened) writer.release();
+    if (output.display) cv::destroyAllWindows();
+    if (writer) {
+        writer->close();
+        writer->reportStats(cout);
+    }
+    if (results) {
+        results->close();
+        results->reportStats(cout);
+    }
+    source.close();
     cout << "Consumer finished. Total frames processed: " << processed_count << endl;
+    if (skip.enabled()) skip.reportStats(cout);
+    if (cpu_pool) cpu_pool->reportStats(cout);
+    source.reportStats(cout);
 }
@@ -0,0 +1,20 @@
+#include "../headers/frame_envelope.h"
+#include <algorithm>
+using namespace std;
+
+cv::Rect2f LetterboxTransform::toSource(const cv::Rect2f& model_box) const {
+    float inv = scale > 0.0f ? 1.0f / scale : 1.0f;
+    float x1 = (model_box.x - padding.x) * inv;
+    float y1 = (model_box.y - padding.y) * inv;
+    float x2 = (model_box.x + model_box.width - padding.x) * inv;
+    float y2 = (model_box.y + model_box.height - padding.y) * inv;
+
+    float max_x = static_cast<float>(source_size.width);
+    float max_y = static_cast<float>(source_size.height);
+    x1 = std::max(0.0f, std::min(x1, max_x));
+    y1 = std::max(0.0f, std::min(y1, max_y));
+    x2 = std::max(0.0f, std::min(x2, max_x));
+    y2 = std::max(0.0f, std::min(y2, max_y));
+
+    return cv::Rect2f(x1, y1, x2 - x1, y2 - y1);
+}
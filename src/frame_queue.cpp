@@ -1,46 +1,121 @@
 #include "../headers/frame_queue.h"
 using namespace std;
 
-FrameQueue::FrameQueue(size_t max_size)
-    : max_size(max_size), closed(false) {}
+FrameQueue::FrameQueue(size_t max_size, WaitStrategy strategy)
+    : max_size(max_size), closed(false), strategy_(strategy), stats_(max_size) {}
 
 FrameQueue::~FrameQueue() {
     close();
 }
 
 bool FrameQueue::push(const cv::Mat& frame) {
+    return push(FrameEnvelope(frame, 0, 0));
+}
+
+bool FrameQueue::push(const FrameEnvelope& frame) {
     std::unique_lock<std::mutex> lock(mtx);
     
     if (closed || max_size == 0) {
+        stats_.recordDrop();
         return false;
     }
     
-    cv_push.wait(lock, [this] { return q.size() < max_size || closed; });
+    bool blocked = q.size() >= max_size;
+    uint64_t wait_us = 0;
+    if (blocked) {
+        auto wait_start = QueueStats::Clock::now();
+        waitForSpace(lock);
+        wait_us = QueueStats::elapsedMicros(wait_start);
+    }
     
     if (closed) {
+        stats_.recordDrop();
         return false;
     }
     
-    q.push(frame.clone());
-    cv_pop.notify_one();
+    stats_.recordPush(q.size(), blocked, wait_us);
+    // Capture reuses its frame buffer, so the pixels are copied unless the
+    // envelope already owns them through a buffer (e.g. a shared-memory slot).
+    FrameEnvelope copy = frame;
+    if (!frame.buffer) copy.image = frame.image.clone();
+    q.push(std::move(copy));
+    size_.store(q.size(), std::memory_order_release);
+    lock.unlock();
+    notifyFrame();
     return true;
 }
 
 bool FrameQueue::pop(cv::Mat& frame) {
+    FrameEnvelope envelope;
+    if (!pop(envelope)) {
+        return false;
+    }
+    frame = envelope.image;
+    return true;
+}
+
+bool FrameQueue::pop(FrameEnvelope& frame) {
     std::unique_lock<std::mutex> lock(mtx);
     
-    cv_pop.wait(lock, [this] { return !q.empty() || closed; });
+    bool blocked = q.empty() && !closed;
+    uint64_t wait_us = 0;
+    if (blocked) {
+        auto wait_start = QueueStats::Clock::now();
+        waitForFrame(lock);
+        wait_us = QueueStats::elapsedMicros(wait_start);
+    }
     
     if (q.empty() && closed) {
         return false;
     }
     
-    frame = q.front();
+    frame = std::move(q.front());
     q.pop();
-    cv_push.notify_one();
+    size_.store(q.size(), std::memory_order_release);
+    stats_.recordPop(blocked, wait_us);
+    lock.unlock();
+    notifySpace();
     return true;
 }
 
+void FrameQueue::waitForSpace(std::unique_lock<std::mutex>& lock) {
+    if (strategy_ == WaitStrategy::ConditionVariable) {
+        cv_push.wait(lock, [this] { return q.size() < max_size || closed; });
+        return;
+    }
+    while (q.size() >= max_size && !closed) {
+        lock.unlock();
+        space_waiter_.wait([this] {
+            return size_.load(std::memory_order_acquire) < max_size || closed.load(std::memory_order_acquire);
+        });
+        lock.lock();
+    }
+}
+
+void FrameQueue::waitForFrame(std::unique_lock<std::mutex>& lock) {
+    if (strategy_ == WaitStrategy::ConditionVariable) {
+        cv_pop.wait(lock, [this] { return !q.empty() || closed; });
+        return;
+    }
+    while (q.empty() && !closed) {
+        lock.unlock();
+        frame_waiter_.wait([this] {
+            return size_.load(std::memory_order_acquire) > 0 || closed.load(std::memory_order_acquire);
+        });
+        lock.lock();
+    }
+}
+
+void FrameQueue::notifySpace() {
+    if (strategy_ == WaitStrategy::ConditionVariable) cv_push.notify_one();
+    else space_waiter_.notifyOne();
+}
+
+void FrameQueue::notifyFrame() {
+    if (strategy_ == WaitStrategy::ConditionVariable) cv_pop.notify_one();
+    else frame_waiter_.notifyOne();
+}
+
 bool FrameQueue::empty() const {
     std::lock_guard<std::mutex> lock(mtx);
     return q.empty();
@@ -52,13 +127,28 @@ size_t FrameQueue::size() const {
 }
 
 void FrameQueue::close() {
-    std::lock_guard<std::mutex> lock(mtx);
-    closed = true;
-    cv_push.notify_all();
-    cv_pop.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        closed = true;
+        cv_push.notify_all();
+        cv_pop.notify_all();
+    }
+    space_waiter_.notifyAll();
+    frame_waiter_.notifyAll();
 }
 
 bool FrameQueue::isClosed() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return closed;
+    return closed.load(std::memory_order_acquire);
+}
+
+QueueStatsSnapshot FrameQueue::stats() const {
+    return stats_.snapshot(size_.load(std::memory_order_relaxed));
+}
+
+void FrameQueue::resetStats() {
+    stats_.reset();
+}
+
+void FrameQueue::reportStats(std::ostream& os) const {
+    os << stats() << std::endl;
 }
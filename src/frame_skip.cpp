@@ -0,0 +1,126 @@
+#include "../headers/frame_skip.h"
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+using namespace std;
+
+namespace {
+// Weight of the newest sample in the cost averages.
+constexpr double kCostAlpha = 0.1;
+
+void updateAverage(double& average, double sample) {
+    average = average <= 0.0 ? sample : average + kCostAlpha * (sample - average);
+}
+}
+
+FrameSkipController::FrameSkipController(const FrameSkipConfig& config, int streams, int parallelism)
+    : config_(config),
+      parallelism_(max(1, parallelism)),
+      since_inferred_(max(1, streams), max(1, config.max_stride)),
+      stream_fps_(max(1, streams), 0.0),
+      last_update_(QueueStats::Clock::now()) {
+    config_.max_stride = max(1, config_.max_stride);
+}
+
+double FrameSkipController::capacityFps(int k, double infer_ms, double skip_ms, int parallelism) {
+    double ms_per_frame = (infer_ms + (k - 1) * skip_ms) / k;
+    return ms_per_frame > 0.0 ? parallelism * 1000.0 / ms_per_frame : 0.0;
+}
+
+int FrameSkipController::chooseStride(double demand_fps, double infer_ms, double skip_ms, int parallelism,
+                                      int current, int max_stride, double hysteresis) {
+    if (infer_ms <= 0.0 || demand_fps <= 0.0) return current;
+    int needed = max_stride;
+    for (int k = 1; k <= max_stride; k++) {
+        if (capacityFps(k, infer_ms, skip_ms, parallelism) >= demand_fps) {
+            needed = k;
+            break;
+        }
+    }
+    if (needed > current) return needed;
+    if (needed < current &&
+        capacityFps(current - 1, infer_ms, skip_ms, parallelism) * (1.0 - hysteresis) >= demand_fps) {
+        return current - 1;
+    }
+    return current;
+}
+
+bool FrameSkipController::shouldInfer(int stream, double source_fps) {
+    lock_guard<mutex> lock(mtx_);
+    if (stream < 0 || stream >= static_cast<int>(since_inferred_.size())) stream = 0;
+    if (source_fps > 0.0) stream_fps_[stream] = source_fps;
+    if (++since_inferred_[stream] >= stride_) {
+        since_inferred_[stream] = 0;
+        inferred_++;
+        return true;
+    }
+    skipped_++;
+    return false;
+}
+
+bool FrameSkipController::shouldInfer(const FrameEnvelope& frame) {
+    switch (frame.inference) {
+    case FrameEnvelope::Inference::Run: return true;
+    case FrameEnvelope::Inference::Skip: return false;
+    default: return shouldInfer(frame.source_id, frame.source_fps);
+    }
+}
+
+void FrameSkipController::recordFrame(bool inferred, double service_ms) {
+    lock_guard<mutex> lock(mtx_);
+    updateAverage(inferred ? infer_ms_ : skip_ms_, service_ms);
+
+    auto now = QueueStats::Clock::now();
+    if (chrono::duration<double>(now - last_update_).count() < config_.update_interval_sec) return;
+    last_update_ = now;
+    int next = chooseStride(demandLocked(), infer_ms_, skip_ms_, parallelism_,
+                            stride_, config_.max_stride, config_.hysteresis);
+    if (next != stride_) {
+        stride_ = next;
+        stride_changes_++;
+    }
+}
+
+double FrameSkipController::demandLocked() const {
+    double demand = 0.0;
+    for (double fps : stream_fps_) {
+        if (config_.target_fps > 0.0) demand += config_.target_fps;
+        else demand += fps > 0.0 ? fps : kDefaultFps;
+    }
+    return demand;
+}
+
+int FrameSkipController::stride() const {
+    lock_guard<mutex> lock(mtx_);
+    return stride_;
+}
+
+double FrameSkipController::demandFps() const {
+    lock_guard<mutex> lock(mtx_);
+    return demandLocked();
+}
+
+uint64_t FrameSkipController::inferred() const {
+    lock_guard<mutex> lock(mtx_);
+    return inferred_;
+}
+
+uint64_t FrameSkipController::skipped() const {
+    lock_guard<mutex> lock(mtx_);
+    return skipped_;
+}
+
+void FrameSkipController::reportStats(std::ostream& os) const {
+    lock_guard<mutex> lock(mtx_);
+    ios_base::fmtflags flags = os.flags();
+    streamsize precision = os.precision();
+    os << fixed << setprecision(1)
+       << "[FrameSkip] stride=" << stride_ << "/" << config_.max_stride
+       << " demand=" << demandLocked() << " fps"
+       << " capacity=" << capacityFps(stride_, infer_ms_, skip_ms_, parallelism_) << " fps"
+       << " inferred=" << inferred_ << " skipped=" << skipped_
+       << " cost ms infer=" << infer_ms_ << " skip=" << skip_ms_
+       << " changes=" << stride_changes_ << endl;
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -0,0 +1,185 @@
+#include "../headers/image_batch.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include "../headers/bounded_queue.h"
+#include "../headers/frame_envelope.h"
+#include "../headers/nms.h"
+#include "../headers/preprocess.h"
+#include "../headers/queue_stats.h"
+using namespace std;
+
+std::vector<std::string> listImages(const std::string& dir_or_list) {
+    vector<string> images;
+    namespace fs = std::filesystem;
+    error_code ec;
+    if (fs::is_directory(dir_or_list, ec)) {
+        static const vector<string> extensions = {".jpg", ".jpeg", ".png", ".bmp", ".webp", ".tif", ".tiff"};
+        for (const auto& entry : fs::directory_iterator(dir_or_list, ec)) {
+            if (!entry.is_regular_file()) continue;
+            string ext = entry.path().extension().string();
+            transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+            if (find(extensions.begin(), extensions.end(), ext) != extensions.end()) {
+                images.push_back(entry.path().string());
+            }
+        }
+        sort(images.begin(), images.end());
+        return images;
+    }
+
+    ifstream in(dir_or_list);
+    string line;
+    while (getline(in, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty() && line[0] != '#') images.push_back(line);
+    }
+    return images;
+}
+
+namespace {
+struct ImageResult {
+    uint64_t index = 0;
+    vector<Detection> detections;
+};
+
+// Per-stage timings, recorded from any worker.
+struct ImageBatchStats {
+    Log2Histogram decode_us;      // per image
+    Log2Histogram preprocess_us;  // per batch
+    Log2Histogram infer_us;       // per batch
+    Log2Histogram postprocess_us; // per batch
+    Log2Histogram batch_size;
+    atomic<uint64_t> decode_failed{0};
+    atomic<uint64_t> preprocess_failed{0};
+    atomic<uint64_t> infer_failed{0};
+};
+
+void reportImageStats(ostream& os, const ImageBatchStats& stats, const BoundedQueue<FrameEnvelope>& decoded,
+                      uint64_t done, size_t total, double elapsed) {
+    auto ms = [](const Log2Histogram& h) { return h.snapshot().mean() / 1000.0; };
+    double batch = stats.batch_size.snapshot().mean();
+    os << "Images: " << done << "/" << total << " in " << elapsed << " s, "
+       << (elapsed > 0 ? done / elapsed : 0.0) << " images/s" << endl;
+    os << "  decode " << ms(stats.decode_us) << " ms/image"
+       << ", preprocess " << ms(stats.preprocess_us) << " ms/batch"
+       << ", infer " << ms(stats.infer_us) << " ms/batch"
+       << ", postprocess " << ms(stats.postprocess_us) << " ms/batch"
+       << ", mean batch " << batch << endl;
+    os << "  failed: decode " << stats.decode_failed.load() << ", preprocess " << stats.preprocess_failed.load()
+       << ", inference " << stats.infer_failed.load() << endl;
+    os << "  decoded queue: " << decoded.stats() << endl;
+}
+}
+
+bool processImages(const std::vector<std::string>& images, InferEnginePool& engines,
+                   const ImageBatchConfig& config, std::atomic<bool>& running) {
+    ofstream out(config.results_path);
+    if (!out) {
+        cerr << "Error: could not write " << config.results_path << endl;
+        return false;
+    }
+    out << "image,class,conf,x,y,w,h\n";
+
+    const int decoders = config.decode_threads > 0 ? config.decode_threads : max(1u, thread::hardware_concurrency());
+    const int workers = max(1, config.infer_workers);
+    const size_t batch_size = static_cast<size_t>(max(1, config.batch_size));
+    cout << "Images: " << images.size() << " on " << decoders << " decode threads, " << workers
+         << " inference workers, batch " << batch_size
+         << (engines.size() > 0 && engines.at(0).supportsBatch() ? "" : " (model has a fixed batch of 1)") << endl;
+
+    BoundedQueue<FrameEnvelope> decoded(max(config.queue_capacity, batch_size));
+    BoundedQueue<ImageResult> results(max(config.queue_capacity, batch_size));
+    ImageBatchStats stats;
+    atomic<size_t> next_image{0};
+    atomic<int> active_decoders{decoders}, active_workers{workers};
+    const Preprocessor preprocessor(engines.getInputWidth(), engines.getInputHeight());
+    auto start_time = chrono::steady_clock::now();
+
+    auto decoder = [&] {
+        for (size_t i = next_image++; i < images.size() && running.load(); i = next_image++) {
+            auto start = QueueStats::Clock::now();
+            cv::Mat image = cv::imread(images[i]);
+            stats.decode_us.record(QueueStats::elapsedMicros(start));
+            if (image.empty()) {
+                stats.decode_failed++;
+                continue;
+            }
+            if (!decoded.push(FrameEnvelope(image, 0, i))) break;
+        }
+        if (--active_decoders == 0) decoded.close();
+    };
+
+    auto worker = [&] {
+        vector<FrameEnvelope> batch;
+        vector<bool> prepared;
+        while (decoded.popUpTo(batch, batch_size) > 0) {
+            auto start = QueueStats::Clock::now();
+            cv::Mat blob = preprocessor.processBatch(batch, prepared);
+            stats.preprocess_us.record(QueueStats::elapsedMicros(start));
+
+            start = QueueStats::Clock::now();
+            vector<cv::Mat> predictions;
+            {
+                auto session = engines.acquire();
+                predictions = session->inferBatch(blob, static_cast<int>(batch.size()));
+            }
+            stats.infer_us.record(QueueStats::elapsedMicros(start));
+            stats.batch_size.record(batch.size());
+
+            start = QueueStats::Clock::now();
+            for (size_t b = 0; b < batch.size(); b++) {
+                ImageResult r;
+                r.index = batch[b].seq;
+                if (!prepared[b]) {
+                    stats.preprocess_failed++;
+                } else if (b < predictions.size() && !predictions[b].empty()) {
+                    r.detections = postprocess(predictions[b], batch[b].letterbox,
+                                               config.conf_threshold, config.nms_threshold);
+                } else {
+                    stats.infer_failed++;
+                }
+                results.push(std::move(r));
+            }
+            stats.postprocess_us.record(QueueStats::elapsedMicros(start));
+            batch.clear();
+        }
+        if (--active_workers == 0) results.close();
+    };
+
+    vector<thread> threads;
+    for (int i = 0; i < decoders; i++) threads.emplace_back(decoder);
+    for (int i = 0; i < workers; i++) threads.emplace_back(worker);
+
+    // Stream results in completion order from this thread.
+    uint64_t done = 0;
+    auto last_stats_print = chrono::steady_clock::now();
+    ImageResult r;
+    while (results.pop(r)) {
+        const string& path = images[r.index];
+        for (const auto& d : r.detections) {
+            out << path << ',' << d.cls << ',' << d.conf << ','
+                << d.box.x << ',' << d.box.y << ',' << d.box.width << ',' << d.box.height << '\n';
+        }
+        done++;
+        if (config.stats_interval_sec > 0) {
+            auto now = chrono::steady_clock::now();
+            if (chrono::duration<double>(now - last_stats_print).count() >= config.stats_interval_sec) {
+                reportImageStats(cout, stats, decoded, done, images.size(),
+                                 chrono::duration<double>(now - start_time).count());
+                last_stats_print = now;
+            }
+        }
+    }
+    for (auto& t : threads) t.join();
+    out.flush();
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+    reportImageStats(cout, stats, decoded, done, images.size(), elapsed);
+    cout << "Images: results written to " << config.results_path << endl;
+    return done > 0 && static_cast<bool>(out);
+}
@@ -41,6 +41,13 @@ bool InferEngine::loadModel(const std::string& model_path) {
         if (input_dims.size() == 4) {
             input_height_ = static_cast<int>(input_dims[2]);
             input_width_ = static_cast<int>(input_dims[3]);
+            dynamic_batch_ = input_dims[0] <= 0;
+        }
+
+        auto output_dims = session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        if (output_dims.size() == 3 && output_dims[1] > 0 && output_dims[2] > 0) {
+            output_rows_ = static_cast<int>(output_dims[1]);
+            output_cols_ = static_cast<int>(output_dims[2]);
         }
 
         model_path_ = model_path;
@@ -64,6 +71,12 @@ cv::Mat InferEngine::infer(const cv::Mat& input_blob) {
         return cv::Mat();
     }
 
+    // Known output shape: ONNX Runtime writes into the result directly.
+    if (hasFixedOutput()) {
+        cv::Mat result(output_rows_, output_cols_, CV_32F);
+        return inferInto(input_blob.ptr<float>(), 1, result.ptr<float>()) ? result : cv::Mat();
+    }
+
     try {
         Ort::AllocatorWithDefaultOptions allocator;
         auto input_name = session_->GetInputNameAllocated(0, allocator);
@@ -107,3 +120,138 @@ cv::Mat InferEngine::infer(const cv::Mat& input_blob) {
         return cv::Mat();
     }
 }
+
+std::vector<cv::Mat> InferEngine::inferBatch(const cv::Mat& batch_blob, int batch) {
+    std::vector<cv::Mat> results;
+    if (!session_ || batch_blob.empty() || batch <= 0) {
+        return results;
+    }
+
+    size_t per_image = static_cast<size_t>(3) * input_height_ * input_width_;
+    if (batch_blob.total() != per_image * batch) {
+        std::cerr << "Batch blob holds " << batch_blob.total() << " values, expected " << per_image * batch << std::endl;
+        return results;
+    }
+
+    if (hasFixedOutput()) {
+        // One allocation for the whole batch; each result is a view of its rows.
+        cv::Mat all(output_rows_ * batch, output_cols_, CV_32F);
+        if (!inferInto(batch_blob.ptr<float>(), batch, all.ptr<float>())) {
+            return results;
+        }
+        for (int b = 0; b < batch; b++) {
+            results.push_back(all.rowRange(b * output_rows_, (b + 1) * output_rows_));
+        }
+        return results;
+    }
+
+    if (!dynamic_batch_ || batch == 1) {
+        for (int b = 0; b < batch; b++) {
+            cv::Mat single(static_cast<int>(per_image), 1, CV_32F,
+                           const_cast<float*>(batch_blob.ptr<float>()) + per_image * b);
+            results.push_back(infer(single));
+        }
+        return results;
+    }
+
+    try {
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto input_name = session_->GetInputNameAllocated(0, allocator);
+        auto output_name = session_->GetOutputNameAllocated(0, allocator);
+
+        std::vector<int64_t> input_shape = {batch, 3, input_height_, input_width_};
+        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        auto input_tensor = Ort::Value::CreateTensor<float>(
+            memory_info,
+            const_cast<float*>(batch_blob.ptr<float>()),
+            per_image * batch,
+            input_shape.data(),
+            input_shape.size()
+        );
+
+        const char* input_names[] = {input_name.get()};
+        const char* output_names[] = {output_name.get()};
+
+        auto output_tensors = session_->Run(
+            Ort::RunOptions{nullptr},
+            input_names,
+            &input_tensor,
+            1,
+            output_names,
+            1
+        );
+
+        auto& output_tensor = output_tensors[0];
+        float* output_data = output_tensor.GetTensorMutableData<float>();
+        auto output_shape = output_tensor.GetTensorTypeAndShapeInfo().GetShape();
+        if (output_shape.size() != 3 || output_shape[0] != batch) {
+            std::cerr << "Unexpected batch output shape" << std::endl;
+            return results;
+        }
+
+        int rows = static_cast<int>(output_shape[1]);
+        int cols = static_cast<int>(output_shape[2]);
+        for (int b = 0; b < batch; b++) {
+            cv::Mat result(rows, cols, CV_32F, output_data + static_cast<size_t>(b) * rows * cols);
+            results.push_back(result.clone());
+        }
+        return results;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Inference error: " << e.what() << std::endl;
+        return std::vector<cv::Mat>();
+    }
+}
+
+bool InferEngine::inferInto(const float* blob, int batch, float* predictions) {
+    if (!session_ || !blob || !predictions || batch <= 0 || !hasFixedOutput()) {
+        return false;
+    }
+
+    const size_t per_image = static_cast<size_t>(3) * input_height_ * input_width_;
+    const size_t per_result = static_cast<size_t>(output_rows_) * output_cols_;
+    // Without a dynamic batch dimension the images go through one by one.
+    const int step = dynamic_batch_ ? batch : 1;
+
+    try {
+        Ort::AllocatorWithDefaultOptions allocator;
+        auto input_name = session_->GetInputNameAllocated(0, allocator);
+        auto output_name = session_->GetOutputNameAllocated(0, allocator);
+        const char* input_names[] = {input_name.get()};
+        const char* output_names[] = {output_name.get()};
+        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+
+        for (int b = 0; b < batch; b += step) {
+            std::vector<int64_t> input_shape = {step, 3, input_height_, input_width_};
+            std::vector<int64_t> output_shape = {step, output_rows_, output_cols_};
+            auto input_tensor = Ort::Value::CreateTensor<float>(
+                memory_info,
+                const_cast<float*>(blob) + per_image * b,
+                per_image * step,
+                input_shape.data(),
+                input_shape.size()
+            );
+            auto output_tensor = Ort::Value::CreateTensor<float>(
+                memory_info,
+                predictions + per_result * b,
+                per_result * step,
+                output_shape.data(),
+                output_shape.size()
+            );
+            session_->Run(
+                Ort::RunOptions{nullptr},
+                input_names,
+                &input_tensor,
+                1,
+                output_names,
+                &output_tensor,
+                1
+            );
+        }
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Inference error: " << e.what() << std::endl;
+        return false;
+    }
+}
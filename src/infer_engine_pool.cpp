@@ -0,0 +1,42 @@
+#include "infer_engine_pool.h"
+#include <algorithm>
+#include <iostream>
+using namespace std;
+
+bool InferEnginePool::load(const std::string& model_path, size_t sessions) {
+    // Built aside and swapped in only once every session loaded, so a
+    // failed load never leaves free_ pointing at engines that are gone.
+    vector<unique_ptr<InferEngine>> engines;
+    vector<size_t> free;
+    for (size_t i = 0; i < max<size_t>(sessions, 1); i++) {
+        auto engine = make_unique<InferEngine>();
+        if (!engine->loadModel(model_path)) {
+            return false;
+        }
+        engines.push_back(std::move(engine));
+        free.push_back(i);
+    }
+    lock_guard<mutex> lock(mtx_);
+    engines_ = std::move(engines);
+    free_ = std::move(free);
+    if (engines_.size() > 1) {
+        cout << "Loaded " << engines_.size() << " inference sessions" << endl;
+    }
+    return true;
+}
+
+InferEnginePool::Lease InferEnginePool::acquire() {
+    unique_lock<mutex> lock(mtx_);
+    available_.wait(lock, [this] { return !free_.empty(); });
+    size_t slot = free_.back();
+    free_.pop_back();
+    return Lease(*this, slot);
+}
+
+void InferEnginePool::release(size_t slot) {
+    {
+        lock_guard<mutex> lock(mtx_);
+        free_.push_back(slot);
+    }
+    available_.notify_one();
+}
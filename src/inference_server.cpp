@@ -0,0 +1,285 @@
+#include "../headers/inference_server.h"
+#include "../headers/preprocess.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+using namespace std;
+
+struct InferenceServer::Connection {
+    struct Mapping {
+        void* base = nullptr;
+        size_t size = 0;
+    };
+
+    explicit Connection(int socket) : fd(socket) {}
+    ~Connection() {
+        for (auto& [name, m] : mappings) munmap(m.base, m.size);
+        for (auto& m : retired) munmap(m.base, m.size);
+        ::close(fd);
+    }
+
+    // Maps a client's shared-memory object read-only on first use, and again
+    // if it has grown past the cached mapping. Returns null unless the object
+    // holds at least `end` bytes.
+    const Mapping* mapShared(const string& name, size_t end) {
+        auto it = mappings.find(name);
+        if (it != mappings.end() && it->second.size >= end) return &it->second;
+        int shm = shm_open(name.c_str(), O_RDONLY, 0);
+        if (shm < 0) return nullptr;
+        struct stat st;
+        Mapping m;
+        if (fstat(shm, &st) == 0 && static_cast<size_t>(st.st_size) >= end && st.st_size > 0) {
+            m.size = static_cast<size_t>(st.st_size);
+            m.base = mmap(nullptr, m.size, PROT_READ, MAP_SHARED, shm, 0);
+        }
+        ::close(shm);
+        if (m.base == nullptr || m.base == MAP_FAILED) return nullptr;
+        if (it != mappings.end()) {
+            // Queued requests may still read the old view.
+            retired.push_back(it->second);
+            it->second = m;
+            return &it->second;
+        }
+        return &mappings.emplace(name, m).first->second;
+    }
+
+    int fd;
+    mutex write_mtx;                 // replies come from any batch worker
+    map<string, Mapping> mappings;   // only touched by the reader thread
+    vector<Mapping> retired;         // replaced by a larger mapping
+};
+
+InferenceServer::InferenceServer(InferEnginePool& engines, const InferenceServerConfig& config)
+    : engines_(engines), config_(config), pending_(max<size_t>(config.queue_capacity, 1)) {
+    config_.max_batch = max(1, config_.max_batch);
+}
+
+InferenceServer::~InferenceServer() {
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(config_.socket_path.c_str());
+    }
+}
+
+bool InferenceServer::start() {
+    sockaddr_un addr{};
+    if (config_.socket_path.size() >= sizeof(addr.sun_path)) {
+        cerr << "InferenceServer: socket path too long: " << config_.socket_path << endl;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, config_.socket_path.c_str(), config_.socket_path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        cerr << "InferenceServer: socket: " << strerror(errno) << endl;
+        return false;
+    }
+    // A socket file left by a server that died would make bind fail.
+    ::unlink(config_.socket_path.c_str());
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 64) != 0) {
+        cerr << "InferenceServer: cannot listen on " << config_.socket_path << ": " << strerror(errno) << endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void InferenceServer::reply(Connection& conn, uint32_t id, DetectStatus status, const vector<Detection>* detections) {
+    DetectResponse response;
+    response.id = id;
+    response.status = status;
+    vector<DetectBox> boxes;
+    if (detections) {
+        boxes.reserve(detections->size());
+        for (const auto& d : *detections) {
+            boxes.push_back({d.box.x, d.box.y, d.box.width, d.box.height, d.conf, d.cls});
+        }
+    }
+    response.count = static_cast<uint32_t>(boxes.size());
+    if (status != DetectStatus::Ok) failed_++;
+
+    lock_guard<mutex> lock(conn.write_mtx);
+    // A failed write means the client is gone; its reader will notice.
+    if (writeFull(conn.fd, &response, sizeof(response)) && !boxes.empty()) {
+        writeFull(conn.fd, boxes.data(), boxes.size() * sizeof(DetectBox));
+    }
+}
+
+void InferenceServer::readLoop(shared_ptr<Connection> conn, shared_ptr<atomic<bool>> done) {
+    DetectRequest header;
+    vector<uchar> padding;
+    while (readFull(conn->fd, &header, sizeof(header))) {
+        const int w = header.width, h = header.height;
+        const size_t row_bytes = static_cast<size_t>(w) * 3;
+        if (header.magic != kDetectRequestMagic || w <= 0 || h <= 0 || w > kDetectMaxSide ||
+            h > kDetectMaxSide || header.stride < static_cast<int32_t>(row_bytes)) {
+            // Out of sync with the stream; nothing after this can be trusted.
+            reply(*conn, header.id, DetectStatus::BadRequest, nullptr);
+            break;
+        }
+        const size_t stride = static_cast<size_t>(header.stride);
+
+        Request request;
+        request.conn = conn;
+        request.id = header.id;
+        if (header.payload != DetectPayload::Inline && header.payload != DetectPayload::SharedMemory) {
+            // Unknown kind: how many bytes follow the header is unknown too.
+            reply(*conn, header.id, DetectStatus::BadRequest, nullptr);
+            break;
+        }
+        if (header.payload == DetectPayload::Inline && stride - row_bytes > kDetectMaxRowPadding) {
+            // Would have us buffer up to 2 GB of padding per row.
+            reply(*conn, header.id, DetectStatus::BadRequest, nullptr);
+            break;
+        }
+        if (header.payload == DetectPayload::SharedMemory) {
+            header.shm_name[sizeof(header.shm_name) - 1] = '\0';
+            size_t needed = (h - 1) * stride + row_bytes;
+            const Connection::Mapping* m = header.shm_offset > SIZE_MAX - needed
+                                               ? nullptr
+                                               : conn->mapShared(header.shm_name, header.shm_offset + needed);
+            if (!m || header.shm_offset > m->size || m->size - header.shm_offset < needed) {
+                reply(*conn, header.id, DetectStatus::SharedMemoryError, nullptr);
+                continue;
+            }
+            // Read-only mapping: the pipeline only ever reads the source image.
+            request.image = cv::Mat(h, w, CV_8UC3, static_cast<uchar*>(m->base) + header.shm_offset, stride);
+        } else {
+            request.image.create(h, w, CV_8UC3);
+            padding.resize(stride - row_bytes);
+            bool ok = true;
+            for (int y = 0; y < h && ok; y++) {
+                ok = readFull(conn->fd, request.image.ptr(y), row_bytes) &&
+                     (padding.empty() || readFull(conn->fd, padding.data(), padding.size()));
+            }
+            if (!ok) break;
+        }
+        request.arrived = QueueStats::Clock::now();
+        requests_++;
+        if (!pending_.push(std::move(request))) break;
+    }
+    done->store(true);
+}
+
+void InferenceServer::reapReaders() {
+    lock_guard<mutex> lock(readers_mtx_);
+    for (auto it = readers_.begin(); it != readers_.end();) {
+        if (it->done->load()) {
+            it->thread.join();
+            it = readers_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+size_t InferenceServer::readerThreads() const {
+    lock_guard<mutex> lock(readers_mtx_);
+    return readers_.size();
+}
+
+void InferenceServer::batchWorker(InferEngine& engine) {
+    const Preprocessor preprocessor(engine.getInputWidth(), engine.getInputHeight());
+    const auto max_delay = chrono::microseconds(static_cast<int64_t>(config_.max_delay_ms * 1000.0));
+    vector<Request> batch;
+    vector<FrameEnvelope> frames;
+    vector<bool> prepared;
+    while (pending_.popBatch(batch, static_cast<size_t>(config_.max_batch), max_delay) > 0) {
+        auto start = QueueStats::Clock::now();
+        for (size_t b = 0; b < batch.size(); b++) frames.emplace_back(batch[b].image, 0, b);
+        cv::Mat blob = preprocessor.processBatch(frames, prepared);
+        vector<cv::Mat> predictions = engine.inferBatch(blob, static_cast<int>(frames.size()));
+        for (size_t b = 0; b < batch.size(); b++) {
+            Request& r = batch[b];
+            if (prepared[b] && b < predictions.size() && !predictions[b].empty()) {
+                vector<Detection> detections = postprocess(predictions[b], frames[b].letterbox,
+                                                           config_.conf_threshold, config_.nms_threshold);
+                reply(*r.conn, r.id, DetectStatus::Ok, &detections);
+            } else {
+                reply(*r.conn, r.id, DetectStatus::InferenceFailed, nullptr);
+            }
+            service_us_.record(QueueStats::elapsedMicros(r.arrived));
+        }
+        infer_us_.record(QueueStats::elapsedMicros(start));
+        batch_size_.record(batch.size());
+        // Drops the views into shared memory, so clients may reuse their slots.
+        frames.clear();
+        batch.clear();
+    }
+}
+
+void InferenceServer::run(atomic<bool>& running) {
+    vector<thread> workers;
+    for (size_t i = 0; i < engines_.size(); i++) {
+        workers.emplace_back(&InferenceServer::batchWorker, this, ref(engines_.at(i)));
+    }
+    cout << "InferenceServer: listening on " << config_.socket_path << ", " << engines_.size()
+         << " sessions, batch up to " << config_.max_batch << " within " << config_.max_delay_ms << " ms"
+         << (engines_.size() > 0 && engines_.at(0).supportsBatch() ? "" : " (model has a fixed batch of 1)") << endl;
+
+    auto last_stats_print = chrono::steady_clock::now();
+    while (running.load()) {
+        pollfd pfd{listen_fd_, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) > 0) {
+            int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                auto conn = make_shared<Connection>(fd);
+                auto done = make_shared<atomic<bool>>(false);
+                connections_++;
+                lock_guard<mutex> lock(readers_mtx_);
+                readers_.push_back({conn, done, thread(&InferenceServer::readLoop, this, conn, done)});
+            }
+        }
+        reapReaders();
+        if (config_.stats_interval_sec > 0) {
+            auto now = chrono::steady_clock::now();
+            if (chrono::duration<double>(now - last_stats_print).count() >= config_.stats_interval_sec) {
+                reportStats(cout);
+                last_stats_print = now;
+            }
+        }
+    }
+
+    // Wake readers blocked in read(); replies still in flight fail quietly.
+    {
+        lock_guard<mutex> lock(readers_mtx_);
+        for (auto& reader : readers_) {
+            if (auto conn = reader.conn.lock()) ::shutdown(conn->fd, SHUT_RDWR);
+        }
+    }
+    for (auto& reader : readers_) reader.thread.join();
+    readers_.clear();
+    pending_.close();
+    for (auto& t : workers) t.join();
+    reportStats(cout);
+}
+
+void InferenceServer::reportStats(std::ostream& os) const {
+    auto batch = batch_size_.snapshot();
+    auto infer = infer_us_.snapshot();
+    auto service = service_us_.snapshot();
+    auto wait = pending_.waitStats();
+    os << "[InferenceServer] connections=" << connections_.load() << " requests=" << requests_.load()
+       << " failed=" << failed_.load() << " batches=" << batch.count
+       << " mean batch=" << batch.mean() << " queued=" << pending_.size() << endl;
+    os << "[InferenceServer] batch wait ms mean=" << wait.mean() / 1000.0
+       << " p99<=" << wait.percentile(0.99) / 1000.0
+       << ", batch ms mean=" << infer.mean() / 1000.0
+       << " p99<=" << infer.percentile(0.99) / 1000.0
+       << ", request ms mean=" << service.mean() / 1000.0
+       << " p50<=" << service.percentile(0.5) / 1000.0
+       << " p99<=" << service.percentile(0.99) / 1000.0 << endl;
+}
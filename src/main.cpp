@@ -3,11 +3,25 @@
 #include <thread>
 #include <atomic>
 #include <csignal>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <vector>
 #ifdef _WIN32
 #include <windows.h>
 #endif
 #include "infer_engine.h"
 #include "frame_queue.h"
+#include "multi_lane_queue.h"
+#include "pipeline.h"
+#include "coro_pipeline.h"
+#include "pacing.h"
+#include "offline.h"
+#include "image_batch.h"
+#include "deadline_source.h"
+#include "work_stealing_pool.h"
+#include "shm_ingest.h"
+#include "stages.h"
 using namespace std;
 
 std::atomic<bool> running(true);
@@ -33,10 +47,19 @@ static BOOL WINAPI ConsoleCtrlHandler(DWORD ctrl_type) {
 }
 #endif
 
-extern void producer(FrameQueue& fq, const std::string& video_path, std::atomic<bool>& running);
-
-extern void consumer(FrameQueue& fq, InferEngine& engine, std::atomic<bool>& running,
-                    float conf_threshold, float nms_threshold);
+// One source per non-empty line; lines starting with '#' are ignored.
+static bool readVideoList(const string& path, vector<string>& videos) {
+    ifstream in(path);
+    if (!in) return false;
+    string line;
+    while (getline(in, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (line.empty() || line[0] == '#') continue;
+        videos.push_back(line);
+    }
+    return true;
+}
 
 void printUsage(const char* prog) {
     cout << "Usage: " << prog << " --model <path> [options]\n\n"
@@ -45,9 +68,77 @@ void printUsage(const char* prog) {
               << "  --model <path>     Path to the ONNX model file.\n\n"
               << "Optional Arguments:\n"
               << "  --video <path>     Path to video file or '0' for webcam. (Default: 0)\n"
+              << "                     Repeat to process several streams in one process.\n"
+              << "                     shm:<name> takes frames written to shared memory by another\n"
+              << "                     process through headers/yolo_ingest.h, without copying them.\n"
+              << "  --video-list <file> Read stream sources from a file, one per line ('#' comments).\n"
+              << "  --pace <mode>      max: decode as fast as downstream accepts; realtime: play files\n"
+              << "                     at their own frame rate; fixed=N: N fps. (Default: max)\n"
+              << "  --headless         No window; only detections and tracks are produced. Nothing is\n"
+              << "                     drawn or encoded unless --output is given.\n"
+              << "  --output <path>    Write the annotated video here. (Default: output.mp4, or none\n"
+              << "                     with --headless)\n"
+              << "  --no-output        Do not write the annotated video.\n"
+              << "  --codec <fourcc>   Video codec; the container follows the --output extension.\n"
+              << "                     (Default: MJPG)\n"
+              << "  --output-fps <fps> Frame rate of the video. (Default: the source's)\n"
+              << "  --encode-policy <drop|block> When the encoder falls behind, drop frames or hold\n"
+              << "                     back the pipeline. (Default: drop)\n"
+              << "  --results <path>   Write detections and tracks of every frame to this file.\n"
+              << "  --results-format <jsonl|bin> JSON Lines or compact binary records. (Default: jsonl)\n"
+              << "  --results-rotate-mb <n> Start a new results file every n MB, 0 for never. (Default: 0)\n"
+              << "  --results-rotate-sec <sec> Start a new results file every N seconds, 0 for never.\n"
+              << "                     (Default: 0)\n"
               << "  --conf <float>     Confidence threshold for detections. (Default: 0.25)\n"
               << "  --nms <float>      NMS IoU threshold for filtering boxes. (Default: 0.45)\n"
               << "  --queue-size <int> Max number of frames to buffer. (Default: 24)\n"
+              << "  --lane-policy <block|drop-oldest|drop-newest> With several streams, what a full\n"
+              << "                     per-stream queue does with a new frame. Under drop-newest the\n"
+              << "                     frame is not even decoded. (Default: block)\n"
+              << "  --decode-stride <int> Decode only every Nth frame; the rest are demuxed and\n"
+              << "                     skipped without decoding. (Default: 1)\n"
+              << "  --stats-interval <sec> Print queue telemetry every N seconds, 0 to disable. (Default: 5)\n"
+              << "  --queue-wait <cv|spin> How blocked queue operations wait: condition variable, or\n"
+              << "                     adaptive spin-then-futex. (Default: cv)\n"
+              << "  --track-match <optimal|greedy> Pair tracks with detections so that the summed IoU\n"
+              << "                     is highest, or let each track take its best free detection in\n"
+              << "                     turn (faster, order-dependent). (Default: optimal)\n"
+              << "  --track-low-conf <float> Match tracks left over after the confident detections\n"
+              << "                     against weaker ones down to this score, to hold them through\n"
+              << "                     occlusion; needs --conf at or below it. (Default: 0, off)\n"
+              << "  --pipeline <serial|staged|coro> Run every step on one consumer thread, as separate\n"
+              << "                     stages connected by bounded queues, or as coroutines per stream\n"
+              << "                     on a shared thread pool (no window). (Default: serial)\n"
+              << "  --cpu-threads <int> Work-stealing pool for preprocessing, decoding predictions,\n"
+              << "                     tracking and drawing; 0 runs them on the calling thread.\n"
+              << "                     (Default: hardware threads)\n"
+              << "  --pool-threads <int> Thread pool size for --pipeline coro. (Default: hardware threads)\n"
+              << "  --stage-threads <spec> Worker threads per stage for --pipeline staged, e.g.\n"
+              << "                     pre=2,infer=1,post=1,render=2. (Default: 1 each)\n"
+              << "  --stage-queue <int> Capacity of the queues between stages. (Default: 4)\n"
+              << "  --infer-workers <int> Parallel inference workers; implies --pipeline staged when > 1.\n"
+              << "                     Same as --stage-threads infer=N. (Default: 1)\n"
+              << "  --sessions <int>   Inference sessions to load, shared by the workers.\n"
+              << "                     (Default: one per inference worker)\n"
+              << "  --reorder-window <int> Max frames inference may run ahead of tracking; bounds the\n"
+              << "                     latency one slow frame can add. (Default: 16)\n"
+              << "  --offline          Process a video file as fast as possible: split it into segments,\n"
+              << "                     run them in parallel and write an ordered detection stream.\n"
+              << "  --offline-workers <int> Segment workers for --offline. (Default: hardware threads)\n"
+              << "  --segments <int>   Segments for --offline. (Default: 4 per worker)\n"
+              << "  --detections <path> CSV written by --offline and --images. (Default: detections.csv)\n"
+              << "  --images <dir|list> Run on still images from a directory or a file listing one path\n"
+              << "                     per line, with parallel decoding and batched inference.\n"
+              << "  --batch <int>      Images per inference call for --images. (Default: 8)\n"
+              << "  --decode-threads <int> Image decode threads for --images. (Default: hardware threads)\n"
+              << "  --max-stride <k> Let inference fall back to every k-th frame when it cannot keep up;\n"
+              << "                     frames in between reuse the last tracks. 1 disables. (Default: 1)\n"
+              << "  --target-fps <fps> Per-stream rate --max-stride tries to keep up with. (Default: the\n"
+              << "                     source's frame rate)\n"
+              << "  --latency-slo <ms> Drop frames that waited longer than this since capture before\n"
+              << "                     they are preprocessed, 0 to disable. Not with --pipeline coro.\n"
+              << "                     (Default: 0)\n"
+              << "  --stream-slo <i>=<ms> Latency SLO for stream i only; repeatable.\n"
               << "  --help             Show this help message.\n";
 }
 
@@ -60,17 +151,154 @@ int main(int argc, char** argv) {
     signal(SIGTERM, signalHandler);
 #endif
 
-    string model_path, video_path = "0";
+    string model_path;
+    vector<string> videos;
     float conf_threshold = 0.25f, nms_threshold = 0.45f;
     size_t queue_size = 24;
+    DropPolicy lane_policy = DropPolicy::Block;
+    double stats_interval_sec = 5.0;
+    WaitStrategy wait_strategy = WaitStrategy::ConditionVariable;
+    bool staged = false, coro = false;
+    int pool_threads = 0;
+    int cpu_threads = -1;
+    PipelineConfig pipeline_config;
+    size_t sessions = 0;
+    Pacing pacing;
+    bool headless = false, output_given = false, no_output = false;
+    bool offline = false;
+    OfflineConfig offline_config;
+    string images_source;
+    ImageBatchConfig image_config;
+    double latency_slo_ms = 0.0;
+    vector<pair<int, double>> stream_slos;
 
     for (int i = 1; i < argc; i++) {
         string arg = argv[i];
         if (arg == "--model" && i + 1 < argc) model_path = argv[++i];
-        else if (arg == "--video" && i + 1 < argc) video_path = argv[++i];
+        else if (arg == "--video" && i + 1 < argc) videos.push_back(argv[++i]);
+        else if (arg == "--video-list" && i + 1 < argc) {
+            string list = argv[++i];
+            if (!readVideoList(list, videos)) { cerr << "Error: could not read --video-list: " << list << endl; return 1; }
+        }
+        else if (arg == "--pace" && i + 1 < argc) {
+            try {
+                pacing = parsePacing(argv[++i]);
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --pace: " << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--headless") headless = true;
+        else if (arg == "--output" && i + 1 < argc) { pipeline_config.output.video.path = argv[++i]; output_given = true; }
+        else if (arg == "--no-output") no_output = true;
+        else if (arg == "--codec" && i + 1 < argc) {
+            pipeline_config.output.video.codec = argv[++i];
+            try {
+                parseFourcc(pipeline_config.output.video.codec);
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --codec: " << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--output-fps" && i + 1 < argc) pipeline_config.output.video.fps = std::stod(argv[++i]);
+        else if (arg == "--encode-policy" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "drop") pipeline_config.output.video.drop_when_behind = true;
+            else if (mode == "block") pipeline_config.output.video.drop_when_behind = false;
+            else { cerr << "Error: unknown --encode-policy: " << mode << endl; return 1; }
+        }
+        else if (arg == "--results" && i + 1 < argc) pipeline_config.output.results.path = argv[++i];
+        else if (arg == "--results-format" && i + 1 < argc) {
+            try {
+                pipeline_config.output.results.format = parseResultFormat(argv[++i]);
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --results-format: " << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--results-rotate-mb" && i + 1 < argc) {
+            pipeline_config.output.results.rotate_bytes = static_cast<uint64_t>(std::stod(argv[++i]) * 1024 * 1024);
+        }
+        else if (arg == "--results-rotate-sec" && i + 1 < argc) pipeline_config.output.results.rotate_sec = std::stod(argv[++i]);
         else if (arg == "--conf" && i + 1 < argc) conf_threshold = std::stof(argv[++i]);
         else if (arg == "--nms" && i + 1 < argc) nms_threshold = std::stof(argv[++i]);
         else if (arg == "--queue-size" && i + 1 < argc) queue_size = std::stoul(argv[++i]);
+        else if (arg == "--stats-interval" && i + 1 < argc) stats_interval_sec = std::stod(argv[++i]);
+        else if (arg == "--lane-policy" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "block") lane_policy = DropPolicy::Block;
+            else if (mode == "drop-oldest") lane_policy = DropPolicy::DropOldest;
+            else if (mode == "drop-newest") lane_policy = DropPolicy::DropNewest;
+            else { cerr << "Error: unknown --lane-policy: " << mode << endl; return 1; }
+        }
+        else if (arg == "--decode-stride" && i + 1 < argc) {
+            pipeline_config.decode_stride = std::max(1, std::stoi(argv[++i]));
+        }
+        else if (arg == "--queue-wait" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "cv") wait_strategy = WaitStrategy::ConditionVariable;
+            else if (mode == "spin") wait_strategy = WaitStrategy::SpinThenPark;
+            else { cerr << "Error: unknown --queue-wait mode: " << mode << endl; return 1; }
+        }
+        else if (arg == "--pipeline" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "serial") staged = coro = false;
+            else if (mode == "staged") { staged = true; coro = false; }
+            else if (mode == "coro") coro = true;
+            else { cerr << "Error: unknown --pipeline mode: " << mode << endl; return 1; }
+        }
+        else if (arg == "--track-match" && i + 1 < argc) {
+            try {
+                pipeline_config.tracker.match = offline_config.tracker.match = parseTrackMatch(argv[++i]);
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --track-match: " << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--track-low-conf" && i + 1 < argc) {
+            pipeline_config.tracker.low_conf = offline_config.tracker.low_conf = std::stof(argv[++i]);
+        }
+        else if (arg == "--stage-threads" && i + 1 < argc) {
+            try {
+                parseStageThreads(argv[++i], pipeline_config.threads);
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --stage-threads: " << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--stage-queue" && i + 1 < argc) pipeline_config.queue_capacity = std::stoul(argv[++i]);
+        else if (arg == "--infer-workers" && i + 1 < argc) {
+            pipeline_config.threads.inference = std::max(1, std::stoi(argv[++i]));
+            if (pipeline_config.threads.inference > 1) staged = true;
+        }
+        else if (arg == "--cpu-threads" && i + 1 < argc) cpu_threads = std::stoi(argv[++i]);
+        else if (arg == "--pool-threads" && i + 1 < argc) pool_threads = std::stoi(argv[++i]);
+        else if (arg == "--sessions" && i + 1 < argc) sessions = std::stoul(argv[++i]);
+        else if (arg == "--reorder-window" && i + 1 < argc) pipeline_config.reorder_window = std::stoul(argv[++i]);
+        else if (arg == "--offline") offline = true;
+        else if (arg == "--offline-workers" && i + 1 < argc) offline_config.workers = std::stoi(argv[++i]);
+        else if (arg == "--segments" && i + 1 < argc) offline_config.segments = std::stoi(argv[++i]);
+        else if (arg == "--detections" && i + 1 < argc) {
+            offline_config.detections_path = argv[++i];
+            image_config.results_path = offline_config.detections_path;
+        }
+        else if (arg == "--images" && i + 1 < argc) images_source = argv[++i];
+        else if (arg == "--batch" && i + 1 < argc) image_config.batch_size = std::stoi(argv[++i]);
+        else if (arg == "--decode-threads" && i + 1 < argc) image_config.decode_threads = std::stoi(argv[++i]);
+        else if (arg == "--target-fps" && i + 1 < argc) pipeline_config.skip.target_fps = std::stod(argv[++i]);
+        else if (arg == "--max-stride" && i + 1 < argc) pipeline_config.skip.max_stride = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--latency-slo" && i + 1 < argc) latency_slo_ms = std::stod(argv[++i]);
+        else if (arg == "--stream-slo" && i + 1 < argc) {
+            string spec = argv[++i];
+            size_t eq = spec.find('=');
+            try {
+                if (eq == string::npos) throw std::invalid_argument("expected <stream>=<ms>");
+                stream_slos.emplace_back(std::stoi(spec.substr(0, eq)), std::stod(spec.substr(eq + 1)));
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --stream-slo: " << spec << " (" << e.what() << ")" << endl;
+                return 1;
+            }
+        }
         else if (arg == "--help") { printUsage(argv[0]); return 0; }
     }
 
@@ -79,31 +307,205 @@ int main(int argc, char** argv) {
         printUsage(argv[0]);
         return 1;
     }
+    if (pipeline_config.tracker.low_conf > 0.0f && pipeline_config.tracker.low_conf < conf_threshold) {
+        cout << "[INFO] --track-low-conf " << pipeline_config.tracker.low_conf << " is below --conf " << conf_threshold
+             << "; the second tracking pass only sees detections from " << conf_threshold << " up." << endl;
+    }
+
+    OutputOptions& output = pipeline_config.output;
+    output.display = !headless;
+    output.encode = !no_output && (output_given || !headless);
+
+    if (!images_source.empty()) {
+        vector<string> images = listImages(images_source);
+        if (images.empty()) {
+            cerr << "Error: no images found in " << images_source << endl;
+            return 1;
+        }
+        image_config.infer_workers = pipeline_config.threads.inference;
+        image_config.conf_threshold = conf_threshold;
+        image_config.nms_threshold = nms_threshold;
+        image_config.stats_interval_sec = stats_interval_sec;
+        InferEnginePool engines;
+        if (!engines.load(model_path, sessions > 0 ? sessions : static_cast<size_t>(image_config.infer_workers))) {
+            cerr << "Failed to load model: " << model_path << endl;
+            return 1;
+        }
+        return processImages(images, engines, image_config, running) ? 0 : 1;
+    }
+
+    if (videos.empty()) videos.push_back("0");
+    auto ingested = [](const string& video) { return video.rfind("shm:", 0) == 0; };
+    const bool any_ingested = std::any_of(videos.begin(), videos.end(), ingested);
+
+    if (offline) {
+        if (videos.size() != 1 || videos[0] == "0" || any_ingested) {
+            cerr << "Error: --offline needs exactly one video file." << endl;
+            return 1;
+        }
+        if (offline_config.workers <= 0) offline_config.workers = std::max(1u, std::thread::hardware_concurrency());
+        InferEnginePool engines;
+        if (!engines.load(model_path, sessions > 0 ? sessions : static_cast<size_t>(offline_config.workers))) {
+            cerr << "Failed to load model: " << model_path << endl;
+            return 1;
+        }
+        offline_config.conf_threshold = conf_threshold;
+        offline_config.nms_threshold = nms_threshold;
+        return processOffline(videos[0], engines, offline_config, running) ? 0 : 1;
+    }
+    // Shared by every stage of whichever pipeline runs below.
+    std::unique_ptr<WorkStealingPool> cpu_pool;
+    if (cpu_threads != 0) cpu_pool = std::make_unique<WorkStealingPool>(cpu_threads);
+    pipeline_config.cpu_pool = cpu_pool.get();
+
+    if (coro) {
+        if (any_ingested) {
+            cerr << "Error: --pipeline coro cannot read shm: sources; use serial or staged." << endl;
+            return 1;
+        }
+        // The coroutine decode stage neither paces nor checks deadlines;
+        // refuse rather than run without what was asked for.
+        if (latency_slo_ms > 0 || !stream_slos.empty()) {
+            cerr << "Error: --pipeline coro does not support --latency-slo or --stream-slo; use serial or staged." << endl;
+            return 1;
+        }
+        if (pacing.mode != PacingMode::Max) {
+            cerr << "Error: --pipeline coro always decodes at --pace max; use serial or staged for "
+                 << toString(pacing) << "." << endl;
+            return 1;
+        }
+        InferEnginePool engines;
+        if (!engines.load(model_path, sessions > 0 ? sessions : static_cast<size_t>(pipeline_config.threads.inference))) {
+            cerr << "Failed to load model: " << model_path << endl;
+            return 1;
+        }
+        if (output.display) {
+            cout << "[INFO] --pipeline coro has no display window." << endl;
+            output.display = false;
+        }
+        pipeline_config.conf_threshold = conf_threshold;
+        pipeline_config.nms_threshold = nms_threshold;
+        pipeline_config.stats_interval_sec = stats_interval_sec;
+        pipeline_config.streams = static_cast<int>(videos.size());
+        CoroutinePipeline pipeline(videos, engines, pipeline_config, pool_threads);
+        return pipeline.run(running);
+    }
+    if (videos.size() > 1 && !staged) {
+        cout << "[INFO] " << videos.size() << " streams: using the staged pipeline." << endl;
+        staged = true;
+    }
 
-    InferEngine engine;
-    if (!engine.loadModel(model_path)) {
+    if (sessions == 0) {
+        sessions = staged ? static_cast<size_t>(pipeline_config.threads.inference) : 1;
+    }
+    InferEnginePool engines;
+    if (!engines.load(model_path, sessions)) {
         cerr << "Failed to load model: " << model_path << endl;
         return 1;
     }
 
-    FrameQueue frame_queue(queue_size);
+    // One stream uses a plain FrameQueue; several get a lane each in a
+    // MultiLaneQueue so that a fast camera cannot starve a slow one.
+    std::unique_ptr<FrameQueue> frame_queue;
+    std::unique_ptr<MultiLaneQueue> lanes;
+    std::vector<std::unique_ptr<FrameSink>> sinks;
+    FrameSource* source = nullptr;
+    if (videos.size() == 1) {
+        frame_queue = std::make_unique<FrameQueue>(queue_size, wait_strategy);
+        source = frame_queue.get();
+    } else {
+        lanes = std::make_unique<MultiLaneQueue>();
+        for (size_t s = 0; s < videos.size(); s++) {
+            int lane = lanes->addLane({queue_size, lane_policy, 1});
+            sinks.push_back(std::make_unique<LaneSink>(*lanes, lane));
+        }
+        source = lanes.get();
+    }
+
+    // Stale frames are discarded where they leave the queue, before any
+    // preprocessing is spent on them.
+    std::unique_ptr<DeadlineSource> deadline;
+    if (latency_slo_ms > 0 || !stream_slos.empty()) {
+        deadline = std::make_unique<DeadlineSource>(*source, static_cast<int>(videos.size()), latency_slo_ms);
+        for (const auto& [stream, slo_ms] : stream_slos) {
+            if (stream < 0 || stream >= static_cast<int>(videos.size())) {
+                cerr << "Error: --stream-slo names stream " << stream << " but there are "
+                     << videos.size() << endl;
+                return 1;
+            }
+            deadline->setStreamSlo(stream, slo_ms);
+        }
+        source = deadline.get();
+    }
     
     cout << "Starting YOLOv8 Object Detection Pipeline..." << endl;
     cout << "Model: " << model_path << endl;
-    cout << "Video: " << video_path << endl;
+    for (size_t s = 0; s < videos.size(); s++) {
+        cout << "Video" << (videos.size() > 1 ? " [" + to_string(s) + "]" : string()) << ": " << videos[s] << endl;
+    }
     cout << "Confidence threshold: " << conf_threshold << endl;
     cout << "NMS threshold: " << nms_threshold << endl;
     cout << "Queue size: " << queue_size << endl;
-    cout << "Press ESC to stop..." << endl;
+    if (deadline) {
+        cout << "Latency SLO: ";
+        if (latency_slo_ms > 0) cout << latency_slo_ms << " ms"; else cout << "off";
+        for (const auto& [stream, slo_ms] : stream_slos) cout << ", stream " << stream << ": " << slo_ms << " ms";
+        cout << endl;
+    }
+    if (pipeline_config.skip.enabled()) {
+        cout << "Frame skip: stride up to " << pipeline_config.skip.max_stride << ", target ";
+        if (pipeline_config.skip.target_fps > 0) cout << pipeline_config.skip.target_fps << " fps"; else cout << "source fps";
+        cout << endl;
+    }
+    cout << "Pipeline: " << (staged ? "staged" : "serial") << endl;
+    cout << "Display: " << (output.display ? "on" : "off")
+         << ", video output: " << (output.encode ? output.video.path : "off")
+         << ", results: " << (output.results.enabled() ? output.results.path : "off") << endl;
+    cout << (output.display ? "Press ESC to stop..." : "Press Ctrl+C to stop...") << endl;
+
+    // Built before the producers start, since they may share its frame-skip
+    // controller.
+    std::unique_ptr<StagedPipeline> pipeline;
+    std::unique_ptr<FrameSkipController> serial_skip;
+    if (staged) {
+        pipeline_config.conf_threshold = conf_threshold;
+        pipeline_config.nms_threshold = nms_threshold;
+        pipeline_config.stats_interval_sec = stats_interval_sec;
+        pipeline_config.streams = static_cast<int>(videos.size());
+        pipeline = std::make_unique<StagedPipeline>(*source, engines, pipeline_config);
+    } else {
+        serial_skip = std::make_unique<FrameSkipController>(pipeline_config.skip, static_cast<int>(videos.size()));
+    }
+    FrameSkipController& skip = pipeline ? pipeline->skipController() : *serial_skip;
+    // When nothing is drawn, a frame the controller skips is never looked at,
+    // so the producer does not decode it.
+    FrameSkipController* decode_skip = (skip.enabled() && !output.draw()) ? &skip : nullptr;
 
-    std::thread producer_thread(producer, std::ref(frame_queue), video_path, std::ref(running));
-    std::thread consumer_thread(consumer, std::ref(frame_queue), std::ref(engine), 
-                               std::ref(running), conf_threshold, nms_threshold);
+    std::vector<std::thread> producer_threads;
+    for (size_t s = 0; s < videos.size(); s++) {
+        FrameSink& sink = frame_queue ? static_cast<FrameSink&>(*frame_queue) : *sinks[s];
+        if (ingested(videos[s])) {
+            producer_threads.emplace_back(ingestProducer, std::ref(sink), videos[s].substr(4),
+                                          static_cast<int>(s), std::ref(running));
+            continue;
+        }
+        producer_threads.emplace_back(producer, std::ref(sink), videos[s], std::ref(running), pacing,
+                                      pipeline_config.decode_stride, decode_skip, static_cast<int>(s));
+    }
+
+    if (pipeline) {
+        pipeline->run(running);
+    } else {
+        std::thread consumer_thread(consumer, std::ref(*source), std::ref(engines.at(0)), 
+                                   std::ref(running), conf_threshold, nms_threshold, stats_interval_sec,
+                                   std::cref(output), std::ref(skip),
+                                   std::cref(pipeline_config.tracker), pipeline_config.cpu_pool);
+        consumer_thread.join();
+    }
 
-    producer_thread.join();
-    consumer_thread.join();
+    for (auto& t : producer_threads) t.join();
 
-    frame_queue.close();
+    source->close();
 
     cout << "Pipeline completed successfully." << endl;
     return 0;
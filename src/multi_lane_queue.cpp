@@ -0,0 +1,174 @@
+#include "../headers/multi_lane_queue.h"
+#include <stdexcept>
+using namespace std;
+
+MultiLaneQueue::~MultiLaneQueue() {
+    close();
+}
+
+int MultiLaneQueue::addLane(const LaneConfig& config) {
+    std::lock_guard<std::mutex> lock(mtx);
+    LaneConfig cfg = config;
+    if (cfg.weight == 0) cfg.weight = 1;
+    lanes.push_back(std::make_unique<Lane>(cfg));
+    return static_cast<int>(lanes.size() - 1);
+}
+
+bool MultiLaneQueue::push(const FrameEnvelope& frame) {
+    if (frame.source_id < 0 || frame.source_id >= static_cast<int>(lanes.size())) {
+        throw std::out_of_range("MultiLaneQueue: no lane for source " + std::to_string(frame.source_id));
+    }
+    Lane& lane = *lanes[frame.source_id];
+
+    std::unique_lock<std::mutex> lock(mtx);
+
+    if (closed || lane.closed || lane.config.capacity == 0) {
+        lane.stats.recordDrop();
+        return false;
+    }
+
+    bool blocked = false;
+    uint64_t wait_us = 0;
+    if (lane.q.size() >= lane.config.capacity) {
+        switch (lane.config.policy) {
+            case DropPolicy::Block: {
+                blocked = true;
+                auto wait_start = QueueStats::Clock::now();
+                lane.cv_space.wait(lock, [&] {
+                    return lane.q.size() < lane.config.capacity || closed || lane.closed;
+                });
+                wait_us = QueueStats::elapsedMicros(wait_start);
+                if (closed || lane.closed) {
+                    lane.stats.recordDrop();
+                    return false;
+                }
+                break;
+            }
+            case DropPolicy::DropOldest:
+                lane.q.pop_front();
+                total_size--;
+                lane.stats.recordDrop();
+                break;
+            case DropPolicy::DropNewest:
+                lane.stats.recordDrop();
+                return true;
+        }
+    }
+
+    lane.stats.recordPush(lane.q.size(), blocked, wait_us);
+    FrameEnvelope copy = frame;
+    if (!frame.buffer) copy.image = frame.image.clone();  // a buffer keeps the pixels alive already
+    lane.q.push_back(std::move(copy));
+    lane.size.store(lane.q.size(), std::memory_order_relaxed);
+    total_size++;
+    cv_pop.notify_one();
+    return true;
+}
+
+bool MultiLaneQueue::pop(FrameEnvelope& frame) {
+    std::unique_lock<std::mutex> lock(mtx);
+
+    bool blocked = total_size == 0 && !closed && !allLanesClosed();
+    uint64_t wait_us = 0;
+    if (blocked) {
+        auto wait_start = QueueStats::Clock::now();
+        cv_pop.wait(lock, [this] { return total_size > 0 || closed || allLanesClosed(); });
+        wait_us = QueueStats::elapsedMicros(wait_start);
+    }
+
+    if (total_size == 0) {
+        return false;
+    }
+
+    // Weighted round-robin: stay on the current lane for up to `weight` frames,
+    // then move on; empty lanes are skipped without using up their turn.
+    for (size_t visited = 0; visited <= lanes.size(); visited++) {
+        Lane& lane = *lanes[cursor];
+        if (!lane.q.empty() && served_in_round < lane.config.weight) {
+            frame = std::move(lane.q.front());
+            lane.q.pop_front();
+            lane.size.store(lane.q.size(), std::memory_order_relaxed);
+            total_size--;
+            lane.stats.recordPop(blocked, wait_us);
+            served_in_round++;
+            if (served_in_round >= lane.config.weight || lane.q.empty()) {
+                cursor = (cursor + 1) % lanes.size();
+                served_in_round = 0;
+            }
+            lane.cv_space.notify_one();
+            return true;
+        }
+        cursor = (cursor + 1) % lanes.size();
+        served_in_round = 0;
+    }
+    return false;
+}
+
+void MultiLaneQueue::closeLane(int lane) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (lane < 0 || lane >= static_cast<int>(lanes.size())) {
+        return;
+    }
+    lanes[lane]->closed = true;
+    lanes[lane]->cv_space.notify_all();
+    cv_pop.notify_all();
+}
+
+void MultiLaneQueue::close() {
+    std::lock_guard<std::mutex> lock(mtx);
+    closed = true;
+    for (auto& lane : lanes) {
+        lane->cv_space.notify_all();
+    }
+    cv_pop.notify_all();
+}
+
+bool MultiLaneQueue::isClosed() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return closed || allLanesClosed();
+}
+
+bool MultiLaneQueue::allLanesClosed() const {
+    if (lanes.empty()) {
+        return false;
+    }
+    for (const auto& lane : lanes) {
+        if (!lane->closed) return false;
+    }
+    return true;
+}
+
+size_t MultiLaneQueue::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return total_size;
+}
+
+size_t MultiLaneQueue::laneSize(int lane) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return lanes.at(lane)->q.size();
+}
+
+QueueStatsSnapshot MultiLaneQueue::laneStats(int lane) const {
+    const Lane& l = *lanes.at(lane);
+    return l.stats.snapshot(l.size.load(std::memory_order_relaxed));
+}
+
+void MultiLaneQueue::reportStats(std::ostream& os) const {
+    for (size_t i = 0; i < lanes.size(); i++) {
+        os << "Lane " << i << " (weight " << lanes[i]->config.weight << "): "
+           << laneStats(static_cast<int>(i)) << std::endl;
+    }
+}
+
+bool MultiLaneQueue::accepts(int lane) const {
+    // Lanes are fixed once producers run, and size is mirrored atomically.
+    const Lane& l = *lanes.at(lane);
+    return l.config.policy != DropPolicy::DropNewest ||
+           l.size.load(std::memory_order_relaxed) < l.config.capacity;
+}
+
+bool LaneSink::push(const FrameEnvelope& frame) {
+    FrameEnvelope stamped = frame;
+    stamped.source_id = lane_;
+    return queue_.push(stamped);
+}
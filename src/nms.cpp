@@ -28,23 +28,21 @@ float computeIoU(const cv::Rect2f& a, const cv::Rect2f& b) {
     return intersection_area / union_area;
 }
 
-std::vector<Detection> postprocess(
+namespace {
+// Anchors per partition when decoding with a pool.
+constexpr size_t kAnchorsPerPartition = 1024;
+
+template <typename BoxMapper>
+void decodeAnchors(
     const cv::Mat& predictions,
-    cv::Size original_image_size,
+    int begin,
+    int end,
     float conf_threshold,
-    float iou_threshold
-) 
+    BoxMapper& map_box,
+    std::vector<Detection>& detections
+)
 {
-    std::vector<Detection> detections;
-    
-    if (predictions.empty()) {
-        return detections;
-    }
-    
-    int num_classes = predictions.rows - 4;
-    int num_anchors = predictions.cols;
-    
-    for (int i = 0; i < num_anchors; i++) {
+    for (int i = begin; i < end; i++) {
         float max_conf = 0.0f;
         int max_class = -1;
         
@@ -65,30 +63,49 @@ std::vector<Detection> postprocess(
         float width = predictions.at<float>(2, i);
         float height = predictions.at<float>(3, i);
         
-        float x1 = center_x - width / 2.0f;
-        float y1 = center_y - height / 2.0f;
+        cv::Rect2f box = map_box(cv::Rect2f(center_x - width / 2.0f, center_y - height / 2.0f, width, height));
         
-        float scale_x = static_cast<float>(original_image_size.width) / 640.0f;
-        float scale_y = static_cast<float>(original_image_size.height) / 640.0f;
-        
-        x1 *= scale_x;
-        y1 *= scale_y;
-        width *= scale_x;
-        height *= scale_y;
-        
-        x1 = std::max(0.0f, std::min(x1, static_cast<float>(original_image_size.width)));
-        y1 = std::max(0.0f, std::min(y1, static_cast<float>(original_image_size.height)));
-        width = std::min(width, static_cast<float>(original_image_size.width) - x1);
-        height = std::min(height, static_cast<float>(original_image_size.height) - y1);
-        
-        if (width > 0 && height > 0) {
+        if (box.width > 0 && box.height > 0) {
             Detection det;
-            det.box = cv::Rect2f(x1, y1, width, height);
+            det.box = box;
             det.conf = max_conf;
             det.cls = max_class;
             detections.push_back(det);
         }
     }
+}
+
+template <typename BoxMapper>
+std::vector<Detection> decodeAndSuppress(
+    const cv::Mat& predictions,
+    float conf_threshold,
+    float iou_threshold,
+    BoxMapper map_box,
+    WorkStealingPool* pool
+)
+{
+    std::vector<Detection> detections;
+    
+    if (predictions.empty()) {
+        return detections;
+    }
+    
+    const size_t num_anchors = static_cast<size_t>(predictions.cols);
+    if (pool && num_anchors > kAnchorsPerPartition) {
+        // Each partition decodes into its own list; joining them in order
+        // gives the same candidates, in the same order, as a serial pass.
+        const size_t partitions = (num_anchors + kAnchorsPerPartition - 1) / kAnchorsPerPartition;
+        std::vector<std::vector<Detection>> parts(partitions);
+        pool->parallelFor(num_anchors, kAnchorsPerPartition, [&](size_t begin, size_t end) {
+            decodeAnchors(predictions, static_cast<int>(begin), static_cast<int>(end),
+                          conf_threshold, map_box, parts[begin / kAnchorsPerPartition]);
+        });
+        for (auto& part : parts) {
+            detections.insert(detections.end(), part.begin(), part.end());
+        }
+    } else {
+        decodeAnchors(predictions, 0, static_cast<int>(num_anchors), conf_threshold, map_box, detections);
+    }
     
     if (detections.empty()) {
         return detections;
@@ -122,4 +139,40 @@ std::vector<Detection> postprocess(
     }
     
     return nms_detections;
+}
+}
+
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    cv::Size original_image_size,
+    float conf_threshold,
+    float iou_threshold,
+    WorkStealingPool* pool
+) 
+{
+    float scale_x = static_cast<float>(original_image_size.width) / 640.0f;
+    float scale_y = static_cast<float>(original_image_size.height) / 640.0f;
+    float max_w = static_cast<float>(original_image_size.width);
+    float max_h = static_cast<float>(original_image_size.height);
+    
+    return decodeAndSuppress(predictions, conf_threshold, iou_threshold, [&](const cv::Rect2f& b) {
+        float x1 = std::max(0.0f, std::min(b.x * scale_x, max_w));
+        float y1 = std::max(0.0f, std::min(b.y * scale_y, max_h));
+        float width = std::min(b.width * scale_x, max_w - x1);
+        float height = std::min(b.height * scale_y, max_h - y1);
+        return cv::Rect2f(x1, y1, width, height);
+    }, pool);
+}
+
+std::vector<Detection> postprocess(
+    const cv::Mat& predictions,
+    const LetterboxTransform& letterbox,
+    float conf_threshold,
+    float iou_threshold,
+    WorkStealingPool* pool
+)
+{
+    return decodeAndSuppress(predictions, conf_threshold, iou_threshold, [&](const cv::Rect2f& b) {
+        return letterbox.toSource(b);
+    }, pool);
 }
\ No newline at end of file
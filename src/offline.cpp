@@ -0,0 +1,204 @@
+#include "../headers/offline.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include "../headers/nms.h"
+#include "../headers/preprocess.h"
+using namespace std;
+
+std::vector<Segment> planSegments(int64_t frame_count, int segments) {
+    vector<Segment> plan;
+    if (frame_count <= 0) return plan;
+    int64_t n = min<int64_t>(max(segments, 1), frame_count);
+    for (int64_t i = 0; i < n; i++) {
+        Segment s;
+        s.index = static_cast<int>(i);
+        s.begin = frame_count * i / n;
+        s.end = frame_count * (i + 1) / n;
+        plan.push_back(s);
+    }
+    return plan;
+}
+
+void TrackStitcher::stitch(SegmentResult& result) {
+    map<int, int> ids;  // segment-local -> global
+
+    // Greedily pair handoff tracks with the previous segment's last frame.
+    if (has_last_ && result.has_handoff && result.handoff.frame == last_.frame) {
+        vector<bool> taken(last_.tracks.size(), false);
+        for (const auto& t : result.handoff.tracks) {
+            float best_iou = 0.0f; int best = -1;
+            for (size_t j = 0; j < last_.tracks.size(); ++j) {
+                if (taken[j] || last_.tracks[j].cls != t.cls) continue;
+                float iou = iouRect(t.box, last_.tracks[j].box);
+                if (iou > best_iou) { best_iou = iou; best = static_cast<int>(j); }
+            }
+            if (best != -1 && best_iou >= match_iou_) {
+                taken[best] = true;
+                ids[t.id] = last_.tracks[best].id;
+                carried_++;
+            }
+        }
+    }
+
+    for (auto& f : result.frames) {
+        for (auto& t : f.tracks) {
+            auto it = ids.find(t.id);
+            if (it == ids.end()) it = ids.emplace(t.id, next_id_++).first;
+            t.id = it->second;
+        }
+    }
+    if (!result.frames.empty()) {
+        last_ = result.frames.back();
+        has_last_ = true;
+    }
+}
+
+namespace {
+// Decodes, infers and tracks one segment, including its warm-up frames.
+SegmentResult runSegment(const string& video_path, const Segment& segment, InferEnginePool& engines,
+                         const OfflineConfig& config, atomic<bool>& running, uint64_t& decoded) {
+    SegmentResult result;
+    result.segment = segment;
+
+    cv::VideoCapture cap(video_path);
+    if (!cap.isOpened()) {
+        cerr << "Offline: segment " << segment.index << " could not open " << video_path << endl;
+        return result;
+    }
+    int64_t start = max<int64_t>(0, segment.begin - config.overlap);
+    if (start > 0) cap.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(start));
+
+    auto session = engines.acquire();
+    const Preprocessor preprocessor(session->getInputWidth(), session->getInputHeight());
+    Tracker tracker(config.tracker);
+    FrameEnvelope envelope;
+    cv::Mat image;
+
+    for (int64_t frame = start; frame < segment.end && running.load(); frame++) {
+        if (!cap.read(image) || image.empty()) break;
+        decoded++;
+        envelope.image = image;
+        double timestamp_ms = cap.get(cv::CAP_PROP_POS_MSEC);
+
+        vector<Detection> detections;
+        cv::Mat blob = preprocessor.process(envelope);
+        if (!blob.empty()) {
+            cv::Mat predictions = session->infer(blob);
+            if (!predictions.empty()) {
+                detections = postprocess(predictions, envelope.letterbox,
+                                         config.conf_threshold, config.nms_threshold);
+            }
+        }
+        const vector<Track>& tracks = tracker.update(detections);
+
+        FrameResult r;
+        r.frame = frame;
+        r.timestamp_ms = timestamp_ms;
+        for (const auto& t : tracks) {
+            if (t.lost == 0) r.tracks.push_back(t);
+        }
+        if (frame == segment.begin - 1) {
+            result.handoff = std::move(r);
+            result.has_handoff = true;
+        } else if (frame >= segment.begin) {
+            result.frames.push_back(std::move(r));
+        }
+    }
+    return result;
+}
+
+void writeCsv(ostream& os, const FrameResult& f) {
+    for (const auto& t : f.tracks) {
+        os << f.frame << ',' << f.timestamp_ms << ',' << t.id << ',' << t.cls << ',' << t.conf << ','
+           << t.box.x << ',' << t.box.y << ',' << t.box.width << ',' << t.box.height << '\n';
+    }
+}
+}
+
+bool processOffline(const std::string& video_path, InferEnginePool& engines,
+                    const OfflineConfig& config, std::atomic<bool>& running) {
+    int64_t frame_count = 0;
+    double fps = 0.0;
+    {
+        cv::VideoCapture probe(video_path);
+        if (!probe.isOpened()) {
+            cerr << "Error: Could not open video source: " << video_path << endl;
+            return false;
+        }
+        frame_count = static_cast<int64_t>(probe.get(cv::CAP_PROP_FRAME_COUNT));
+        fps = probe.get(cv::CAP_PROP_FPS);
+    }
+    if (frame_count <= 0) {
+        cerr << "Error: offline mode needs a file with a known frame count: " << video_path << endl;
+        return false;
+    }
+
+    int workers = config.workers > 0 ? config.workers : max(1u, thread::hardware_concurrency());
+    vector<Segment> plan = planSegments(frame_count, config.segments > 0 ? config.segments : workers * 4);
+    workers = min<int>(workers, static_cast<int>(plan.size()));
+
+    ofstream out(config.detections_path);
+    if (!out) {
+        cerr << "Error: could not write " << config.detections_path << endl;
+        return false;
+    }
+    out << "frame,timestamp_ms,track_id,class,conf,x,y,w,h\n";
+
+    cout << "Offline: " << frame_count << " frames";
+    if (fps > 0) cout << " (" << frame_count / fps << " s)";
+    cout << " in " << plan.size() << " segments on " << workers << " workers, "
+         << engines.size() << " sessions" << endl;
+
+    // Workers take segments in order; finished ones wait in `done` until all
+    // earlier segments have been written.
+    mutex mtx;
+    size_t next_segment = 0, next_to_write = 0;
+    map<size_t, SegmentResult> done;
+    TrackStitcher stitcher;
+    uint64_t emitted = 0;
+    atomic<uint64_t> decoded_total{0};
+    auto start_time = chrono::steady_clock::now();
+
+    auto worker = [&] {
+        for (;;) {
+            size_t index;
+            {
+                lock_guard<mutex> lock(mtx);
+                if (next_segment >= plan.size() || !running.load()) return;
+                index = next_segment++;
+            }
+            uint64_t decoded = 0;
+            SegmentResult result = runSegment(video_path, plan[index], engines, config, running, decoded);
+            decoded_total += decoded;
+
+            lock_guard<mutex> lock(mtx);
+            done.emplace(index, std::move(result));
+            for (auto it = done.begin(); it != done.end() && it->first == next_to_write; it = done.begin()) {
+                stitcher.stitch(it->second);
+                for (const auto& f : it->second.frames) writeCsv(out, f);
+                emitted += it->second.frames.size();
+                done.erase(it);
+                next_to_write++;
+            }
+        }
+    };
+
+    vector<thread> threads;
+    for (int i = 0; i < workers; i++) threads.emplace_back(worker);
+    for (auto& t : threads) t.join();
+    out.flush();
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start_time).count();
+    cout << "Offline: wrote " << emitted << " of " << frame_count << " frames to " << config.detections_path
+         << " in " << elapsed << " s, " << (elapsed > 0 ? emitted / elapsed : 0.0) << " frames/s";
+    if (fps > 0 && elapsed > 0) cout << ", " << (frame_count / fps) / elapsed << "x realtime";
+    cout << endl;
+    cout << "Offline: decoded " << decoded_total.load() << " frames including warm-up, "
+         << stitcher.tracksCreated() << " tracks, " << stitcher.tracksCarried()
+         << " carried across segment boundaries" << endl;
+    return emitted > 0;
+}
@@ -0,0 +1,102 @@
+#include "../headers/pacing.h"
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+using namespace std;
+
+Pacing parsePacing(const std::string& spec) {
+    Pacing pacing;
+    if (spec == "max") {
+        pacing.mode = PacingMode::Max;
+    } else if (spec == "realtime") {
+        pacing.mode = PacingMode::Realtime;
+    } else if (spec.rfind("fixed=", 0) == 0) {
+        pacing.mode = PacingMode::Fixed;
+        pacing.fps = stod(spec.substr(6));
+        if (!(pacing.fps > 0)) {
+            throw invalid_argument("fixed pacing needs a positive fps: " + spec);
+        }
+    } else {
+        throw invalid_argument("unknown pacing mode: " + spec);
+    }
+    return pacing;
+}
+
+std::string toString(const Pacing& pacing) {
+    switch (pacing.mode) {
+        case PacingMode::Max: return "max";
+        case PacingMode::Realtime: return "realtime";
+        case PacingMode::Fixed: {
+            ostringstream os;
+            os << "fixed=" << pacing.fps;
+            return os.str();
+        }
+    }
+    return "?";
+}
+
+Pacer::Pacer(const Pacing& pacing, double source_fps) : pacing_(pacing), source_fps_(source_fps) {}
+
+double Pacer::targetFps() const {
+    switch (pacing_.mode) {
+        case PacingMode::Fixed: return pacing_.fps;
+        case PacingMode::Realtime: return source_fps_ > 0 ? source_fps_ : 0.0;
+        default: return 0.0;
+    }
+}
+
+double Pacer::achievedFps() const {
+    double span = chrono::duration<double>(last_ - first_).count();
+    return frames_ > 1 && span > 0 ? (frames_ - 1) / span : 0.0;
+}
+
+void Pacer::wait(double timestamp_ms) {
+    auto now = Clock::now();
+    if (frames_ == 0) {
+        first_ = now;
+    }
+
+    // Position of this frame on the schedule, in milliseconds.
+    double ts_ms = 0.0;
+    bool paced = true;
+    switch (pacing_.mode) {
+        case PacingMode::Max:
+            paced = false;
+            break;
+        case PacingMode::Fixed:
+            ts_ms = frames_ * 1000.0 / pacing_.fps;
+            break;
+        case PacingMode::Realtime:
+            if (timestamp_ms >= 0 && (frames_ == 0 || timestamp_ms > last_ts_ms_)) {
+                ts_ms = timestamp_ms;
+            } else if (source_fps_ > 0) {
+                ts_ms = last_ts_ms_ + 1000.0 / source_fps_;
+            } else {
+                paced = false;
+            }
+            break;
+    }
+
+    if (paced) {
+        if (frames_ == 0) {
+            anchor_ = now;
+            anchor_ts_ms_ = ts_ms;
+        }
+        auto due = anchor_ + chrono::duration_cast<Clock::duration>(
+            chrono::duration<double, milli>(ts_ms - anchor_ts_ms_));
+        if (due > now) {
+            this_thread::sleep_until(due);
+            now = Clock::now();
+        } else if (frames_ > 0) {
+            late_++;
+            if (chrono::duration<double, milli>(now - due).count() > kMaxLagMs) {
+                anchor_ = now;
+                anchor_ts_ms_ = ts_ms;
+            }
+        }
+        last_ts_ms_ = ts_ms;
+    }
+
+    last_ = now;
+    frames_++;
+}
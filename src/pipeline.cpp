@@ -0,0 +1,327 @@
+#include "../headers/pipeline.h"
+#include "../headers/render.h"
+#include "../headers/resequencer.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+using namespace std;
+
+void parseStageThreads(const std::string& spec, StageThreads& threads) {
+    stringstream ss(spec);
+    string item;
+    while (getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        size_t eq = item.find('=');
+        if (eq == string::npos) {
+            throw invalid_argument("expected stage=count, got: " + item);
+        }
+        string stage = item.substr(0, eq);
+        int count = stoi(item.substr(eq + 1));
+        if (count < 1) {
+            throw invalid_argument("thread count must be at least 1 for stage: " + stage);
+        }
+        if (stage == "pre") threads.preprocess = count;
+        else if (stage == "infer") threads.inference = count;
+        else if (stage == "post") threads.postprocess = count;
+        else if (stage == "render") threads.render = count;
+        else throw invalid_argument("unknown stage: " + stage);
+    }
+}
+
+std::string streamOutputPath(const std::string& base, int stream, int streams) {
+    if (streams <= 1) return base;
+    size_t dot = base.find_last_of('.');
+    size_t slash = base.find_last_of("/\\");
+    if (dot == string::npos || (slash != string::npos && dot < slash)) {
+        return base + "_" + to_string(stream);
+    }
+    return base.substr(0, dot) + "_" + to_string(stream) + base.substr(dot);
+}
+
+namespace {
+using Clock = chrono::steady_clock;
+}
+
+StagedPipeline::StagedPipeline(FrameSource& source, InferEnginePool& engines, const PipelineConfig& config)
+    : source_(source),
+      engines_(engines),
+      config_(config),
+      preprocessor_(engines.getInputWidth(), engines.getInputHeight(), config.cpu_pool),
+      trackers_(max(1, config.streams), Tracker(config.tracker)),
+      pre_to_infer_(config.queue_capacity),
+      infer_to_post_(config.queue_capacity),
+      track_to_render_(config.queue_capacity),
+      render_to_output_(config.queue_capacity),
+      post_to_track_(config.reorder_window),
+      skip_(config.skip, max(1, config.streams), config.threads.inference) {
+    pre_.name = "preprocess";   pre_.threads = config.threads.preprocess;
+    infer_.name = "inference";  infer_.threads = config.threads.inference;
+    post_.name = "postprocess"; post_.threads = config.threads.postprocess;
+    track_.name = "track";      track_.threads = 1;
+    render_.name = "render";    render_.threads = config.threads.render;
+    output_.name = "output";    output_.threads = 1;
+
+    const int streams = static_cast<int>(trackers_.size());
+    for (auto& tracker : trackers_) tracker.setPool(config.cpu_pool);
+    for (int i = 0; i < streams; i++) {
+        auto out = make_unique<StreamOutput>();
+        if (config.output.encode) {
+            VideoWriterConfig video = config.output.video;
+            video.path = streamOutputPath(video.path, i, streams);
+            out->writer = make_unique<AsyncVideoWriter>(video);
+        }
+        out->window = streams > 1 ? "YOLOv8 Object Detection [" + to_string(i) + "]" : "YOLOv8 Object Detection";
+        outputs_.push_back(std::move(out));
+    }
+    if (config.output.results.enabled()) results_ = make_unique<ResultSink>(config.output.results);
+}
+
+bool StagedPipeline::leaveStage(Stage& stage) {
+    return stage.active.fetch_sub(1) == 1;
+}
+
+void StagedPipeline::preprocessWorker(atomic<bool>& running) {
+    FrameTask task;
+    while (running.load()) {
+        {
+            // Pop and number under one lock so indices follow source order.
+            lock_guard<mutex> lock(source_mtx_);
+            if (!source_.pop(task.frame)) {
+                break;
+            }
+            task.index = next_index_++;
+            task.inferred = skip_.shouldInfer(task.frame);
+        }
+        // Hold frames that would run too far ahead of tracking.
+        if (!post_to_track_.admit(task.index)) break;
+        auto start = Clock::now();
+        // A frame the producer skipped has no pixels but still gets its record.
+        task.ok = !task.frame.image.empty() || task.frame.inference == FrameEnvelope::Inference::Skip;
+        if (task.ok && task.inferred) {
+            task.blob = preprocessor_.process(task.frame);
+            task.ok = !task.blob.empty();
+        }
+        // Nothing reads the pixels again unless they are drawn; an ingested
+        // frame's slot goes back to its producer here.
+        if (!config_.output.draw()) task.frame.releaseImage();
+        pre_.service_us.record(QueueStats::elapsedMicros(start));
+        pre_.frames++;
+        if (!pre_to_infer_.push(std::move(task))) break;
+        task = FrameTask();
+    }
+    if (leaveStage(pre_)) pre_to_infer_.close();
+}
+
+void StagedPipeline::inferenceWorker() {
+    FrameTask task;
+    while (pre_to_infer_.pop(task)) {
+        auto start = Clock::now();
+        if (task.ok && task.inferred) {
+            auto session = engines_.acquire();
+            // The skip controller paces against inference cost, not the
+            // wait for a free session.
+            auto infer_start = Clock::now();
+            task.predictions = session->infer(task.blob);
+            task.ok = !task.predictions.empty();
+            if (config_.skip.enabled()) {
+                skip_.recordFrame(true, chrono::duration<double, milli>(Clock::now() - infer_start).count());
+            }
+        }
+        task.blob.release();
+        infer_.service_us.record(QueueStats::elapsedMicros(start));
+        infer_.frames++;
+        if (!infer_to_post_.push(std::move(task))) break;
+    }
+    if (leaveStage(infer_)) infer_to_post_.close();
+}
+
+void StagedPipeline::postprocessWorker() {
+    FrameTask task;
+    while (infer_to_post_.pop(task)) {
+        auto start = Clock::now();
+        if (task.ok && task.inferred) {
+            task.detections = postprocess(task.predictions, task.frame.letterbox,
+                                          config_.conf_threshold, config_.nms_threshold, config_.cpu_pool);
+        }
+        task.predictions.release();
+        post_.service_us.record(QueueStats::elapsedMicros(start));
+        post_.frames++;
+        post_to_track_.push(task.index, std::move(task));
+    }
+    if (leaveStage(post_)) post_to_track_.close();
+}
+
+void StagedPipeline::trackWorker() {
+    FrameTask task;
+    while (post_to_track_.pop(task)) {
+        auto start = Clock::now();
+        int stream = task.frame.source_id;
+        if (stream < 0 || stream >= static_cast<int>(trackers_.size())) {
+            task.ok = false;
+        }
+        if (task.ok) {
+            Tracker& tracker = trackers_[stream];
+            task.tracks = task.inferred ? tracker.update(task.detections) : tracker.tracks();
+        }
+        track_.service_us.record(QueueStats::elapsedMicros(start));
+        track_.frames++;
+        if (!track_to_render_.push(std::move(task))) break;
+    }
+    if (leaveStage(track_)) track_to_render_.close();
+}
+
+void StagedPipeline::renderWorker() {
+    FrameTask task;
+    while (track_to_render_.pop(task)) {
+        auto start = Clock::now();
+        if (task.ok && config_.output.draw()) {
+            task.rendered = renderTracks(task.frame.image, task.tracks, config_.tracker.min_age_draw,
+                                         config_.cpu_pool);
+        }
+        render_.service_us.record(QueueStats::elapsedMicros(start));
+        render_.frames++;
+        if (!render_to_output_.push(std::move(task))) break;
+    }
+    if (leaveStage(render_)) render_to_output_.close();
+}
+
+void StagedPipeline::outputWorker(atomic<bool>& running) {
+    bool display = config_.output.display;
+    int processed_count = 0;
+    auto last_stats_print = Clock::now();
+
+    Resequencer<FrameTask> order;
+    auto emit = [&](FrameTask& task) {
+        if (!task.ok) return;
+        auto start = Clock::now();
+        StreamOutput& out = *outputs_[task.frame.source_id];
+        // Encoding happens on the writer's own thread; if it falls behind
+        // the frame is dropped there rather than stalling this stage.
+        if (out.writer) out.writer->write(task.rendered, task.frame.timestamp_ms, task.frame.source_fps);
+        if (results_) {
+            results_->write({task.frame.source_id, task.frame.seq, task.frame.timestamp_ms, task.inferred,
+                             task.detections, task.tracks});
+        }
+
+        // After ESC keep draining what is in flight, just stop showing it.
+        if (display) {
+            cv::imshow(out.window, task.rendered);
+            char key = cv::waitKey(1) & 0xFF;
+            if (key == 27) {
+                cout << "ESC pressed, stopping..." << endl;
+                running = false;
+                display = false;
+            }
+        }
+        output_.service_us.record(QueueStats::elapsedMicros(start));
+        output_.frames++;
+
+        uint64_t latency_us = static_cast<uint64_t>(task.frame.ageMs() * 1000.0);
+        latency_us_.record(latency_us);
+        out.latency_us.record(latency_us);
+        out.last_frame = Clock::now();
+        if (out.frames++ == 0) out.first_frame = out.last_frame;
+        processed_count++;
+        if (processed_count % 50 == 0) {
+            cout << "Pipeline: Processed " << processed_count << " frames, "
+                 << task.tracks.size() << " tracks in stream " << task.frame.source_id << endl;
+        }
+        if (config_.stats_interval_sec > 0) {
+            auto now = Clock::now();
+            if (chrono::duration<double>(now - last_stats_print).count() >= config_.stats_interval_sec) {
+                reportStats(cout);
+                last_stats_print = now;
+            }
+        }
+    };
+
+    FrameTask task;
+    while (render_to_output_.pop(task)) {
+        uint64_t index = task.index;
+        order.add(index, std::move(task), emit);
+    }
+    order.flush(emit);
+    if (config_.output.display) cv::destroyAllWindows();
+    for (auto& out : outputs_) {
+        if (out->writer) out->writer->close();
+    }
+    if (results_) results_->close();
+    leaveStage(output_);
+}
+
+void StagedPipeline::run(atomic<bool>& running) {
+    cout << "Staged pipeline started. Threads: pre=" << pre_.threads << " infer=" << infer_.threads
+         << " post=" << post_.threads << " render=" << render_.threads
+         << ", sessions " << engines_.size()
+         << ", queue capacity " << config_.queue_capacity
+         << ", reorder window " << config_.reorder_window
+         << ", streams " << outputs_.size()
+         << (config_.output.display ? "" : ", headless")
+         << (config_.output.encode ? "" : ", not encoding") << endl;
+
+    vector<thread> workers;
+    auto start = [&](Stage& stage, auto body) {
+        stage.active = stage.threads;
+        for (int i = 0; i < stage.threads; i++) workers.emplace_back(body);
+    };
+    start(output_, [&] { outputWorker(running); });
+    start(render_, [&] { renderWorker(); });
+    start(track_, [&] { trackWorker(); });
+    start(post_, [&] { postprocessWorker(); });
+    start(infer_, [&] { inferenceWorker(); });
+    start(pre_, [&] { preprocessWorker(running); });
+
+    for (auto& w : workers) w.join();
+    source_.close();
+
+    reportStats(cout);
+    cout << "Staged pipeline finished." << endl;
+}
+
+void StagedPipeline::reportStats(std::ostream& os) const {
+    source_.reportStats(os);
+    auto stage_line = [&](const Stage& stage) {
+        auto service = stage.service_us.snapshot();
+        os << "[Stage " << stage.name << " x" << stage.threads << "] frames=" << stage.frames.load()
+           << " service ms mean=" << service.mean() / 1000.0
+           << " p99<=" << service.percentile(0.99) / 1000.0
+           << " capacity fps=" << (service.mean() > 0 ? stage.threads * 1e6 / service.mean() : 0.0) << endl;
+    };
+    auto queue_line = [&](const char* name, const TaskQueue& q) {
+        os << "  -> " << name << ": " << q.stats() << endl;
+    };
+    stage_line(pre_);    queue_line("infer", pre_to_infer_);
+    stage_line(infer_);  queue_line("post", infer_to_post_);
+    stage_line(post_);   os << "  -> track: "; post_to_track_.reportStats(os);
+    stage_line(track_);  queue_line("render", track_to_render_);
+    stage_line(render_); queue_line("output", render_to_output_);
+    stage_line(output_);
+    if (config_.skip.enabled()) skip_.reportStats(os);
+    if (config_.cpu_pool) config_.cpu_pool->reportStats(os);
+    for (const auto& out : outputs_) {
+        if (out->writer) out->writer->reportStats(os);
+    }
+    if (results_) results_->reportStats(os);
+
+    if (outputs_.size() > 1) {
+        for (size_t i = 0; i < outputs_.size(); i++) {
+            const StreamOutput& out = *outputs_[i];
+            double span = chrono::duration<double>(out.last_frame - out.first_frame).count();
+            auto lat = out.latency_us.snapshot();
+            os << "[Stream " << i << "] frames=" << out.frames
+               << " fps=" << (span > 0 ? (out.frames - 1) / span : 0.0)
+               << " latency ms mean=" << lat.mean() / 1000.0
+               << " p50<=" << lat.percentile(0.5) / 1000.0
+               << " p99<=" << lat.percentile(0.99) / 1000.0
+               << " max=" << lat.max / 1000.0 << endl;
+        }
+    }
+
+    auto lat = latency_us_.snapshot();
+    os << "Pipeline: capture-to-done latency ms mean=" << lat.mean() / 1000.0
+       << " p50<=" << lat.percentile(0.5) / 1000.0
+       << " p99<=" << lat.percentile(0.99) / 1000.0
+       << " max=" << lat.max / 1000.0 << endl;
+}
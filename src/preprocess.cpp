@@ -1,13 +1,55 @@
 #include "preprocess.h"
+#include <algorithm>
 using namespace std;
 
-Preprocessor::Preprocessor(int input_width, int input_height)
-    : input_width_(input_width), input_height_(input_height) {}
+namespace {
+// Output rows per band when converting with a pool.
+constexpr size_t kBandRows = 32;
+}
+
+Preprocessor::Preprocessor(int input_width, int input_height, WorkStealingPool* pool)
+    : input_width_(input_width), input_height_(input_height), pool_(pool), scale_(1.0f) {}
 
 cv::Mat Preprocessor::process(const cv::Mat& image) {
+    LetterboxTransform transform;
+    cv::Mat blob = process(image, transform);
+    if (!blob.empty()) {
+        scale_ = transform.scale;
+        padding_ = transform.padding;
+    }
+    return blob;
+}
+
+cv::Mat Preprocessor::process(FrameEnvelope& frame) const {
+    return process(frame.image, frame.letterbox);
+}
+
+cv::Mat Preprocessor::process(const cv::Mat& image, LetterboxTransform& transform) const {
     if (image.empty()) {
         return cv::Mat();
     }
+    cv::Mat blob(3 * input_height_ * input_width_, 1, CV_32F);
+    if (!processInto(image, blob.ptr<float>(), transform)) {
+        return cv::Mat();
+    }
+    return blob;
+}
+
+bool Preprocessor::processInto(const cv::Mat& input, float* out, LetterboxTransform& transform) const {
+    if (input.empty()) {
+        return false;
+    }
+
+    // The fused loop below reads three interleaved bytes per pixel. Grey and
+    // BGRA frames are brought to BGR first; other depths are not supported.
+    cv::Mat image = input;
+    if (input.type() == CV_8UC1) {
+        cv::cvtColor(input, image, cv::COLOR_GRAY2BGR);
+    } else if (input.type() == CV_8UC4) {
+        cv::cvtColor(input, image, cv::COLOR_BGRA2BGR);
+    } else if (input.type() != CV_8UC3) {
+        return false;
+    }
 
     float scale = std::min(static_cast<float>(input_width_) / image.cols, 
                           static_cast<float>(input_height_) / image.rows);
@@ -18,36 +60,55 @@ cv::Mat Preprocessor::process(const cv::Mat& image) {
     int pad_x = (input_width_ - new_width) / 2;
     int pad_y = (input_height_ - new_height) / 2;
     
-    scale_ = scale;
-    padding_ = cv::Point(pad_x, pad_y);
+    transform.scale = scale;
+    transform.padding = cv::Point(pad_x, pad_y);
+    transform.source_size = image.size();
 
     cv::Mat resized;
     cv::resize(image, resized, cv::Size(new_width, new_height));
     
-    cv::Mat padded = cv::Mat::zeros(input_height_, input_width_, CV_8UC3);
-    cv::Rect roi(pad_x, pad_y, new_width, new_height);
-    resized.copyTo(padded(roi));
-    
-    cv::Mat normalized;
-    padded.convertTo(normalized, CV_32F, 1.0 / 255.0);
-    
-    cv::Mat rgb;
-    cv::cvtColor(normalized, rgb, cv::COLOR_BGR2RGB);
-    
-    std::vector<cv::Mat> channels(3);
-    cv::split(rgb, channels);
-    
-    std::vector<float> blob_data;
-    blob_data.reserve(3 * input_height_ * input_width_);
-    
-    for (int c = 0; c < 3; c++) {
-        blob_data.insert(blob_data.end(), 
-                        channels[c].ptr<float>(), 
-                        channels[c].ptr<float>() + channels[c].total());
+    // Letterbox padding, /255 scaling, BGR->RGB and HWC->CHW in one pass
+    // straight into the blob, one band of output rows at a time.
+    const size_t plane = static_cast<size_t>(input_height_) * input_width_;
+    const float to_unit = 1.0f / 255.0f;
+    parallelFor(pool_, static_cast<size_t>(input_height_), kBandRows, [&](size_t y0, size_t y1) {
+        for (size_t y = y0; y < y1; y++) {
+            float* r = out + y * input_width_;
+            float* g = r + plane;
+            float* b = g + plane;
+            int src_y = static_cast<int>(y) - pad_y;
+            if (src_y < 0 || src_y >= new_height) {
+                std::fill(r, r + input_width_, 0.0f);
+                std::fill(g, g + input_width_, 0.0f);
+                std::fill(b, b + input_width_, 0.0f);
+                continue;
+            }
+            const uchar* src = resized.ptr<uchar>(src_y);
+            for (int x = 0; x < input_width_; x++) {
+                int src_x = x - pad_x;
+                if (src_x < 0 || src_x >= new_width) {
+                    r[x] = g[x] = b[x] = 0.0f;
+                    continue;
+                }
+                const uchar* px = src + 3 * src_x;
+                b[x] = px[0] * to_unit;
+                g[x] = px[1] * to_unit;
+                r[x] = px[2] * to_unit;
+            }
+        }
+    });
+    return true;
+}
+
+cv::Mat Preprocessor::processBatch(std::vector<FrameEnvelope>& frames, std::vector<bool>& ok) const {
+    size_t per_image = static_cast<size_t>(3) * input_height_ * input_width_;
+    cv::Mat batch = cv::Mat::zeros(static_cast<int>(per_image * frames.size()), 1, CV_32F);
+    ok.assign(frames.size(), false);
+    for (size_t i = 0; i < frames.size(); i++) {
+        ok[i] = processInto(frames[i].image, batch.ptr<float>() + per_image * i, frames[i].letterbox);
+        if (!ok[i]) frames[i].letterbox = LetterboxTransform();
     }
-    
-    cv::Mat blob(blob_data.size(), 1, CV_32F, blob_data.data());
-    return blob.clone();
+    return batch;
 }
 
 std::pair<float, cv::Point> Preprocessor::getScaleAndPadding() const {
@@ -0,0 +1,216 @@
+#include "../headers/queue_stats.h"
+#include <algorithm>
+#include <iomanip>
+using namespace std;
+
+namespace {
+void atomicMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t prev = target.load(std::memory_order_relaxed);
+    while (prev < value &&
+           !target.compare_exchange_weak(prev, value, std::memory_order_relaxed)) {
+    }
+}
+
+size_t log2Bucket(uint64_t value) {
+    size_t bucket = 0;
+    while (value != 0 && bucket < Log2Histogram::kBuckets - 1) {
+        value >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        QueueStats::Clock::now().time_since_epoch()).count();
+}
+}
+
+// ---------------- Log2Histogram ----------------
+
+void Log2Histogram::record(uint64_t value) {
+    buckets_[log2Bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    atomicMax(max_, value);
+}
+
+void Log2Histogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+Log2Histogram::Snapshot Log2Histogram::snapshot() const {
+    Snapshot s;
+    for (size_t i = 0; i < kBuckets; i++) {
+        s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    s.count = count_.load(std::memory_order_relaxed);
+    s.sum = sum_.load(std::memory_order_relaxed);
+    s.max = max_.load(std::memory_order_relaxed);
+    return s;
+}
+
+double Log2Histogram::Snapshot::mean() const {
+    return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+uint64_t Log2Histogram::Snapshot::percentile(double p) const {
+    uint64_t total = 0;
+    for (auto b : buckets) total += b;
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(p * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t upper = (i == 0) ? 0 : ((1ull << i) - 1);
+            return std::min(upper, max);
+        }
+    }
+    return max;
+}
+
+// ---------------- LinearHistogram ----------------
+
+LinearHistogram::LinearHistogram(size_t capacity)
+    : num_buckets_(capacity + 1),
+      buckets_(new std::atomic<uint64_t>[capacity + 1]) {
+    reset();
+}
+
+void LinearHistogram::record(uint64_t value) {
+    size_t bucket = std::min<uint64_t>(value, num_buckets_ - 1);
+    buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    atomicMax(max_, value);
+}
+
+void LinearHistogram::reset() {
+    for (size_t i = 0; i < num_buckets_; i++) buckets_[i].store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+LinearHistogram::Snapshot LinearHistogram::snapshot() const {
+    Snapshot s;
+    s.num_buckets = num_buckets_;
+    s.buckets.reset(new uint64_t[num_buckets_]);
+    for (size_t i = 0; i < num_buckets_; i++) {
+        s.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    s.count = count_.load(std::memory_order_relaxed);
+    s.sum = sum_.load(std::memory_order_relaxed);
+    s.max = max_.load(std::memory_order_relaxed);
+    return s;
+}
+
+double LinearHistogram::Snapshot::mean() const {
+    return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+uint64_t LinearHistogram::Snapshot::percentile(double p) const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < num_buckets; i++) total += buckets[i];
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(p * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < num_buckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank) return i;
+    }
+    return num_buckets - 1;
+}
+
+// ---------------- QueueStats ----------------
+
+QueueStats::QueueStats(size_t capacity)
+    : capacity_(capacity), start_ns_(nowNanos()), occupancy_(capacity) {}
+
+void QueueStats::recordPush(size_t occupancy, bool blocked, uint64_t wait_us) {
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+    if (blocked) push_blocked_.fetch_add(1, std::memory_order_relaxed);
+    push_wait_us_.record(wait_us);
+    occupancy_.record(occupancy);
+}
+
+void QueueStats::recordPop(bool blocked, uint64_t wait_us) {
+    popped_.fetch_add(1, std::memory_order_relaxed);
+    if (blocked) pop_blocked_.fetch_add(1, std::memory_order_relaxed);
+    pop_wait_us_.record(wait_us);
+}
+
+void QueueStats::recordDrop() {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+}
+
+QueueStatsSnapshot QueueStats::snapshot(size_t current_size) const {
+    QueueStatsSnapshot s;
+    s.capacity = capacity_;
+    s.size = current_size;
+    s.elapsed_sec = (nowNanos() - start_ns_.load(std::memory_order_relaxed)) / 1e9;
+    s.pushed = pushed_.load(std::memory_order_relaxed);
+    s.popped = popped_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.push_blocked = push_blocked_.load(std::memory_order_relaxed);
+    s.pop_blocked = pop_blocked_.load(std::memory_order_relaxed);
+    s.push_wait_us = push_wait_us_.snapshot();
+    s.pop_wait_us = pop_wait_us_.snapshot();
+    s.occupancy = occupancy_.snapshot();
+    return s;
+}
+
+void QueueStats::reset() {
+    start_ns_.store(nowNanos(), std::memory_order_relaxed);
+    pushed_.store(0, std::memory_order_relaxed);
+    popped_.store(0, std::memory_order_relaxed);
+    dropped_.store(0, std::memory_order_relaxed);
+    push_blocked_.store(0, std::memory_order_relaxed);
+    pop_blocked_.store(0, std::memory_order_relaxed);
+    push_wait_us_.reset();
+    pop_wait_us_.reset();
+    occupancy_.reset();
+}
+
+// ---------------- QueueStatsSnapshot ----------------
+
+std::string QueueStatsSnapshot::bottleneck() const {
+    if (pushed == 0 && popped == 0) return "idle";
+    double push_block_ratio = pushed > 0 ? static_cast<double>(push_blocked) / pushed : 0.0;
+    double pop_block_ratio = popped > 0 ? static_cast<double>(pop_blocked) / popped : 0.0;
+    if (push_block_ratio > 0.5 && push_block_ratio > pop_block_ratio) return "consumer-bound";
+    if (pop_block_ratio > 0.5 && pop_block_ratio > push_block_ratio) return "producer-bound";
+    return "balanced";
+}
+
+std::ostream& operator<<(std::ostream& os, const QueueStatsSnapshot& s) {
+    std::ios_base::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::fixed << std::setprecision(1)
+       << "[QueueStats] size=" << s.size << "/" << s.capacity
+       << " pushed=" << s.pushed << " (" << s.pushRate() << "/s)"
+       << " popped=" << s.popped << " (" << s.popRate() << "/s)"
+       << " dropped=" << s.dropped << "\n"
+       << "  occupancy at push: mean=" << s.occupancy.mean()
+       << " p50=" << s.occupancy.percentile(0.5)
+       << " p95=" << s.occupancy.percentile(0.95)
+       << " max=" << s.occupancy.max << "\n"
+       << "  push blocked " << s.push_blocked << "x, wait us: mean=" << s.push_wait_us.mean()
+       << " p50<=" << s.push_wait_us.percentile(0.5)
+       << " p99<=" << s.push_wait_us.percentile(0.99)
+       << " max=" << s.push_wait_us.max << "\n"
+       << "  pop blocked " << s.pop_blocked << "x, wait us: mean=" << s.pop_wait_us.mean()
+       << " p50<=" << s.pop_wait_us.percentile(0.5)
+       << " p99<=" << s.pop_wait_us.percentile(0.99)
+       << " max=" << s.pop_wait_us.max << "\n"
+       << "  verdict: " << s.bottleneck();
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
@@ -0,0 +1,93 @@
+#include "../headers/render.h"
+#include <algorithm>
+using namespace std;
+
+const std::vector<std::string>& cocoClassNames() {
+    static const vector<string> class_names = {
+        "person", "bicycle", "car", "motorcycle", "airplane", "bus", "train", "truck", "boat",
+        "traffic light", "fire hydrant", "stop sign", "parking meter", "bench", "bird", "cat",
+        "dog", "horse", "sheep", "cow", "elephant", "bear", "zebra", "giraffe", "backpack",
+        "umbrella", "handbag", "tie", "suitcase", "frisbee", "skis", "snowboard", "sports ball",
+        "kite", "baseball bat", "baseball glove", "skateboard", "surfboard", "tennis racket",
+        "bottle", "wine glass", "cup", "fork", "knife", "spoon", "bowl", "banana", "apple",
+        "sandwich", "orange", "broccoli", "carrot", "hot dog", "pizza", "donut", "cake",
+        "chair", "couch", "potted plant", "bed", "dining table", "toilet", "tv", "laptop",
+        "mouse", "remote", "keyboard", "cell phone", "microwave", "oven", "toaster", "sink",
+        "refrigerator", "book", "clock", "vase", "scissors", "teddy bear", "hair drier", "toothbrush"
+    };
+    return class_names;
+}
+
+namespace {
+// Image rows per band when drawing with a pool.
+constexpr size_t kBandRows = 64;
+
+// Where one track's box and label go, in image coordinates.
+struct TrackLabel {
+    cv::Rect rect;
+    std::string text;
+    cv::Point org;
+    cv::Size size;
+    int baseline = 0;
+    int top = 0, bottom = 0;  // rows touched, including the 2px outline
+};
+
+vector<TrackLabel> layoutTracks(const std::vector<Track>& tracks, int min_age) {
+    const auto& class_names = cocoClassNames();
+    vector<TrackLabel> labels;
+    for (const auto& t : tracks) {
+        if (t.age < min_age) continue;
+        TrackLabel l;
+        l.rect = cv::Rect((int)t.smooth.x, (int)t.smooth.y, (int)t.smooth.width, (int)t.smooth.height);
+        string clsname = (t.cls >= 0 && t.cls < (int)class_names.size()) ? class_names[t.cls] : ("class_" + to_string(t.cls));
+        l.text = clsname + " " + to_string(t.conf).substr(0, 4) + " id=" + to_string(t.id);
+        l.size = cv::getTextSize(l.text, cv::FONT_HERSHEY_SIMPLEX, 0.5, 1, &l.baseline);
+        l.org = cv::Point(l.rect.x, max(0, l.rect.y - 5));
+        if (l.org.y < l.size.height) l.org.y = l.rect.y + l.size.height + 5;
+        l.top = min(l.rect.y, l.org.y - l.size.height - 5) - 2;
+        l.bottom = max(l.rect.y + l.rect.height, l.org.y + l.baseline) + 2;
+        labels.push_back(std::move(l));
+    }
+    return labels;
+}
+
+// Draws into `band`, which starts at image row y0; drawing clips to it.
+void drawLabels(cv::Mat& band, int y0, const vector<TrackLabel>& labels) {
+    const int y1 = y0 + band.rows;
+    for (const auto& l : labels) {
+        if (l.bottom < y0 || l.top >= y1) continue;
+        cv::rectangle(band, cv::Rect(l.rect.x, l.rect.y - y0, l.rect.width, l.rect.height), cv::Scalar(0, 255, 0), 2);
+        cv::rectangle(band, cv::Point(l.org.x, l.org.y - l.size.height - 5 - y0),
+                      cv::Point(l.org.x + l.size.width, l.org.y + l.baseline - y0), cv::Scalar(0, 255, 0), -1);
+        cv::putText(band, l.text, cv::Point(l.org.x, l.org.y - y0), cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 0), 1);
+    }
+}
+}
+
+void drawTracks(cv::Mat& image, const std::vector<Track>& tracks, int min_age, WorkStealingPool* pool) {
+    const vector<TrackLabel> labels = layoutTracks(tracks, min_age);
+    if (!pool) {
+        drawLabels(image, 0, labels);
+        return;
+    }
+    parallelFor(pool, static_cast<size_t>(image.rows), kBandRows, [&](size_t y0, size_t y1) {
+        cv::Mat band = image.rowRange(static_cast<int>(y0), static_cast<int>(y1));
+        drawLabels(band, static_cast<int>(y0), labels);
+    });
+}
+
+cv::Mat renderTracks(const cv::Mat& frame, const std::vector<Track>& tracks, int min_age, WorkStealingPool* pool) {
+    if (!pool) {
+        cv::Mat image = frame.clone();
+        drawTracks(image, tracks, min_age);
+        return image;
+    }
+    const vector<TrackLabel> labels = layoutTracks(tracks, min_age);
+    cv::Mat image(frame.rows, frame.cols, frame.type());
+    parallelFor(pool, static_cast<size_t>(frame.rows), kBandRows, [&](size_t y0, size_t y1) {
+        cv::Mat band = image.rowRange(static_cast<int>(y0), static_cast<int>(y1));
+        frame.rowRange(static_cast<int>(y0), static_cast<int>(y1)).copyTo(band);
+        drawLabels(band, static_cast<int>(y0), labels);
+    });
+    return image;
+}
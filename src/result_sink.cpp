@@ -0,0 +1,265 @@
+#include "../headers/result_sink.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+using namespace std;
+
+ResultFormat parseResultFormat(const std::string& name) {
+    if (name == "jsonl") return ResultFormat::JsonLines;
+    if (name == "bin") return ResultFormat::Binary;
+    throw invalid_argument("result format must be jsonl or bin: " + name);
+}
+
+namespace {
+void appendNumber(string& out, double value, int precision) {
+    char buf[32];
+    auto res = to_chars(buf, buf + sizeof(buf), value, chars_format::fixed, precision);
+    out.append(buf, res.ptr);
+}
+
+void appendInt(string& out, int64_t value) {
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, res.ptr);
+}
+
+void appendBox(string& out, const cv::Rect2f& box) {
+    out += "\"box\":[";
+    appendNumber(out, box.x, 1); out += ',';
+    appendNumber(out, box.y, 1); out += ',';
+    appendNumber(out, box.width, 1); out += ',';
+    appendNumber(out, box.height, 1); out += ']';
+}
+
+template <typename T>
+void appendRaw(string& out, T value) {
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+}
+
+void appendJsonLine(std::string& out, const FrameRecord& result) {
+    out += "{\"stream\":";
+    appendInt(out, result.stream);
+    out += ",\"seq\":";
+    appendInt(out, static_cast<int64_t>(result.seq));
+    out += ",\"ts_ms\":";
+    appendNumber(out, result.timestamp_ms, 2);
+    out += result.inferred ? ",\"inferred\":true" : ",\"inferred\":false";
+    out += ",\"detections\":[";
+    for (size_t i = 0; i < result.detections.size(); i++) {
+        const Detection& d = result.detections[i];
+        if (i > 0) out += ',';
+        out += "{\"cls\":";
+        appendInt(out, d.cls);
+        out += ",\"conf\":";
+        appendNumber(out, d.conf, 3);
+        out += ',';
+        appendBox(out, d.box);
+        out += '}';
+    }
+    out += "],\"tracks\":[";
+    for (size_t i = 0; i < result.tracks.size(); i++) {
+        const Track& t = result.tracks[i];
+        if (i > 0) out += ',';
+        out += "{\"id\":";
+        appendInt(out, t.id);
+        out += ",\"cls\":";
+        appendInt(out, t.cls);
+        out += ",\"conf\":";
+        appendNumber(out, t.conf, 3);
+        out += ",\"age\":";
+        appendInt(out, t.age);
+        out += ",\"lost\":";
+        appendInt(out, t.lost);
+        out += ',';
+        appendBox(out, t.smooth);
+        out += '}';
+    }
+    out += "]}\n";
+}
+
+void appendBinaryRecord(std::string& out, const FrameRecord& result) {
+    const uint32_t body = 4 + 8 + 8 + 1 + 4 + 4 +
+        static_cast<uint32_t>(result.detections.size() * 24 + result.tracks.size() * 36);
+    out.reserve(out.size() + 4 + body);
+    appendRaw<uint32_t>(out, body);
+    appendRaw<int32_t>(out, result.stream);
+    appendRaw<uint64_t>(out, result.seq);
+    appendRaw<double>(out, result.timestamp_ms);
+    appendRaw<uint8_t>(out, result.inferred ? 1 : 0);
+    appendRaw<uint32_t>(out, static_cast<uint32_t>(result.detections.size()));
+    appendRaw<uint32_t>(out, static_cast<uint32_t>(result.tracks.size()));
+    for (const Detection& d : result.detections) {
+        appendRaw<float>(out, d.box.x);
+        appendRaw<float>(out, d.box.y);
+        appendRaw<float>(out, d.box.width);
+        appendRaw<float>(out, d.box.height);
+        appendRaw<float>(out, d.conf);
+        appendRaw<int32_t>(out, d.cls);
+    }
+    for (const Track& t : result.tracks) {
+        appendRaw<int32_t>(out, t.id);
+        appendRaw<float>(out, t.smooth.x);
+        appendRaw<float>(out, t.smooth.y);
+        appendRaw<float>(out, t.smooth.width);
+        appendRaw<float>(out, t.smooth.height);
+        appendRaw<float>(out, t.conf);
+        appendRaw<int32_t>(out, t.cls);
+        appendRaw<int32_t>(out, t.age);
+        appendRaw<int32_t>(out, t.lost);
+    }
+}
+
+std::string ResultSink::rotatedPath(const std::string& base, int index) {
+    size_t slash = base.find_last_of("/\\");
+    size_t dot = base.find_last_of('.');
+    if (dot == string::npos || (slash != string::npos && dot < slash)) dot = base.size();
+    return base.substr(0, dot) + "_" + to_string(index) + base.substr(dot);
+}
+
+ResultSink::ResultSink(const ResultSinkConfig& config) : config_(config) {
+    config_.queue_capacity = max<size_t>(config_.queue_capacity, 1);
+    buffer_.reserve(config_.buffer_bytes + 4096);
+    thread_ = thread(&ResultSink::run, this);
+}
+
+ResultSink::~ResultSink() {
+    close();
+}
+
+bool ResultSink::write(FrameRecord result) {
+    if (failed_.load()) {
+        return false;
+    }
+    unique_lock<mutex> lock(mtx_);
+    if (queue_.size() >= config_.queue_capacity && !closed_) {
+        if (config_.drop_when_behind) {
+            dropped_++;
+            return false;
+        }
+        not_full_.wait(lock, [this] { return queue_.size() < config_.queue_capacity || closed_; });
+    }
+    if (closed_) {
+        return false;
+    }
+    queue_.push_back(std::move(result));
+    lock.unlock();
+    not_empty_.notify_one();
+    return true;
+}
+
+void ResultSink::close() {
+    {
+        lock_guard<mutex> lock(mtx_);
+        closed_ = true;
+    }
+    not_empty_.notify_all();
+    not_full_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool ResultSink::openNext() {
+    const int index = files_.load();
+    bool rotating = config_.rotate_bytes > 0 || config_.rotate_sec > 0;
+    string path = rotating ? rotatedPath(config_.path, index) : config_.path;
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) {
+        cerr << "ResultSink: could not open " << path << endl;
+        failed_ = true;
+        return false;
+    }
+    // Everything is already collected in buffer_; stdio's own buffer would
+    // only add a copy.
+    setvbuf(file_, nullptr, _IONBF, 0);
+    if (index == 0) cout << "ResultSink: " << path << endl;
+    files_++;
+    file_bytes_ = 0;
+    file_opened_ = Clock::now();
+    if (config_.format == ResultFormat::Binary) {
+        buffer_.append(kBinaryMagic, sizeof(kBinaryMagic));
+        appendRaw<uint32_t>(buffer_, kBinaryVersion);
+    }
+    return true;
+}
+
+void ResultSink::flush() {
+    if (buffer_.empty() || !file_) return;
+    auto start = Clock::now();
+    size_t n = fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    if (n != buffer_.size()) {
+        cerr << "ResultSink: write failed after " << bytes_.load() + n << " bytes" << endl;
+        failed_ = true;
+    }
+    bytes_ += n;
+    file_bytes_ += n;
+    buffer_.clear();
+    last_flush_ = Clock::now();
+    write_us_.record(QueueStats::elapsedMicros(start));
+}
+
+void ResultSink::closeFile() {
+    flush();
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void ResultSink::run() {
+    const auto flush_every = chrono::duration_cast<Clock::duration>(chrono::duration<double>(config_.flush_sec));
+    last_flush_ = Clock::now();
+    vector<FrameRecord> batch;
+    for (;;) {
+        {
+            unique_lock<mutex> lock(mtx_);
+            if (buffer_.empty()) {
+                not_empty_.wait(lock, [this] { return !queue_.empty() || closed_; });
+            } else {
+                not_empty_.wait_until(lock, last_flush_ + flush_every, [this] { return !queue_.empty() || closed_; });
+            }
+            if (queue_.empty() && closed_) break;
+            while (!queue_.empty()) {
+                batch.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+        not_full_.notify_all();
+
+        for (const FrameRecord& result : batch) {
+            if (failed_.load()) break;
+            if (file_) {
+                // Rotate before the record, so that none is split across files.
+                uint64_t pending = file_bytes_ + buffer_.size();
+                bool too_big = config_.rotate_bytes > 0 && pending >= config_.rotate_bytes;
+                bool too_old = config_.rotate_sec > 0 &&
+                    chrono::duration<double>(Clock::now() - file_opened_).count() >= config_.rotate_sec;
+                if (too_big || too_old) closeFile();
+            }
+            if (!file_ && !openNext()) break;
+            if (config_.format == ResultFormat::JsonLines) appendJsonLine(buffer_, result);
+            else appendBinaryRecord(buffer_, result);
+            written_++;
+            if (buffer_.size() >= config_.buffer_bytes) flush();
+        }
+        batch.clear();
+        if (Clock::now() - last_flush_ >= flush_every) flush();
+    }
+    closeFile();
+}
+
+void ResultSink::reportStats(std::ostream& os) const {
+    auto w = write_us_.snapshot();
+    os << "[ResultSink " << config_.path << "] records=" << written_.load()
+       << " dropped=" << dropped_.load()
+       << " bytes=" << bytes_.load()
+       << " files=" << files_.load()
+       << " writes=" << w.count
+       << " write ms mean=" << w.mean() / 1000.0
+       << " p99<=" << w.percentile(0.99) / 1000.0 << std::endl;
+}
@@ -0,0 +1,375 @@
+#include "../headers/shm_frame_queue.h"
+#include "../headers/adaptive_wait.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+constexpr uint32_t kMagic = 0x59384651;  // "YOLQ"
+constexpr uint32_t kVersion = 2;
+constexpr size_t kAlign = 64;
+
+size_t alignUp(size_t n) {
+    return (n + kAlign - 1) / kAlign * kAlign;
+}
+
+std::string shmName(const std::string& name) {
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+#ifndef _WIN32
+bool pidAlive(int32_t pid) {
+    return pid != 0 && (kill(static_cast<pid_t>(pid), 0) == 0 || errno == EPERM);
+}
+#endif
+}
+
+struct ShmFrameQueue::Header {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint32_t> ready;
+    uint32_t slot_count;
+    uint64_t slot_bytes;
+    uint64_t slot_stride;
+
+    alignas(kAlign) std::atomic<uint64_t> head;  // next slot the producer writes
+    alignas(kAlign) std::atomic<uint64_t> tail;  // next slot the consumer reads
+
+    alignas(kAlign) std::atomic<uint32_t> data_seq;  // bumped after every push
+    std::atomic<uint32_t> data_waiters;
+    alignas(kAlign) std::atomic<uint32_t> space_seq;  // bumped after every pop
+    std::atomic<uint32_t> space_waiters;
+
+    std::atomic<int32_t> producer_pid;
+    std::atomic<int32_t> consumer_pid;
+    std::atomic<uint32_t> closed;
+};
+
+struct ShmFrameQueue::SlotHeader {
+    uint64_t seq;
+    int64_t capture_ns;
+    double timestamp_ms;
+    double source_fps;
+    int32_t source_id;
+    int32_t rows;
+    int32_t cols;
+    int32_t type;
+    uint64_t bytes;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "shared-memory atomics must be lock-free");
+
+#ifndef _WIN32
+
+ShmFrameQueue::ShmFrameQueue(const std::string& name, Role role, size_t slot_count, size_t slot_bytes)
+    : name_(shmName(name)), role_(role) {
+    if (slot_count == 0 || slot_bytes == 0) {
+        throw std::invalid_argument("ShmFrameQueue: slot_count and slot_bytes must be non-zero");
+    }
+
+    const size_t header_bytes = alignUp(sizeof(Header));
+    bool created = false;
+
+    fd_ = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd_ >= 0) {
+        created = true;
+        size_t stride = alignUp(sizeof(SlotHeader)) + alignUp(slot_bytes);
+        mapped_bytes_ = header_bytes + slot_count * stride;
+        if (ftruncate(fd_, static_cast<off_t>(mapped_bytes_)) != 0) {
+            int err = errno;
+            ::close(fd_);
+            shm_unlink(name_.c_str());
+            throw std::runtime_error("ShmFrameQueue: ftruncate failed: " + std::string(strerror(err)));
+        }
+    } else if (errno == EEXIST) {
+        fd_ = shm_open(name_.c_str(), O_RDWR, 0600);
+        if (fd_ < 0) {
+            throw std::runtime_error("ShmFrameQueue: cannot open " + name_ + ": " + strerror(errno));
+        }
+        // The creator may still be sizing the segment.
+        struct stat st{};
+        for (int i = 0; i < 200; i++) {
+            if (fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) >= header_bytes) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (static_cast<size_t>(st.st_size) < header_bytes) {
+            ::close(fd_);
+            throw std::runtime_error("ShmFrameQueue: segment " + name_ + " was never initialised");
+        }
+        mapped_bytes_ = static_cast<size_t>(st.st_size);
+    } else {
+        throw std::runtime_error("ShmFrameQueue: cannot create " + name_ + ": " + strerror(errno));
+    }
+
+    base_ = mmap(nullptr, mapped_bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base_ == MAP_FAILED) {
+        int err = errno;
+        ::close(fd_);
+        if (created) shm_unlink(name_.c_str());
+        throw std::runtime_error("ShmFrameQueue: mmap failed: " + std::string(strerror(err)));
+    }
+
+    if (created) {
+        header_ = new (base_) Header();
+        header_->magic = kMagic;
+        header_->version = kVersion;
+        header_->slot_count = static_cast<uint32_t>(slot_count);
+        header_->slot_bytes = slot_bytes;
+        header_->slot_stride = alignUp(sizeof(SlotHeader)) + alignUp(slot_bytes);
+        header_->ready.store(1, std::memory_order_release);
+    } else {
+        header_ = static_cast<Header*>(base_);
+        for (int i = 0; i < 200 && header_->ready.load(std::memory_order_acquire) == 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (header_->ready.load(std::memory_order_acquire) == 0 ||
+            header_->magic != kMagic || header_->version != kVersion) {
+            munmap(base_, mapped_bytes_);
+            ::close(fd_);
+            throw std::runtime_error("ShmFrameQueue: " + name_ + " is not a compatible frame queue");
+        }
+        // A segment left closed by an earlier run whose peer is gone is reset
+        // rather than making this process wait on a stream that already ended.
+        const auto& peer = (role_ == Role::Producer) ? header_->consumer_pid : header_->producer_pid;
+        if (header_->closed.load(std::memory_order_acquire) && !pidAlive(peer.load(std::memory_order_acquire))) {
+            header_->head.store(0, std::memory_order_relaxed);
+            header_->tail.store(0, std::memory_order_relaxed);
+            header_->closed.store(0, std::memory_order_release);
+        }
+    }
+
+    auto& own_pid = (role_ == Role::Producer) ? header_->producer_pid : header_->consumer_pid;
+    own_pid.store(static_cast<int32_t>(getpid()), std::memory_order_release);
+    stats_ = std::make_unique<QueueStats>(header_->slot_count);
+}
+
+ShmFrameQueue::~ShmFrameQueue() {
+    if (!header_) return;
+    // Only an orderly end of stream retires the name; otherwise the segment
+    // is left for a restarted peer, which resets it if nobody is waiting.
+    const bool ended = isClosed();
+    close();
+    auto& own_pid = (role_ == Role::Producer) ? header_->producer_pid : header_->consumer_pid;
+    own_pid.store(0, std::memory_order_release);
+    munmap(base_, mapped_bytes_);
+    ::close(fd_);
+    if (role_ == Role::Consumer && ended) {
+        shm_unlink(name_.c_str());
+    }
+}
+
+void ShmFrameQueue::unlink(const std::string& name) {
+    shm_unlink(shmName(name).c_str());
+}
+
+bool ShmFrameQueue::peerAlive() const {
+    const auto& peer = (role_ == Role::Producer) ? header_->consumer_pid : header_->producer_pid;
+    int32_t pid = peer.load(std::memory_order_acquire);
+    // A peer that has not attached yet, or detached cleanly after closing,
+    // is not treated as dead.
+    return pid == 0 || pidAlive(pid);
+}
+
+#else
+
+ShmFrameQueue::ShmFrameQueue(const std::string& name, Role role, size_t, size_t)
+    : name_(name), role_(role) {
+    throw std::runtime_error("ShmFrameQueue: POSIX shared memory is not available on this platform");
+}
+
+ShmFrameQueue::~ShmFrameQueue() = default;
+
+void ShmFrameQueue::unlink(const std::string&) {}
+
+bool ShmFrameQueue::peerAlive() const {
+    return false;
+}
+
+#endif
+
+ShmFrameQueue::SlotHeader* ShmFrameQueue::slot(uint64_t index) const {
+    char* slots = static_cast<char*>(base_) + alignUp(sizeof(Header));
+    return reinterpret_cast<SlotHeader*>(slots + (index % header_->slot_count) * header_->slot_stride);
+}
+
+bool ShmFrameQueue::waitOn(std::atomic<uint32_t>& word, std::atomic<uint32_t>& waiters, uint32_t seen) {
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (word.load(std::memory_order_seq_cst) == seen) {
+        futexWait(word, seen, kPeerCheckMs, /*shared=*/true);
+    }
+    waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return awaitPeer();
+}
+
+// A restarted peer announces itself by storing its pid over the dead one.
+bool ShmFrameQueue::awaitPeer() {
+    if (peerAlive()) return true;
+    if (reattach_ms_ <= 0) return false;
+    std::cerr << "ShmFrameQueue: " << (role_ == Role::Producer ? "consumer" : "producer")
+              << " process is gone, waiting " << reattach_ms_ << " ms for it to re-attach" << std::endl;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(reattach_ms_);
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kPeerCheckMs));
+        if (isClosed()) return true;  // the caller sees the close and stops
+        if (peerAlive()) {
+            std::cerr << "ShmFrameQueue: peer re-attached to " << name_ << std::endl;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShmFrameQueue::push(const FrameEnvelope& frame) {
+    const cv::Mat& image = frame.image;
+    size_t row_bytes = image.cols * image.elemSize();
+    size_t bytes = row_bytes * image.rows;
+    if (role_ != Role::Producer || bytes > header_->slot_bytes || isClosed()) {
+        if (bytes > header_->slot_bytes) {
+            std::cerr << "ShmFrameQueue: frame of " << bytes << " bytes exceeds slot size "
+                      << header_->slot_bytes << std::endl;
+        }
+        stats_->recordDrop();
+        return false;
+    }
+
+    uint64_t head = header_->head.load(std::memory_order_relaxed);
+    bool blocked = false;
+    auto wait_start = QueueStats::Clock::now();
+    while (head - header_->tail.load(std::memory_order_acquire) >= header_->slot_count) {
+        if (!blocked) {
+            blocked = true;
+            wait_start = QueueStats::Clock::now();
+        }
+        uint32_t seen = header_->space_seq.load(std::memory_order_acquire);
+        if (head - header_->tail.load(std::memory_order_acquire) < header_->slot_count) break;
+        if (isClosed()) {
+            stats_->recordDrop();
+            return false;
+        }
+        if (!waitOn(header_->space_seq, header_->space_waiters, seen)) {
+            std::cerr << "ShmFrameQueue: consumer process is gone" << std::endl;
+            stats_->recordDrop();
+            return false;
+        }
+    }
+    uint64_t wait_us = blocked ? QueueStats::elapsedMicros(wait_start) : 0;
+
+    SlotHeader* s = slot(head);
+    s->seq = frame.seq;
+    s->capture_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        frame.capture_time.time_since_epoch()).count();
+    s->timestamp_ms = frame.timestamp_ms;
+    s->source_fps = frame.source_fps;
+    s->source_id = frame.source_id;
+    s->rows = image.rows;
+    s->cols = image.cols;
+    s->type = image.type();
+    s->bytes = bytes;
+    char* dst = reinterpret_cast<char*>(s) + alignUp(sizeof(SlotHeader));
+    if (image.isContinuous()) {
+        std::memcpy(dst, image.data, bytes);
+    } else {
+        for (int r = 0; r < image.rows; r++) {
+            std::memcpy(dst + r * row_bytes, image.ptr(r), row_bytes);
+        }
+    }
+
+    stats_->recordPush(static_cast<size_t>(head - header_->tail.load(std::memory_order_relaxed)), blocked, wait_us);
+    header_->head.store(head + 1, std::memory_order_release);
+    header_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->data_waiters.load(std::memory_order_seq_cst) > 0) {
+        futexWake(header_->data_seq, 1, /*shared=*/true);
+    }
+    return true;
+}
+
+bool ShmFrameQueue::pop(FrameEnvelope& frame) {
+    if (role_ != Role::Consumer) {
+        return false;
+    }
+
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    bool blocked = false;
+    auto wait_start = QueueStats::Clock::now();
+    while (tail == header_->head.load(std::memory_order_acquire)) {
+        if (!blocked) {
+            blocked = true;
+            wait_start = QueueStats::Clock::now();
+        }
+        uint32_t seen = header_->data_seq.load(std::memory_order_acquire);
+        if (tail != header_->head.load(std::memory_order_acquire)) break;
+        if (isClosed()) return false;
+        if (!waitOn(header_->data_seq, header_->data_waiters, seen) &&
+            tail == header_->head.load(std::memory_order_acquire)) {
+            std::cerr << "ShmFrameQueue: producer process is gone" << std::endl;
+            return false;
+        }
+    }
+    uint64_t wait_us = blocked ? QueueStats::elapsedMicros(wait_start) : 0;
+
+    const SlotHeader* s = slot(tail);
+    char* src = reinterpret_cast<char*>(const_cast<SlotHeader*>(s)) + alignUp(sizeof(SlotHeader));
+    frame.image = cv::Mat(s->rows, s->cols, s->type, src).clone();
+    frame.seq = s->seq;
+    frame.source_id = s->source_id;
+    frame.timestamp_ms = s->timestamp_ms;
+    frame.source_fps = s->source_fps;
+    frame.capture_time = FrameEnvelope::Clock::time_point(
+        std::chrono::duration_cast<FrameEnvelope::Clock::duration>(std::chrono::nanoseconds(s->capture_ns)));
+    frame.letterbox = LetterboxTransform();
+
+    header_->tail.store(tail + 1, std::memory_order_release);
+    stats_->recordPop(blocked, wait_us);
+    header_->space_seq.fetch_add(1, std::memory_order_seq_cst);
+    if (header_->space_waiters.load(std::memory_order_seq_cst) > 0) {
+        futexWake(header_->space_seq, 1, /*shared=*/true);
+    }
+    return true;
+}
+
+void ShmFrameQueue::close() {
+    header_->closed.store(1, std::memory_order_release);
+    header_->data_seq.fetch_add(1, std::memory_order_seq_cst);
+    header_->space_seq.fetch_add(1, std::memory_order_seq_cst);
+    futexWake(header_->data_seq, INT32_MAX, /*shared=*/true);
+    futexWake(header_->space_seq, INT32_MAX, /*shared=*/true);
+}
+
+bool ShmFrameQueue::isClosed() const {
+    return header_->closed.load(std::memory_order_acquire) != 0;
+}
+
+size_t ShmFrameQueue::size() const {
+    return static_cast<size_t>(header_->head.load(std::memory_order_acquire) -
+                               header_->tail.load(std::memory_order_acquire));
+}
+
+size_t ShmFrameQueue::slotCount() const {
+    return header_->slot_count;
+}
+
+size_t ShmFrameQueue::slotBytes() const {
+    return header_->slot_bytes;
+}
+
+QueueStatsSnapshot ShmFrameQueue::stats() const {
+    return stats_->snapshot(size());
+}
+
+void ShmFrameQueue::reportStats(std::ostream& os) const {
+    os << stats() << std::endl;
+}
@@ -0,0 +1,151 @@
+#include "../headers/shm_ingest.h"
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+// yolo_ingest.h sleeps on futexes, so ingestion is Linux-only.
+#ifdef __linux__
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include "../headers/yolo_ingest.h"
+#endif
+using namespace std;
+
+#ifdef __linux__
+
+struct ShmIngestSource::Segment {
+    yolo_ingest q{};
+    atomic<uint64_t> released{0};
+
+    ~Segment() {
+        if (!q.header) return;
+        // A stream the producer ended is not coming back; a new producer
+        // starts from a fresh segment.
+        bool ended = yolo_ingest_load_(&q.header->closed) != 0;
+        yolo_ingest_detach(&q);
+        if (ended) shm_unlink(q.name);
+    }
+};
+
+ShmIngestSource::ShmIngestSource(const std::string& name, int source_id, size_t slot_count, size_t slot_bytes)
+    : name_(name), source_id_(source_id) {
+    auto segment = make_shared<Segment>();
+    int err = yolo_ingest_open(&segment->q, name.c_str(), YOLO_INGEST_CONSUMER,
+                               static_cast<uint32_t>(slot_count), slot_bytes);
+    if (err != 0) {
+        throw runtime_error("ShmIngestSource: cannot open shared memory '" + name + "': " + strerror(-err));
+    }
+    segment_ = std::move(segment);
+}
+
+ShmIngestSource::~ShmIngestSource() = default;
+
+bool ShmIngestSource::popFor(FrameEnvelope& frame, int timeout_ms) {
+    if (closed_.load()) return false;
+    yolo_ingest* q = &segment_->q;
+    int slot = yolo_ingest_take(q, timeout_ms);
+    if (slot == YOLO_INGEST_CLOSED) {
+        closed_ = true;
+        return false;
+    }
+    if (slot < 0) {
+        int32_t pid = __atomic_load_n(&q->header->producer_pid, __ATOMIC_ACQUIRE);
+        if (pid != 0 && kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH) {
+            cerr << "ShmIngestSource: producer process is gone" << endl;
+            closed_ = true;
+        }
+        return false;
+    }
+
+    const yolo_ingest_slot& s = q->header->slots[slot];
+    uint8_t* pixels = yolo_ingest_pixels(q, slot);
+    frame = FrameEnvelope(cv::Mat(s.height, s.width, CV_8UC3, pixels, static_cast<size_t>(s.stride)),
+                          source_id_, s.seq);
+    frame.capture_time = FrameEnvelope::Clock::time_point(
+        chrono::duration_cast<FrameEnvelope::Clock::duration>(chrono::nanoseconds(s.publish_ns)));
+    frame.timestamp_ms = s.timestamp_ms;
+    // Runs when the last envelope sharing this frame drops it, on whichever
+    // pipeline thread that is.
+    frame.buffer = shared_ptr<void>(pixels, [segment = segment_, slot](void*) {
+        yolo_ingest_release(&segment->q, slot);
+        segment->released++;
+    });
+    taken_++;
+    return true;
+}
+
+bool ShmIngestSource::pop(FrameEnvelope& frame) {
+    while (!closed_.load()) {
+        if (popFor(frame, kPeerCheckMs)) return true;
+    }
+    return false;
+}
+
+#else
+
+struct ShmIngestSource::Segment {
+    atomic<uint64_t> released{0};
+};
+
+ShmIngestSource::ShmIngestSource(const std::string& name, int source_id, size_t, size_t)
+    : name_(name), source_id_(source_id) {
+    throw runtime_error("ShmIngestSource: shared-memory ingestion is only available on Linux");
+}
+
+ShmIngestSource::~ShmIngestSource() = default;
+
+bool ShmIngestSource::popFor(FrameEnvelope&, int) {
+    return false;
+}
+
+bool ShmIngestSource::pop(FrameEnvelope&) {
+    return false;
+}
+
+#endif
+
+void ShmIngestSource::close() {
+    closed_ = true;
+}
+
+bool ShmIngestSource::isClosed() const {
+    return closed_.load();
+}
+
+uint64_t ShmIngestSource::taken() const {
+    return taken_.load();
+}
+
+uint64_t ShmIngestSource::released() const {
+    return segment_ ? segment_->released.load() : 0;
+}
+
+void ShmIngestSource::reportStats(std::ostream& os) const {
+    uint64_t taken = taken_.load(), released = this->released();
+    os << "[ShmIngest " << name_ << "] taken=" << taken << " released=" << released
+       << " in use=" << taken - released << (closed_.load() ? " closed" : "") << endl;
+}
+
+void ingestProducer(FrameSink& sink, const std::string& name, int source_id, atomic<bool>& running) {
+    try {
+        ShmIngestSource source(name, source_id);
+        cout << "Producer started. Ingesting from shared memory: " << name << endl;
+        FrameEnvelope frame;
+        while (running.load() && !source.isClosed()) {
+            if (!source.popFor(frame, ShmIngestSource::kPeerCheckMs)) continue;
+            const bool pushed = sink.push(frame);
+            // The queue holds its own reference now; ours would pin one more
+            // slot until the next frame arrives.
+            frame.releaseImage();
+            if (!pushed) {
+                cout << "Queue closed, producer stopping." << endl;
+                break;
+            }
+        }
+        source.reportStats(cout);
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+    }
+    sink.close();
+}
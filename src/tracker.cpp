@@ -0,0 +1,147 @@
+#include "../headers/tracker.h"
+#include "../headers/assignment.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+using namespace std;
+
+float iouRect(const cv::Rect2f& a, const cv::Rect2f& b) {
+    float x1 = max(a.x, b.x);
+    float y1 = max(a.y, b.y);
+    float x2 = min(a.x + a.width, b.x + b.width);
+    float y2 = min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) return 0.0f;
+    float inter = (x2 - x1) * (y2 - y1);
+    float uni = a.width * a.height + b.width * b.height - inter;
+    return uni > 0 ? inter / uni : 0.0f;
+}
+
+namespace {
+// Below this many track/detection pairs the overlaps are computed inline.
+constexpr size_t kParallelPairs = 4096;
+}
+
+TrackMatch parseTrackMatch(const std::string& name) {
+    if (name == "greedy") return TrackMatch::Greedy;
+    if (name == "optimal") return TrackMatch::Optimal;
+    throw std::invalid_argument("expected greedy or optimal, got '" + name + "'");
+}
+
+Tracker::Tracker(const TrackerConfig& config) : config_(config) {}
+
+void Tracker::matchPass(const vector<Detection>& filtered, const vector<int>& by_left, float max_width,
+                        bool low_pass, vector<int>& track_assigned, vector<int>& det_assigned) const {
+    // Admissible pairs up front, one row per track, so that the rows can be
+    // spread over the pool; the matching below stays sequential.
+    const size_t dets = filtered.size();
+    vector<vector<AssignmentEdge>> candidates(tracks_.size());
+    size_t rows_per_task = max<size_t>(1, kParallelPairs / max<size_t>(1, dets));
+    parallelFor(tracks_.size() * dets >= kParallelPairs ? pool_ : nullptr, tracks_.size(), rows_per_task,
+                [&](size_t t0, size_t t1) {
+        for (size_t ti = t0; ti < t1; ++ti) {
+            const Track& t = tracks_[ti];
+            // The second pass is for established tracks that were seen last
+            // frame and found nothing confident enough in the first.
+            if (low_pass && (track_assigned[ti] != -1 || t.age == 0 || t.lost > 0)) continue;
+            const float conf_gate = (t.age > 0) ? config_.keep_conf : config_.enter_conf;
+            auto first = lower_bound(by_left.begin(), by_left.end(), t.box.x - max_width,
+                                     [&](int j, float x) { return filtered[j].box.x < x; });
+            for (auto it = first; it != by_left.end() && filtered[*it].box.x < t.box.x + t.box.width; ++it) {
+                const Detection& d = filtered[*it];
+                if (d.cls != t.cls) continue;
+                if (low_pass ? (det_assigned[*it] != -1 || d.conf < config_.low_conf || d.conf >= conf_gate)
+                             : d.conf < conf_gate) continue;
+                float iou = iouRect(t.box, d.box);
+                if (iou > 0.0f && iou >= config_.match_iou) {
+                    candidates[ti].push_back({static_cast<int>(ti), *it, iou});
+                }
+            }
+        }
+    });
+
+    if (config_.match == TrackMatch::Greedy) {
+        for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+            float best_iou = 0.0f; int best_j = -1;
+            for (const auto& e : candidates[ti]) {
+                if (det_assigned[e.col] != -1) continue;
+                // Ties go to the earlier detection.
+                if (e.score > best_iou || (e.score == best_iou && e.col < best_j)) { best_iou = e.score; best_j = e.col; }
+            }
+            if (best_j != -1) {
+                det_assigned[best_j] = (int)ti;
+                track_assigned[ti] = best_j;
+            }
+        }
+    } else {
+        vector<AssignmentEdge> edges;
+        for (const auto& row : candidates) edges.insert(edges.end(), row.begin(), row.end());
+        vector<int> matched = solveAssignment(static_cast<int>(tracks_.size()), static_cast<int>(dets), edges);
+        for (size_t ti = 0; ti < tracks_.size(); ++ti) {
+            if (matched[ti] == -1) continue;
+            track_assigned[ti] = matched[ti];
+            det_assigned[matched[ti]] = (int)ti;
+        }
+    }
+}
+
+const std::vector<Track>& Tracker::update(const std::vector<Detection>& detections) {
+    const auto& allowed = config_.allowed_classes;
+    vector<Detection> filtered;
+    for (auto& d : detections) {
+        if (allowed.empty() || find(allowed.begin(), allowed.end(), d.cls) != allowed.end()) {
+            filtered.push_back(d);
+        }
+    }
+
+    vector<int> det_assigned(filtered.size(), -1);
+    vector<int> track_assigned(tracks_.size(), -1);
+
+    // A track only looks at detections whose left edge is close enough to
+    // reach it.
+    vector<int> by_left(filtered.size());
+    iota(by_left.begin(), by_left.end(), 0);
+    sort(by_left.begin(), by_left.end(), [&](int a, int b) { return filtered[a].box.x < filtered[b].box.x; });
+    float max_width = 0.0f;
+    for (const auto& d : filtered) max_width = max(max_width, d.box.width);
+
+    matchPass(filtered, by_left, max_width, false, track_assigned, det_assigned);
+    if (config_.low_conf > 0.0f) matchPass(filtered, by_left, max_width, true, track_assigned, det_assigned);
+
+    for (size_t j = 0; j < filtered.size(); ++j) {
+        if (det_assigned[j] != -1) continue;
+        if (filtered[j].conf < config_.enter_conf) continue;
+        Track t;
+        t.id = next_id_++;
+        t.box = filtered[j].box;
+        t.smooth = filtered[j].box;
+        t.conf = filtered[j].conf;
+        t.cls = filtered[j].cls;
+        t.age = 0; t.lost = 0;
+        tracks_.push_back(t);
+    }
+
+    const float alpha = config_.alpha;
+    for (size_t ti = 0; ti < track_assigned.size(); ++ti) {
+        int dj = track_assigned[ti];
+        if (dj != -1) {
+            auto& det = filtered[dj];
+            cv::Rect2f b = tracks_[ti].smooth;
+            b.x = alpha * det.box.x + (1 - alpha) * b.x;
+            b.y = alpha * det.box.y + (1 - alpha) * b.y;
+            b.width = alpha * det.box.width + (1 - alpha) * b.width;
+            b.height = alpha * det.box.height + (1 - alpha) * b.height;
+            tracks_[ti].box = det.box;
+            tracks_[ti].smooth = b;
+            tracks_[ti].conf = det.conf;
+            tracks_[ti].cls = det.cls;
+            tracks_[ti].age++;
+            tracks_[ti].lost = 0;
+        } else {
+            tracks_[ti].lost++;
+        }
+    }
+
+    const int grace_lost = config_.grace_lost;
+    tracks_.erase(remove_if(tracks_.begin(), tracks_.end(), [&](const Track& t){ return t.lost > grace_lost; }), tracks_.end());
+    return tracks_;
+}
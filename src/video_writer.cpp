@@ -0,0 +1,123 @@
+#include "../headers/video_writer.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+using namespace std;
+
+int parseFourcc(const std::string& codec) {
+    if (codec.size() != 4) {
+        throw invalid_argument("codec must be a four-character code: " + codec);
+    }
+    return cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]);
+}
+
+VideoEncoder::VideoEncoder(const VideoWriterConfig& config) : config_(config) {
+    parseFourcc(config_.codec);
+}
+
+VideoEncoder::~VideoEncoder() {
+    close();
+}
+
+bool VideoEncoder::open(const cv::Mat& first, double source_fps) {
+    fps_ = config_.fps > 0 ? config_.fps : (source_fps > 0 ? source_fps : 30.0);
+    writer_.open(config_.path, parseFourcc(config_.codec), fps_, first.size());
+    if (!writer_.isOpened()) {
+        cerr << "VideoWriter: could not open " << config_.path << " with codec " << config_.codec << endl;
+        failed_ = true;
+        return false;
+    }
+    cout << "VideoWriter: " << config_.path << " (" << config_.codec << ", " << fps_ << " fps)" << endl;
+    return true;
+}
+
+bool VideoEncoder::write(const cv::Mat& frame, double timestamp_ms, double source_fps) {
+    if (frame.empty()) return true;
+    if (!writer_.isOpened() && (failed_.load() || !open(frame, source_fps))) {
+        return false;
+    }
+    auto start = QueueStats::Clock::now();
+
+    // Where this frame belongs on the output timeline. Frames without a
+    // usable timestamp are simply appended.
+    if (timestamp_ms >= 0) {
+        if (first_ts_ < 0) first_ts_ = timestamp_ms;
+        double slot = (timestamp_ms - first_ts_) * fps_ / 1000.0;
+        uint64_t due = slot > 0 ? static_cast<uint64_t>(llround(slot)) : 0;
+        // Cap the fill at one second of video in case the clock jumps.
+        uint64_t fill = due > frames_out_ ? min<uint64_t>(due - frames_out_, static_cast<uint64_t>(fps_) + 1) : 0;
+        for (uint64_t i = 0; i < fill && !last_.empty(); i++) {
+            writer_.write(last_);
+            repeated_++;
+            frames_out_++;
+        }
+    }
+
+    writer_.write(frame);
+    written_++;
+    frames_out_++;
+    last_ = frame;
+    encode_us_.record(QueueStats::elapsedMicros(start));
+    return true;
+}
+
+void VideoEncoder::close() {
+    last_.release();
+    if (writer_.isOpened()) {
+        writer_.release();
+    }
+}
+
+void VideoEncoder::reportStats(std::ostream& os) const {
+    auto enc = encode_us_.snapshot();
+    os << "[VideoWriter " << config_.path << "] written=" << written_.load()
+       << " repeated=" << repeated_.load()
+       << " encode ms mean=" << enc.mean() / 1000.0
+       << " p99<=" << enc.percentile(0.99) / 1000.0 << std::endl;
+}
+
+AsyncVideoWriter::AsyncVideoWriter(const VideoWriterConfig& config)
+    : config_(config), queue_(max<size_t>(config.queue_capacity, 1)), encoder_(config) {
+    thread_ = thread(&AsyncVideoWriter::run, this);
+}
+
+AsyncVideoWriter::~AsyncVideoWriter() {
+    close();
+}
+
+bool AsyncVideoWriter::write(const cv::Mat& frame, double timestamp_ms, double source_fps) {
+    if (encoder_.failed() || frame.empty()) {
+        return false;
+    }
+    Item item{frame, timestamp_ms, source_fps};
+    return config_.drop_when_behind ? queue_.tryPush(std::move(item)) : queue_.push(std::move(item));
+}
+
+void AsyncVideoWriter::close() {
+    queue_.close();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AsyncVideoWriter::run() {
+    Item item;
+    // A failed encoder still drains the queue so that a blocking caller is
+    // not stuck.
+    while (queue_.pop(item)) {
+        encoder_.write(item.frame, item.timestamp_ms, item.source_fps);
+    }
+    encoder_.close();
+}
+
+void AsyncVideoWriter::reportStats(std::ostream& os) const {
+    auto q = queue_.stats();
+    auto enc = encoder_.encodeMicros();
+    os << "[VideoWriter " << config_.path << "] written=" << encoder_.written()
+       << " repeated=" << encoder_.repeated()
+       << " dropped=" << q.dropped
+       << " queued=" << q.size << "/" << q.capacity
+       << " encode ms mean=" << enc.mean() / 1000.0
+       << " p99<=" << enc.percentile(0.99) / 1000.0 << std::endl;
+}
@@ -0,0 +1,145 @@
+#include "../headers/work_stealing_pool.h"
+#include <algorithm>
+#include <exception>
+#include <ostream>
+using namespace std;
+
+namespace {
+// Which pool and worker the current thread belongs to.
+thread_local const WorkStealingPool* tls_pool = nullptr;
+thread_local int tls_index = -1;
+
+// Per-thread xorshift for picking steal victims.
+uint32_t nextRandom() {
+    thread_local uint32_t state = static_cast<uint32_t>(hash<thread::id>()(this_thread::get_id())) | 1u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+}
+
+WorkStealingPool::WorkStealingPool(int threads) {
+    if (threads <= 0) threads = static_cast<int>(max(1u, thread::hardware_concurrency()));
+    for (int i = 0; i < threads; i++) queues_.push_back(make_unique<Worker>());
+    for (int i = 0; i < threads; i++) workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> lock(sleep_mtx_);
+        stopping_ = true;
+    }
+    sleep_cv_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+int WorkStealingPool::currentWorker() const {
+    return tls_pool == this ? tls_index : -1;
+}
+
+void WorkStealingPool::submit(Task task) {
+    int self = currentWorker();
+    size_t target = self >= 0 ? static_cast<size_t>(self)
+                              : next_queue_.fetch_add(1, memory_order_relaxed) % queues_.size();
+    {
+        lock_guard<mutex> lock(queues_[target]->mtx);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // Counted under the sleep lock so a worker about to sleep sees it.
+        lock_guard<mutex> lock(sleep_mtx_);
+        queued_.fetch_add(1, memory_order_relaxed);
+    }
+    sleep_cv_.notify_one();
+}
+
+bool WorkStealingPool::runOne(int self) {
+    Task task;
+    if (self >= 0) {
+        Worker& own = *queues_[self];
+        lock_guard<mutex> lock(own.mtx);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    if (!task) {
+        const size_t n = queues_.size();
+        size_t start = nextRandom() % n;
+        for (size_t k = 0; k < n && !task; k++) {
+            size_t victim = (start + k) % n;
+            if (static_cast<int>(victim) == self) continue;
+            Worker& other = *queues_[victim];
+            lock_guard<mutex> lock(other.mtx);
+            if (!other.tasks.empty()) {
+                task = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                if (self >= 0) stolen_.fetch_add(1, memory_order_relaxed);
+            }
+        }
+    }
+    if (!task) return false;
+    queued_.fetch_sub(1, memory_order_relaxed);
+    task();
+    executed_.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+void WorkStealingPool::workerLoop(int index) {
+    tls_pool = this;
+    tls_index = index;
+    for (;;) {
+        if (runOne(index)) continue;
+        unique_lock<mutex> lock(sleep_mtx_);
+        sleep_cv_.wait(lock, [this] { return stopping_ || queued_.load(memory_order_relaxed) > 0; });
+        if (stopping_) return;
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    grain = max<size_t>(1, grain);
+    const size_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1) {
+        if (count > 0) body(0, count);
+        return;
+    }
+
+    // Helpers may still be queued after the caller returns, so the shared
+    // state outlives this frame; `body` is only touched while chunks remain.
+    struct State {
+        atomic<size_t> next{0};
+        atomic<size_t> done{0};
+        mutex error_mtx;
+        exception_ptr error;
+    };
+    auto state = make_shared<State>();
+    auto work = [state, chunks, count, grain, &body] {
+        for (size_t c; (c = state->next.fetch_add(1)) < chunks;) {
+            try {
+                body(c * grain, min(count, (c + 1) * grain));
+            } catch (...) {
+                lock_guard<mutex> lock(state->error_mtx);
+                if (!state->error) state->error = current_exception();
+            }
+            state->done.fetch_add(1, memory_order_release);
+        }
+    };
+
+    size_t helpers = min(chunks - 1, queues_.size());
+    for (size_t i = 0; i < helpers; i++) submit(work);
+    work();
+
+    // Chunks still running on other threads: help with whatever is queued
+    // rather than just waiting.
+    int self = currentWorker();
+    while (state->done.load(memory_order_acquire) < chunks) {
+        if (!runOne(self)) this_thread::yield();
+    }
+    if (state->error) rethrow_exception(state->error);
+}
+
+void WorkStealingPool::reportStats(std::ostream& os) const {
+    os << "[CpuPool] threads=" << threads() << " tasks=" << executed() << " stolen=" << stolen()
+       << " queued=" << queued_.load(memory_order_relaxed) << endl;
+}
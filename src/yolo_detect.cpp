@@ -0,0 +1,361 @@
+#define YOLO_DETECT_BUILD
+#include "../headers/yolo_detect.h"
+#include "../headers/infer_engine.h"
+#include "../headers/preprocess.h"
+#include "../headers/nms.h"
+#include "../headers/tracker.h"
+#include "../headers/work_stealing_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+using namespace std;
+
+struct yolo_engine {
+    yolo_engine_options options;
+    unique_ptr<WorkStealingPool> pool;
+    InferEngine engine;
+    unique_ptr<Preprocessor> preprocessor;
+    // Reused by yolo_detect*; they only grow.
+    vector<float> blob;
+    vector<float> predictions;
+    vector<LetterboxTransform> letterboxes;
+};
+
+struct yolo_tracker {
+    Tracker tracker;
+    vector<Detection> detections;
+
+    explicit yolo_tracker(const TrackerConfig& config) : tracker(config) {}
+};
+
+namespace {
+thread_local string last_error;
+
+yolo_status fail(yolo_status status, const string& message) {
+    last_error = message;
+    return status;
+}
+
+// Overlays the caller's options on the defaults in `out`, reading only the
+// struct_size bytes the caller declared. `oldest` is the smallest layout
+// ever shipped, the first one with struct_size.
+template <typename Options>
+bool readOptions(const Options* in, Options& out, size_t oldest) {
+    if (!in) return true;
+    if (in->struct_size < oldest) return false;
+    memcpy(&out, in, min<size_t>(in->struct_size, sizeof(Options)));
+    out.struct_size = sizeof(Options);
+    return true;
+}
+
+// Layouts of ABI version 2, up to and including their last field. Frozen:
+// fields appended later must not raise the minimum a caller has to declare.
+constexpr size_t kEngineOptionsV2 = offsetof(yolo_engine_options, cpu_threads) + sizeof(int32_t);
+constexpr size_t kTrackerOptionsV2 = offsetof(yolo_tracker_options, grace_lost) + sizeof(int32_t);
+static_assert(kEngineOptionsV2 == 16, "yolo_engine_options v2 layout changed");
+// struct_size padded to the classes pointer, the pointer, then six 4-byte fields.
+static_assert(kTrackerOptionsV2 == 2 * sizeof(void*) + 6 * sizeof(int32_t),
+              "yolo_tracker_options v2 layout changed");
+
+// Every entry point runs its body through here so that no C++ exception
+// crosses the C boundary.
+template <typename F>
+yolo_status guarded(F&& body) {
+    try {
+        return body();
+    } catch (const exception& e) {
+        return fail(YOLO_ERROR_INTERNAL, e.what());
+    } catch (...) {
+        return fail(YOLO_ERROR_INTERNAL, "unknown error");
+    }
+}
+
+bool validImage(const yolo_image* image) {
+    return image && image->data && image->width > 0 && image->height > 0 &&
+           image->stride >= image->width * 3;
+}
+
+// A header over the caller's pixels; nothing is copied. Preprocessing only
+// reads from it.
+cv::Mat view(const yolo_image& image) {
+    return cv::Mat(image.height, image.width, CV_8UC3, const_cast<uint8_t*>(image.data),
+                   static_cast<size_t>(image.stride));
+}
+
+size_t blobFloats(const yolo_engine& e) {
+    return static_cast<size_t>(3) * e.engine.getInputWidth() * e.engine.getInputHeight();
+}
+
+size_t predictionFloats(const yolo_engine& e) {
+    return static_cast<size_t>(e.engine.getOutputRows()) * e.engine.getOutputCols();
+}
+
+int32_t copyDetections(const vector<Detection>& found, yolo_detection* out, int32_t capacity) {
+    int32_t n = min<int32_t>(capacity, static_cast<int32_t>(found.size()));
+    for (int32_t i = 0; i < n; i++) {
+        const Detection& d = found[i];
+        out[i] = {{d.box.x, d.box.y, d.box.width, d.box.height}, d.conf, d.cls};
+    }
+    return static_cast<int32_t>(found.size());
+}
+
+yolo_letterbox toC(const LetterboxTransform& t) {
+    return {t.scale, t.padding.x, t.padding.y, t.source_size.width, t.source_size.height};
+}
+
+LetterboxTransform fromC(const yolo_letterbox& l) {
+    LetterboxTransform t;
+    t.scale = l.scale;
+    t.padding = cv::Point(l.pad_x, l.pad_y);
+    t.source_size = cv::Size(l.source_width, l.source_height);
+    return t;
+}
+
+// Preprocesses n frames into the engine's blob, runs them and decodes each
+// frame's predictions into its slice of the caller's buffers.
+yolo_status detectFrames(yolo_engine& e, const yolo_image* images, int32_t n,
+                         yolo_detection* detections, int32_t capacity, int32_t* counts) {
+    if (n <= 0 || !images || !counts || capacity < 0 || (capacity > 0 && !detections)) {
+        return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_detect: null buffer or bad count");
+    }
+    for (int32_t i = 0; i < n; i++) {
+        if (!validImage(&images[i])) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_detect: image " + to_string(i) + " is empty or its stride is too small");
+        }
+    }
+
+    const size_t per_image = blobFloats(e);
+    e.blob.resize(max(e.blob.size(), per_image * n));
+    e.letterboxes.resize(n);
+    for (int32_t i = 0; i < n; i++) {
+        e.preprocessor->processInto(view(images[i]), e.blob.data() + per_image * i, e.letterboxes[i]);
+    }
+
+    vector<cv::Mat> predictions;
+    if (e.engine.hasFixedOutput()) {
+        const size_t per_result = predictionFloats(e);
+        e.predictions.resize(max(e.predictions.size(), per_result * n));
+        if (!e.engine.inferInto(e.blob.data(), n, e.predictions.data())) {
+            return fail(YOLO_ERROR_INFERENCE, "yolo_detect: inference failed");
+        }
+        for (int32_t i = 0; i < n; i++) {
+            predictions.emplace_back(e.engine.getOutputRows(), e.engine.getOutputCols(), CV_32F,
+                                     e.predictions.data() + per_result * i);
+        }
+    } else {
+        // Output shape only known after the run; ONNX Runtime allocates it.
+        cv::Mat blob(static_cast<int>(per_image * n), 1, CV_32F, e.blob.data());
+        predictions = e.engine.inferBatch(blob, n);
+        if (predictions.size() != static_cast<size_t>(n)) {
+            return fail(YOLO_ERROR_INFERENCE, "yolo_detect: inference failed");
+        }
+    }
+
+    for (int32_t i = 0; i < n; i++) {
+        vector<Detection> found = postprocess(predictions[i], e.letterboxes[i], e.options.conf_threshold,
+                                              e.options.nms_threshold, e.pool.get());
+        counts[i] = copyDetections(found, detections + static_cast<size_t>(capacity) * i, capacity);
+    }
+    return YOLO_OK;
+}
+}
+
+extern "C" {
+
+int32_t yolo_abi_version(void) {
+    return YOLO_ABI_VERSION;
+}
+
+const char* yolo_last_error(void) {
+    return last_error.c_str();
+}
+
+void yolo_engine_default_options(yolo_engine_options* options) {
+    if (!options) return;
+    options->struct_size = sizeof(yolo_engine_options);
+    options->conf_threshold = 0.25f;
+    options->nms_threshold = 0.45f;
+    options->cpu_threads = 0;
+}
+
+yolo_status yolo_engine_create(const char* model_path, const yolo_engine_options* options, yolo_engine** engine) {
+    return guarded([&] {
+        if (!model_path || !engine) return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_engine_create: null argument");
+        *engine = nullptr;
+        auto e = make_unique<yolo_engine>();
+        yolo_engine_default_options(&e->options);
+        if (!readOptions(options, e->options, kEngineOptionsV2)) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_engine_create: options.struct_size not set; "
+                                                     "start from yolo_engine_default_options()");
+        }
+        if (!e->engine.loadModel(model_path)) {
+            return fail(YOLO_ERROR_MODEL, string("cannot load model: ") + model_path);
+        }
+        if (e->options.cpu_threads > 0) e->pool = make_unique<WorkStealingPool>(e->options.cpu_threads);
+        e->preprocessor = make_unique<Preprocessor>(e->engine.getInputWidth(), e->engine.getInputHeight(),
+                                                    e->pool.get());
+        *engine = e.release();
+        return YOLO_OK;
+    });
+}
+
+void yolo_engine_destroy(yolo_engine* engine) {
+    delete engine;
+}
+
+void yolo_engine_input_size(const yolo_engine* engine, int32_t* width, int32_t* height) {
+    if (!engine) return;
+    if (width) *width = engine->engine.getInputWidth();
+    if (height) *height = engine->engine.getInputHeight();
+}
+
+size_t yolo_engine_blob_floats(const yolo_engine* engine) {
+    return engine ? blobFloats(*engine) : 0;
+}
+
+size_t yolo_engine_prediction_floats(const yolo_engine* engine, int32_t* rows, int32_t* cols) {
+    if (!engine) return 0;
+    if (rows) *rows = engine->engine.getOutputRows();
+    if (cols) *cols = engine->engine.getOutputCols();
+    return predictionFloats(*engine);
+}
+
+yolo_status yolo_detect(yolo_engine* engine, const yolo_image* image,
+                        yolo_detection* detections, int32_t capacity, int32_t* count) {
+    return guarded([&] {
+        if (!engine) return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_detect: null engine");
+        return detectFrames(*engine, image, 1, detections, capacity, count);
+    });
+}
+
+yolo_status yolo_detect_batch(yolo_engine* engine, const yolo_image* images, int32_t n,
+                              yolo_detection* detections, int32_t capacity, int32_t* counts) {
+    return guarded([&] {
+        if (!engine) return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_detect_batch: null engine");
+        return detectFrames(*engine, images, n, detections, capacity, counts);
+    });
+}
+
+yolo_status yolo_preprocess(const yolo_engine* engine, const yolo_image* image, float* blob,
+                            yolo_letterbox* letterbox) {
+    return guarded([&] {
+        if (!engine || !blob || !letterbox || !validImage(image)) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_preprocess: null argument, empty image or bad stride");
+        }
+        LetterboxTransform transform;
+        engine->preprocessor->processInto(view(*image), blob, transform);
+        *letterbox = toC(transform);
+        return YOLO_OK;
+    });
+}
+
+yolo_status yolo_infer(yolo_engine* engine, const float* blob, int32_t batch, float* predictions) {
+    return guarded([&] {
+        if (!engine || !blob || !predictions || batch <= 0) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_infer: null buffer or bad batch");
+        }
+        if (!engine->engine.hasFixedOutput()) {
+            return fail(YOLO_ERROR_INFERENCE, "yolo_infer: the model's output shape is dynamic; use yolo_detect");
+        }
+        if (!engine->engine.inferInto(blob, batch, predictions)) {
+            return fail(YOLO_ERROR_INFERENCE, "yolo_infer: inference failed");
+        }
+        return YOLO_OK;
+    });
+}
+
+yolo_status yolo_postprocess(const yolo_engine* engine, const float* predictions, const yolo_letterbox* letterbox,
+                             yolo_detection* detections, int32_t capacity, int32_t* count) {
+    return guarded([&] {
+        if (!engine || !predictions || !letterbox || !count || capacity < 0 || (capacity > 0 && !detections)) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_postprocess: null argument");
+        }
+        if (!engine->engine.hasFixedOutput()) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_postprocess: the model's output shape is dynamic");
+        }
+        cv::Mat view(engine->engine.getOutputRows(), engine->engine.getOutputCols(), CV_32F,
+                     const_cast<float*>(predictions));
+        vector<Detection> found = postprocess(view, fromC(*letterbox), engine->options.conf_threshold,
+                                              engine->options.nms_threshold, engine->pool.get());
+        *count = copyDetections(found, detections, capacity);
+        return YOLO_OK;
+    });
+}
+
+void yolo_tracker_default_options(yolo_tracker_options* options) {
+    if (!options) return;
+    TrackerConfig defaults;
+    options->struct_size = sizeof(yolo_tracker_options);
+    static const vector<int32_t> classes(defaults.allowed_classes.begin(), defaults.allowed_classes.end());
+    options->classes = classes.data();
+    options->class_count = static_cast<int32_t>(classes.size());
+    options->alpha = defaults.alpha;
+    options->match_iou = defaults.match_iou;
+    options->enter_conf = defaults.enter_conf;
+    options->keep_conf = defaults.keep_conf;
+    options->grace_lost = defaults.grace_lost;
+    options->match = defaults.match == TrackMatch::Greedy ? YOLO_TRACK_MATCH_GREEDY : YOLO_TRACK_MATCH_OPTIMAL;
+    options->low_conf = defaults.low_conf;
+}
+
+yolo_status yolo_tracker_create(const yolo_tracker_options* options, yolo_tracker** tracker) {
+    return guarded([&] {
+        if (!tracker) return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_tracker_create: null argument");
+        *tracker = nullptr;
+        yolo_tracker_options o;
+        yolo_tracker_default_options(&o);
+        if (!readOptions(options, o, kTrackerOptionsV2)) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_tracker_create: options.struct_size not set; "
+                                                     "start from yolo_tracker_default_options()");
+        }
+        if (o.match != YOLO_TRACK_MATCH_OPTIMAL && o.match != YOLO_TRACK_MATCH_GREEDY) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_tracker_create: unknown options.match " + to_string(o.match));
+        }
+        TrackerConfig config;
+        config.match = o.match == YOLO_TRACK_MATCH_GREEDY ? TrackMatch::Greedy : TrackMatch::Optimal;
+        config.allowed_classes.assign(o.classes, o.classes ? o.classes + max(0, o.class_count) : o.classes);
+        config.alpha = o.alpha;
+        config.match_iou = o.match_iou;
+        config.enter_conf = o.enter_conf;
+        config.keep_conf = o.keep_conf;
+        config.grace_lost = o.grace_lost;
+        config.low_conf = o.low_conf;
+        *tracker = new yolo_tracker(config);
+        return YOLO_OK;
+    });
+}
+
+void yolo_tracker_destroy(yolo_tracker* tracker) {
+    delete tracker;
+}
+
+yolo_status yolo_tracker_update(yolo_tracker* tracker, const yolo_detection* detections, int32_t n,
+                                yolo_track* tracks, int32_t capacity, int32_t* count) {
+    return guarded([&] {
+        if (!tracker || !count || n < 0 || (n > 0 && !detections) || capacity < 0 || (capacity > 0 && !tracks)) {
+            return fail(YOLO_ERROR_INVALID_ARGUMENT, "yolo_tracker_update: null buffer or bad count");
+        }
+        tracker->detections.clear();
+        for (int32_t i = 0; i < n; i++) {
+            const yolo_detection& d = detections[i];
+            tracker->detections.push_back({cv::Rect2f(d.box.x, d.box.y, d.box.width, d.box.height), d.conf, d.cls});
+        }
+        // Includes tracks coasting through their grace period (lost > 0).
+        const vector<Track>& held = tracker->tracker.update(tracker->detections);
+        int32_t written = min<int32_t>(capacity, static_cast<int32_t>(held.size()));
+        for (int32_t i = 0; i < written; i++) {
+            const Track& t = held[i];
+            tracks[i] = {t.id, t.cls, t.age, t.lost, t.conf,
+                         {t.box.x, t.box.y, t.box.width, t.box.height},
+                         {t.smooth.x, t.smooth.y, t.smooth.width, t.smooth.height}};
+        }
+        *count = static_cast<int32_t>(held.size());
+        return YOLO_OK;
+    });
+}
+
+}
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include "../headers/batch_collector.h"
+
+using namespace std;
+using namespace std::chrono;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_full_batch_goes_out_without_waiting() {
+    BatchCollector<int> bc(16);
+    for (int i = 0; i < 4; ++i) bc.push(i);
+    vector<int> out;
+    auto start = steady_clock::now();
+    size_t n = bc.popBatch(out, 4, seconds(5));
+    auto waited = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    if (n != 4 || out.size() != 4) { LOG("took " << n); return false; }
+    if (waited > 1000) { LOG("waited " << waited << " ms for a full batch"); return false; }
+    return out[0] == 0 && out[3] == 3;
+}
+
+bool test_lone_item_waits_at_most_max_delay() {
+    BatchCollector<int> bc(16);
+    bc.push(7);
+    vector<int> out;
+    auto start = steady_clock::now();
+    size_t n = bc.popBatch(out, 8, milliseconds(30));
+    auto waited = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    if (n != 1 || out[0] != 7) { LOG("took " << n); return false; }
+    if (waited < 20 || waited > 1000) { LOG("waited " << waited << " ms"); return false; }
+    return true;
+}
+
+bool test_late_arrivals_join_the_open_batch() {
+    BatchCollector<int> bc(16);
+    bc.push(0);
+    thread pusher([&] {
+        this_thread::sleep_for(milliseconds(10));
+        bc.push(1);
+        bc.push(2);
+    });
+    vector<int> out;
+    size_t n = bc.popBatch(out, 3, milliseconds(2000));
+    pusher.join();
+    if (n != 3) LOG("took " << n);
+    return n == 3;
+}
+
+bool test_excess_items_stay_for_next_batch() {
+    BatchCollector<int> bc(16);
+    for (int i = 0; i < 5; ++i) bc.push(i);
+    vector<int> first, second;
+    bc.popBatch(first, 3, milliseconds(1));
+    bc.popBatch(second, 3, milliseconds(1));
+    if (first.size() != 3 || second.size() != 2) { LOG(first.size() << "," << second.size()); return false; }
+    return second[0] == 3 && second[1] == 4 && bc.size() == 0;
+}
+
+bool test_close_drains_then_returns_zero() {
+    BatchCollector<int> bc(16);
+    bc.push(1);
+    bc.close();
+    if (bc.push(2)) { LOG("push after close succeeded"); return false; }
+    vector<int> out;
+    // Closing releases the batch without waiting out the delay.
+    if (bc.popBatch(out, 4, seconds(10)) != 1) { LOG("queued item lost"); return false; }
+    return bc.popBatch(out, 4, seconds(10)) == 0;
+}
+
+bool test_many_producers_every_item_once() {
+    BatchCollector<int> bc(8);
+    const int producers = 4, per_producer = 500;
+    atomic<int> sum{0}, count{0};
+    vector<thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            for (int i = 0; i < per_producer; ++i) bc.push(p * per_producer + i);
+        });
+    }
+    thread consumer([&] {
+        vector<int> out;
+        while (bc.popBatch(out, 16, microseconds(200)) > 0) {
+            if (out.size() > 16) LOG("batch of " << out.size());
+            for (int v : out) { sum += v; count++; }
+            out.clear();
+        }
+    });
+    for (auto& t : threads) t.join();
+    bc.close();
+    consumer.join();
+    const int n = producers * per_producer;
+    if (count != n) LOG("count " << count.load());
+    return count == n && sum == n * (n - 1) / 2;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_full_batch_goes_out_without_waiting);
+    RUN_TEST(test_lone_item_waits_at_most_max_delay);
+    RUN_TEST(test_late_arrivals_join_the_open_batch);
+    RUN_TEST(test_excess_items_stay_for_next_batch);
+    RUN_TEST(test_close_drains_then_returns_zero);
+    RUN_TEST(test_many_producers_every_item_once);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
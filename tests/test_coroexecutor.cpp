@@ -0,0 +1,120 @@
+#include <iostream>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include "../headers/coro_executor.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+CoTask produce(CoQueue<int>& q, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!co_await q.push(i)) break;
+    }
+    q.close();
+}
+
+CoTask consume(CoQueue<int>& q, vector<int>& out) {
+    int v;
+    while (co_await q.pop(v)) out.push_back(v);
+}
+
+// ---------------- Tests ----------------
+
+bool test_items_arrive_in_order() {
+    CoExecutor ex(2);
+    CoQueue<int> q(ex, 2);
+    vector<int> got;
+    ex.spawn(consume(q, got));
+    ex.spawn(produce(q, 1000));
+    ex.wait();
+    if (got.size() != 1000) { LOG("received " << got.size()); return false; }
+    for (int i = 0; i < 1000; i++) {
+        if (got[i] != i) { LOG("item " << i << " is " << got[i]); return false; }
+    }
+    // Capacity 2 with 1000 items: the producer must have had to wait.
+    return q.pushSuspends() > 0 || q.popSuspends() > 0;
+}
+
+bool test_many_pipelines_share_few_threads() {
+    // 64 two-stage pipelines on 2 threads; blocking threads would deadlock.
+    const int pipelines = 64, items = 200;
+    CoExecutor ex(2);
+    vector<unique_ptr<CoQueue<int>>> queues;
+    vector<vector<int>> results(pipelines);
+    for (int p = 0; p < pipelines; p++) {
+        queues.push_back(make_unique<CoQueue<int>>(ex, 1));
+        ex.spawn(consume(*queues[p], results[p]));
+        ex.spawn(produce(*queues[p], items));
+    }
+    ex.wait();
+    for (const auto& r : results) {
+        if (r.size() != static_cast<size_t>(items)) { LOG("a pipeline got " << r.size()); return false; }
+    }
+    return ex.threads() == 2;
+}
+
+bool test_close_wakes_waiting_pop() {
+    CoExecutor ex(1);
+    CoQueue<int> q(ex, 4);
+    vector<int> got;
+    atomic<bool> finished{false};
+    ex.spawn([](CoQueue<int>& queue, atomic<bool>& done) -> CoTask {
+        int v;
+        bool ok = co_await queue.pop(v);
+        done = !ok;
+    }(q, finished));
+    if (ex.waitFor(0.05)) { LOG("pop on empty queue did not wait"); return false; }
+    q.close();
+    ex.wait();
+    return finished.load();
+}
+
+bool test_try_push_feeds_waiting_pop() {
+    CoExecutor ex(1);
+    CoQueue<int> q(ex, 1);
+    vector<int> got;
+    ex.spawn(consume(q, got));
+    ex.waitFor(0.02);
+    if (!q.tryPush(7) || !q.tryPush(8)) { LOG("tryPush rejected with room"); return false; }
+    ex.waitFor(0.02);
+    q.close();
+    ex.wait();
+    return got == vector<int>{7, 8};
+}
+
+bool test_exception_reaches_wait() {
+    CoExecutor ex(1);
+    ex.spawn([]() -> CoTask {
+        throw runtime_error("stage failed");
+        co_return;
+    }());
+    try {
+        ex.wait();
+    } catch (const runtime_error& e) {
+        return string(e.what()) == "stage failed";
+    }
+    LOG("exception was swallowed");
+    return false;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_items_arrive_in_order);
+    RUN_TEST(test_many_pipelines_share_few_threads);
+    RUN_TEST(test_close_wakes_waiting_pop);
+    RUN_TEST(test_try_push_feeds_waiting_pop);
+    RUN_TEST(test_exception_reaches_wait);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
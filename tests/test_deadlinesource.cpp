@@ -0,0 +1,78 @@
+#include <iostream>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include "../headers/deadline_source.h"
+#include "../headers/frame_queue.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// A frame captured `age_ms` ago.
+FrameEnvelope make_frame(int source, uint64_t seq, int age_ms) {
+    FrameEnvelope f(cv::Mat::zeros(8, 8, CV_8UC3), source, seq);
+    f.capture_time = FrameEnvelope::Clock::now() - chrono::milliseconds(age_ms);
+    return f;
+}
+
+// ---------------- Tests ----------------
+
+bool test_stale_frames_are_skipped() {
+    FrameQueue fq(8);
+    fq.push(make_frame(0, 0, 500));
+    fq.push(make_frame(0, 1, 400));
+    fq.push(make_frame(0, 2, 0));
+    fq.close();
+
+    DeadlineSource ds(fq, 1, 100.0);
+    FrameEnvelope f;
+    if (!ds.pop(f)) { LOG("fresh frame not returned"); return false; }
+    if (f.seq != 2) { LOG("returned seq " << f.seq); return false; }
+    if (ds.pop(f)) { LOG("pop after drain returned a frame"); return false; }
+    return ds.dropped(0) == 2 && ds.passed(0) == 1;
+}
+
+bool test_slo_is_per_stream() {
+    FrameQueue fq(8);
+    fq.push(make_frame(0, 0, 300));
+    fq.push(make_frame(1, 0, 300));
+    fq.close();
+
+    DeadlineSource ds(fq, 2, 100.0);
+    ds.setStreamSlo(1, 1000.0);
+    FrameEnvelope f;
+    bool got = ds.pop(f);
+    if (!got || f.source_id != 1) { LOG("expected only the lenient stream to pass"); return false; }
+    return ds.dropped(0) == 1 && ds.passed(1) == 1;
+}
+
+bool test_disabled_slo_passes_everything() {
+    FrameQueue fq(8);
+    fq.push(make_frame(0, 0, 10000));
+    fq.push(make_frame(5, 0, 10000));  // unknown stream
+    fq.close();
+
+    DeadlineSource ds(fq, 1, 0.0);
+    FrameEnvelope f;
+    int n = 0;
+    while (ds.pop(f)) n++;
+    return n == 2 && ds.dropped(0) == 0;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_stale_frames_are_skipped);
+    RUN_TEST(test_slo_is_per_stream);
+    RUN_TEST(test_disabled_slo_passes_everything);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -135,6 +135,81 @@ bool test_zero_max_size_behaviour() {
     return (!pushed) && (!popped) && fq.empty();
 }
 
+bool test_stats_counts_and_occupancy() {
+    FrameQueue fq(4);
+    auto frames = generate_dummy_frames(3, 64, 48);
+    for (auto &f : frames) fq.push(f);
+    cv::Mat tmp;
+    fq.pop(tmp);
+
+    QueueStatsSnapshot s = fq.stats();
+    if (s.pushed != 3 || s.popped != 1) { LOG("unexpected counts pushed=" << s.pushed << " popped=" << s.popped); return false; }
+    if (s.size != 2 || s.capacity != 4) { LOG("unexpected size " << s.size << "/" << s.capacity); return false; }
+    // occupancy is sampled before each push: 0, 1, 2
+    if (s.occupancy.count != 3 || s.occupancy.max != 2 || s.occupancy.sum != 3) { LOG("unexpected occupancy histogram"); return false; }
+    if (s.push_blocked != 0 || s.pop_blocked != 0) { LOG("no operation should have blocked"); return false; }
+
+    fq.close();
+    fq.push(frames[0]);
+    return fq.stats().dropped == 1;
+}
+
+bool test_stats_records_pop_wait() {
+    FrameQueue fq(2);
+    thread delayed([&] {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        fq.push(cv::Mat::zeros(8, 8, CV_8UC3));
+    });
+    cv::Mat tmp;
+    bool ok = fq.pop(tmp);
+    delayed.join();
+
+    QueueStatsSnapshot s = fq.stats();
+    if (!ok || s.pop_blocked != 1) { LOG("pop should have blocked once"); return false; }
+    if (s.pop_wait_us.max < 10000) { LOG("pop wait too small: " << s.pop_wait_us.max << "us"); return false; }
+    if (s.bottleneck() != "producer-bound") { LOG("unexpected verdict " << s.bottleneck()); return false; }
+
+    fq.resetStats();
+    return fq.stats().popped == 0;
+}
+
+bool test_spin_strategy_stress_and_shutdown() {
+    FrameQueue fq(4, WaitStrategy::SpinThenPark);
+    atomic<int> processed{0};
+    auto frames = generate_dummy_frames(200, 32, 24);
+
+    thread c1(threaded_consumer, ref(fq), ref(processed));
+    thread c2(threaded_consumer, ref(fq), ref(processed));
+    thread p1(threaded_producer, ref(fq), cref(frames));
+    thread p2(threaded_producer, ref(fq), cref(frames));
+    p1.join();
+    p2.join();
+
+    // Let consumers drain before closing so every frame is accounted for.
+    while (!fq.empty()) this_thread::sleep_for(chrono::milliseconds(1));
+    fq.close();
+    c1.join();
+    c2.join();
+
+    if (processed != 400) LOG("Processed count invalid: " << processed);
+    return processed == 400;
+}
+
+bool test_spin_strategy_close_wakes_blocked_pop() {
+    FrameQueue fq(2, WaitStrategy::SpinThenPark);
+    atomic<bool> returned{false};
+    thread waiter([&] {
+        cv::Mat tmp;
+        fq.pop(tmp);
+        returned = true;
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    bool early = returned.load();
+    fq.close();
+    waiter.join();
+    return !early && returned;
+}
+
 int main() {
     int passed = 0, total = 0;
     RUN_TEST(test_push_pop_basic);
@@ -143,6 +218,10 @@ int main() {
     RUN_TEST(test_repeated_push_pop);
     RUN_TEST(test_thread_safety_stress_and_shutdown);
     RUN_TEST(test_zero_max_size_behaviour);
+    RUN_TEST(test_stats_counts_and_occupancy);
+    RUN_TEST(test_stats_records_pop_wait);
+    RUN_TEST(test_spin_strategy_stress_and_shutdown);
+    RUN_TEST(test_spin_strategy_close_wakes_blocked_pop);
 
     cout << "----------------------------------------\n";
     cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
@@ -0,0 +1,113 @@
+#include <iostream>
+#include "../headers/frame_skip.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_stride_rises_when_behind() {
+    // 50 ms per inferred frame, skipped ones free: 20 fps per inference.
+    int k = FrameSkipController::chooseStride(55.0, 50.0, 0.0, 1, 1, 8, 0.2);
+    if (k != 3) { LOG("expected stride 3 for 55 fps, got " << k); return false; }
+    // Capped by max_stride.
+    k = FrameSkipController::chooseStride(600.0, 50.0, 0.0, 1, 1, 8, 0.2);
+    if (k != 8) { LOG("expected stride capped at 8, got " << k); return false; }
+    // Parallel workers add capacity.
+    k = FrameSkipController::chooseStride(55.0, 50.0, 0.0, 3, 1, 8, 0.2);
+    return k == 1;
+}
+
+bool test_stride_falls_with_hysteresis() {
+    // At stride 2, 25 ms/inference could just do 40 fps at stride 1, but with
+    // 20% hysteresis 30 fps is still too close.
+    int k = FrameSkipController::chooseStride(36.0, 25.0, 0.0, 1, 2, 8, 0.2);
+    if (k != 2) { LOG("lowered without headroom: " << k); return false; }
+    k = FrameSkipController::chooseStride(30.0, 25.0, 0.0, 1, 2, 8, 0.2);
+    if (k != 1) { LOG("did not lower with headroom: " << k); return false; }
+    // Lowers one step at a time.
+    k = FrameSkipController::chooseStride(10.0, 25.0, 0.0, 1, 6, 8, 0.2);
+    return k == 5;
+}
+
+bool test_skipped_frame_cost_counts() {
+    // Skipped frames that still cost 10 ms (drawing, display) limit how
+    // much a larger stride helps: 40 fps needs k=3 rather than k=2.
+    double cap2 = FrameSkipController::capacityFps(2, 50.0, 10.0, 1);
+    if (cap2 >= 40.0) { LOG("capacity at k=2: " << cap2); return false; }
+    int k = FrameSkipController::chooseStride(40.0, 50.0, 10.0, 1, 1, 8, 0.2);
+    return k == 3;
+}
+
+bool test_should_infer_follows_stride_per_stream() {
+    FrameSkipConfig config;
+    config.max_stride = 4;
+    config.target_fps = 30.0;
+    config.update_interval_sec = 0.0;
+    FrameSkipController skip(config, 2);
+    // 100 ms per inference against 60 fps of demand: stride goes to 4.
+    skip.recordFrame(true, 100.0);
+    if (skip.stride() != 4) { LOG("stride " << skip.stride()); return false; }
+
+    int inferred0 = 0, inferred1 = 0;
+    for (int i = 0; i < 8; i++) {
+        if (skip.shouldInfer(0, 30.0)) inferred0++;
+        if (i % 2 == 0 && skip.shouldInfer(1, 30.0)) inferred1++;
+    }
+    if (inferred0 != 2 || inferred1 != 1) {
+        LOG("inferred " << inferred0 << " / " << inferred1);
+        return false;
+    }
+    return skip.inferred() == 3 && skip.skipped() == 9;
+}
+
+bool test_first_frame_is_inferred() {
+    FrameSkipConfig config;
+    config.max_stride = 4;
+    FrameSkipController skip(config);
+    return skip.shouldInfer(0, 0.0);
+}
+
+bool test_producer_decision_is_kept() {
+    FrameSkipConfig config;
+    config.max_stride = 4;
+    config.update_interval_sec = 0.0;
+    FrameSkipController skip(config);
+    skip.recordFrame(true, 1000.0);  // far behind: stride 4
+
+    FrameEnvelope run, skipped, undecided;
+    run.inference = FrameEnvelope::Inference::Run;
+    skipped.inference = FrameEnvelope::Inference::Skip;
+    // The producer already counted these; asking again must not advance the stride.
+    for (int i = 0; i < 3; i++) {
+        if (!skip.shouldInfer(run)) { LOG("a Run frame was skipped"); return false; }
+        if (skip.shouldInfer(skipped)) { LOG("a Skip frame was inferred"); return false; }
+    }
+    if (skip.inferred() != 0 || skip.skipped() != 0) {
+        LOG("decided frames counted: " << skip.inferred() << " / " << skip.skipped());
+        return false;
+    }
+    return skip.shouldInfer(undecided) && !skip.shouldInfer(undecided) && skip.inferred() == 1;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_stride_rises_when_behind);
+    RUN_TEST(test_stride_falls_with_hysteresis);
+    RUN_TEST(test_skipped_frame_cost_counts);
+    RUN_TEST(test_should_infer_follows_stride_per_stream);
+    RUN_TEST(test_first_frame_is_inferred);
+    RUN_TEST(test_producer_decision_is_kept);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
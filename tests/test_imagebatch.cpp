@@ -0,0 +1,193 @@
+#include <iostream>
+#include <cmath>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include "../headers/bounded_queue.h"
+#include "../headers/preprocess.h"
+
+using namespace std;
+using namespace std::chrono;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- BoundedQueue::popUpTo ----------------
+
+bool test_pop_up_to_respects_max() {
+    BoundedQueue<int> q(16);
+    for (int i = 0; i < 5; ++i) q.push(i);
+    vector<int> out;
+    size_t n = q.popUpTo(out, 3);
+    if (n != 3 || out != vector<int>{0, 1, 2}) { LOG("first batch took " << n); return false; }
+    // Appends to what the caller already holds.
+    n = q.popUpTo(out, 3);
+    if (n != 2 || out != vector<int>{0, 1, 2, 3, 4}) { LOG("second batch took " << n); return false; }
+    return q.size() == 0;
+}
+
+bool test_pop_up_to_does_not_wait_to_fill() {
+    BoundedQueue<int> q(16);
+    thread producer([&] {
+        this_thread::sleep_for(milliseconds(50));
+        q.push(7);
+    });
+    vector<int> out;
+    size_t n = q.popUpTo(out, 8);
+    producer.join();
+    if (n != 1 || out != vector<int>{7}) { LOG("took " << n << " after blocking"); return false; }
+    return true;
+}
+
+bool test_pop_up_to_partial_batch_at_close() {
+    BoundedQueue<int> q(16);
+    thread producer([&] {
+        q.push(1);
+        q.push(2);
+        q.close();
+    });
+    producer.join();
+    vector<int> out;
+    size_t n = q.popUpTo(out, 4);
+    if (n != 2 || out != vector<int>{1, 2}) { LOG("partial batch took " << n); return false; }
+    auto start = steady_clock::now();
+    n = q.popUpTo(out, 4);
+    auto waited = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    if (n != 0 || out.size() != 2) { LOG("drained queue gave " << n); return false; }
+    if (waited > 1000) { LOG("waited " << waited << " ms on a closed queue"); return false; }
+    return true;
+}
+
+bool test_pop_up_to_wakes_on_close() {
+    BoundedQueue<int> q(16);
+    thread closer([&] {
+        this_thread::sleep_for(milliseconds(50));
+        q.close();
+    });
+    vector<int> out;
+    size_t n = q.popUpTo(out, 4);
+    closer.join();
+    return n == 0 && out.empty();
+}
+
+// ---------------- Preprocessor::processBatch ----------------
+
+static bool near(float a, float b) { return fabs(a - b) < 1e-5f; }
+
+static bool sameLetterbox(const LetterboxTransform& t, float scale, int pad_x, int pad_y, int src_w, int src_h) {
+    return near(t.scale, scale) && t.padding.x == pad_x && t.padding.y == pad_y &&
+           t.source_size.width == src_w && t.source_size.height == src_h;
+}
+
+// Reads one model-input pixel of the given slot back as (r, g, b).
+static void pixel(const cv::Mat& blob, size_t slot, int w, int h, int x, int y, float rgb[3]) {
+    size_t plane = static_cast<size_t>(w) * h;
+    const float* base = blob.ptr<float>() + slot * 3 * plane + static_cast<size_t>(y) * w + x;
+    for (int c = 0; c < 3; c++) rgb[c] = base[c * plane];
+}
+
+static bool expectPixel(const cv::Mat& blob, size_t slot, int x, int y, float r, float g, float b) {
+    float rgb[3];
+    pixel(blob, slot, 64, 64, x, y, rgb);
+    if (near(rgb[0], r) && near(rgb[1], g) && near(rgb[2], b)) return true;
+    LOG("slot " << slot << " (" << x << "," << y << ") = " << rgb[0] << "," << rgb[1] << "," << rgb[2]
+        << ", expected " << r << "," << g << "," << b);
+    return false;
+}
+
+bool test_process_batch_blob_size() {
+    Preprocessor prep(64, 48);
+    vector<FrameEnvelope> frames(3);
+    for (auto& f : frames) f.image = cv::Mat(30, 40, CV_8UC3, cv::Scalar(1, 2, 3));
+    vector<bool> ok;
+    cv::Mat blob = prep.processBatch(frames, ok);
+    size_t expected = 3 * static_cast<size_t>(3 * 64 * 48);
+    if (blob.depth() != CV_32F || blob.total() != expected) {
+        LOG("blob has " << blob.total() << " floats, expected " << expected);
+        return false;
+    }
+    if (ok != vector<bool>(3, true)) { LOG("a valid frame was reported as rejected"); return false; }
+    vector<FrameEnvelope> none;
+    return prep.processBatch(none, ok).total() == 0 && ok.empty();
+}
+
+bool test_process_batch_letterboxes_each_image() {
+    Preprocessor prep(64, 64);
+    const cv::Scalar bgr(51, 102, 153);
+    const float b = 51 / 255.0f, g = 102 / 255.0f, r = 153 / 255.0f;
+    vector<FrameEnvelope> frames(3);
+    frames[0].image = cv::Mat(32, 64, CV_8UC3, bgr);  // wide: bars top and bottom
+    frames[1].image = cv::Mat(32, 16, CV_8UC3, bgr);  // tall, upscaled: bars left and right
+    // frames[2] stays empty and must leave its slot zeroed.
+    vector<bool> processed;
+    cv::Mat blob = prep.processBatch(frames, processed);
+    if (processed != vector<bool>{true, true, false}) { LOG("wrong per-frame flags"); return false; }
+
+    const LetterboxTransform& wide = frames[0].letterbox;
+    if (!sameLetterbox(wide, 1.0f, 0, 16, 64, 32)) {
+        LOG("wide letterbox: scale " << wide.scale << " padding " << wide.padding.x << "," << wide.padding.y);
+        return false;
+    }
+    const LetterboxTransform& tall = frames[1].letterbox;
+    if (!sameLetterbox(tall, 2.0f, 16, 0, 16, 32)) {
+        LOG("tall letterbox: scale " << tall.scale << " padding " << tall.padding.x << "," << tall.padding.y);
+        return false;
+    }
+    if (frames[2].letterbox.source_size.area() != 0) { LOG("empty frame got a letterbox"); return false; }
+
+    bool ok = true;
+    ok &= expectPixel(blob, 0, 10, 15, 0, 0, 0);
+    ok &= expectPixel(blob, 0, 10, 16, r, g, b);  // channels swapped to RGB
+    ok &= expectPixel(blob, 0, 63, 47, r, g, b);
+    ok &= expectPixel(blob, 0, 10, 48, 0, 0, 0);
+    ok &= expectPixel(blob, 1, 15, 30, 0, 0, 0);
+    ok &= expectPixel(blob, 1, 16, 30, r, g, b);
+    ok &= expectPixel(blob, 1, 47, 63, r, g, b);
+    ok &= expectPixel(blob, 1, 48, 30, 0, 0, 0);
+    for (int y = 0; y < 64; y += 9) {
+        for (int x = 0; x < 64; x += 9) ok &= expectPixel(blob, 2, x, y, 0, 0, 0);
+    }
+    return ok;
+}
+
+bool test_process_batch_flags_rejected_frames() {
+    Preprocessor prep(64, 64);
+    vector<FrameEnvelope> frames(3);
+    frames[0].image = cv::Mat(32, 32, CV_8UC3, cv::Scalar(51, 102, 153));
+    frames[1].image = cv::Mat(32, 32, CV_32FC3);  // not a type the fused path reads
+    frames[2].image = cv::Mat(32, 32, CV_8UC3, cv::Scalar(51, 102, 153));
+    // A letterbox left over from an earlier use of the envelope.
+    frames[1].letterbox.scale = 3.0f;
+    frames[1].letterbox.source_size = cv::Size(10, 10);
+    vector<bool> ok;
+    cv::Mat blob = prep.processBatch(frames, ok);
+    if (ok != vector<bool>{true, false, true}) { LOG("the float frame was not flagged"); return false; }
+    if (!sameLetterbox(frames[1].letterbox, 1.0f, 0, 0, 0, 0)) { LOG("rejected frame kept a stale letterbox"); return false; }
+    bool zeroed = true;
+    for (int y = 0; y < 64; y += 7) {
+        for (int x = 0; x < 64; x += 7) zeroed &= expectPixel(blob, 1, x, y, 0, 0, 0);
+    }
+    return zeroed && expectPixel(blob, 2, 32, 32, 153 / 255.0f, 102 / 255.0f, 51 / 255.0f);
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_pop_up_to_respects_max);
+    RUN_TEST(test_pop_up_to_does_not_wait_to_fill);
+    RUN_TEST(test_pop_up_to_partial_batch_at_close);
+    RUN_TEST(test_pop_up_to_wakes_on_close);
+    RUN_TEST(test_process_batch_blob_size);
+    RUN_TEST(test_process_batch_letterboxes_each_image);
+    RUN_TEST(test_process_batch_flags_rejected_frames);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,184 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../headers/inference_server.h"
+#include "../headers/detect_protocol.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static string test_name(const string& suffix) {
+    return "yolo_server_test_" + to_string(getpid()) + "_" + suffix;
+}
+
+// A server without model sessions: requests are parsed and queued but never
+// answered, which is all these tests need.
+struct TestServer {
+    InferEnginePool engines;
+    InferenceServerConfig config;
+    unique_ptr<InferenceServer> server;
+    atomic<bool> running{true};
+    thread runner;
+
+    explicit TestServer(const string& name) {
+        config.socket_path = "/tmp/" + name + ".sock";
+        config.stats_interval_sec = 0;
+        server = make_unique<InferenceServer>(engines, config);
+        if (server->start()) runner = thread([this] { server->run(running); });
+    }
+    ~TestServer() {
+        running = false;
+        if (runner.joinable()) runner.join();
+    }
+    bool started() const { return runner.joinable(); }
+};
+
+// Waits up to timeout_ms for a reply on fd; false if none came.
+static bool readReply(int fd, DetectResponse& response, int timeout_ms) {
+    pollfd pfd{fd, POLLIN, 0};
+    return ::poll(&pfd, 1, timeout_ms) > 0 && readFull(fd, &response, sizeof(response));
+}
+
+static DetectRequest shmRequest(uint32_t id, const string& shm_name, uint64_t offset) {
+    DetectRequest request;
+    request.id = id;
+    request.width = 2;
+    request.height = 2;
+    request.stride = 6;
+    request.payload = DetectPayload::SharedMemory;
+    request.shm_offset = offset;
+    snprintf(request.shm_name, sizeof(request.shm_name), "%s", shm_name.c_str());
+    return request;
+}
+
+// ---------------- Tests ----------------
+
+bool test_finished_readers_are_reaped() {
+    TestServer t(test_name("reap"));
+    if (!t.started()) return false;
+    const int n = 200;
+    int connected = 0;
+    for (int i = 0; i < n; i++) {
+        int fd = connectDetectServer(t.config.socket_path);
+        if (fd >= 0) {
+            connected++;
+            ::close(fd);
+        }
+    }
+    // The accept loop reaps at least every poll timeout.
+    size_t left = t.server->readerThreads();
+    for (int i = 0; i < 50 && left > 0; i++) {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        left = t.server->readerThreads();
+    }
+    if (left != 0) LOG(left << " reader threads still held after " << connected << " connections closed");
+    return connected == n && left == 0;
+}
+
+bool test_unknown_payload_is_rejected() {
+    TestServer t(test_name("payload"));
+    if (!t.started()) return false;
+    int fd = connectDetectServer(t.config.socket_path);
+    if (fd < 0) return false;
+    DetectRequest request;
+    request.id = 9;
+    request.width = request.height = 2;
+    request.stride = 6;
+    request.payload = static_cast<DetectPayload>(7);
+    DetectResponse response;
+    bool ok = writeFull(fd, &request, sizeof(request)) && readReply(fd, response, 1000);
+    bool rejected = ok && response.id == 9 && response.status == DetectStatus::BadRequest;
+    ::close(fd);
+    if (!rejected) LOG("status " << static_cast<int>(response.status) << " for payload kind 7");
+    return rejected;
+}
+
+bool test_oversized_inline_stride_is_rejected() {
+    TestServer t(test_name("stride"));
+    if (!t.started()) return false;
+    int fd = connectDetectServer(t.config.socket_path);
+    if (fd < 0) return false;
+    DetectRequest request;
+    request.id = 4;
+    request.width = request.height = 2;
+    request.stride = INT32_MAX;
+    DetectResponse response;
+    bool ok = writeFull(fd, &request, sizeof(request)) && readReply(fd, response, 1000);
+    bool rejected = ok && response.id == 4 && response.status == DetectStatus::BadRequest;
+
+    // The largest padding allowed is still read as a frame, not answered.
+    int ok_fd = connectDetectServer(t.config.socket_path);
+    DetectRequest padded;
+    padded.id = 5;
+    padded.width = padded.height = 2;
+    padded.stride = 6 + kDetectMaxRowPadding;
+    vector<uchar> pixels(2 * padded.stride);
+    bool accepted = ok_fd >= 0 && writeFull(ok_fd, &padded, sizeof(padded)) &&
+                    writeFull(ok_fd, pixels.data(), pixels.size()) && !readReply(ok_fd, response, 200);
+    ::close(fd);
+    if (ok_fd >= 0) ::close(ok_fd);
+    if (!rejected) LOG("status " << static_cast<int>(response.status) << " for a 2 GB stride");
+    if (!accepted) LOG("a frame with the maximum row padding was rejected");
+    return rejected && accepted;
+}
+
+// A client grows its segment after the server has mapped it; frames in the
+// new part must be read from a fresh mapping, not rejected or read past the
+// end of the old one.
+bool test_grown_segment_is_mapped_again() {
+    TestServer t(test_name("grow"));
+    if (!t.started()) return false;
+    string shm_name = "/" + test_name("segment");
+    int shm = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+    if (shm < 0 || ftruncate(shm, 64) != 0) return false;
+    int fd = connectDetectServer(t.config.socket_path);
+
+    DetectResponse response;
+    DetectRequest first = shmRequest(1, shm_name, 0);
+    bool first_accepted = fd >= 0 && writeFull(fd, &first, sizeof(first)) && !readReply(fd, response, 200);
+
+    DetectRequest beyond = shmRequest(2, shm_name, 1024);
+    bool rejected = writeFull(fd, &beyond, sizeof(beyond)) && readReply(fd, response, 1000) &&
+                    response.id == 2 && response.status == DetectStatus::SharedMemoryError;
+
+    bool grown = ftruncate(shm, 4096) == 0;
+    DetectRequest after = shmRequest(3, shm_name, 1024);
+    bool accepted = grown && writeFull(fd, &after, sizeof(after)) && !readReply(fd, response, 200);
+
+    if (fd >= 0) ::close(fd);
+    ::close(shm);
+    shm_unlink(shm_name.c_str());
+    if (!first_accepted) LOG("a frame inside the segment was rejected");
+    if (!rejected) LOG("a frame past the end of the segment was not rejected");
+    if (!accepted) LOG("a frame in the grown part was rejected, status " << static_cast<int>(response.status));
+    return first_accepted && rejected && accepted;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_finished_readers_are_reaped);
+    RUN_TEST(test_unknown_payload_is_rejected);
+    RUN_TEST(test_oversized_inline_stride_is_rejected);
+    RUN_TEST(test_grown_segment_is_mapped_again);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include "../headers/multi_lane_queue.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+FrameEnvelope make_frame(int source, uint64_t seq) {
+    return FrameEnvelope(cv::Mat::zeros(8, 8, CV_8UC3), source, seq);
+}
+
+// ---------------- Tests ----------------
+
+bool test_weighted_round_robin_order() {
+    MultiLaneQueue mq;
+    int slow = mq.addLane({16, DropPolicy::Block, 1});
+    int fast = mq.addLane({16, DropPolicy::Block, 3});
+    for (int i = 0; i < 8; ++i) {
+        mq.push(make_frame(slow, i));
+        mq.push(make_frame(fast, i));
+    }
+
+    // Each round serves one frame from the slow lane and three from the fast one.
+    vector<int> expected = {slow, fast, fast, fast, slow, fast, fast, fast};
+    for (size_t i = 0; i < expected.size(); ++i) {
+        FrameEnvelope f;
+        if (!mq.pop(f)) { LOG("pop failed"); return false; }
+        if (f.source_id != expected[i]) { LOG("pop " << i << " came from lane " << f.source_id); return false; }
+    }
+    return true;
+}
+
+bool test_busy_lane_does_not_starve_quiet_lane() {
+    MultiLaneQueue mq;
+    int busy = mq.addLane({32, DropPolicy::Block, 1});
+    int quiet = mq.addLane({32, DropPolicy::Block, 1});
+    for (int i = 0; i < 30; ++i) mq.push(make_frame(busy, i));
+    mq.push(make_frame(quiet, 0));
+
+    for (int i = 0; i < 2; ++i) {
+        FrameEnvelope f;
+        mq.pop(f);
+        if (f.source_id == quiet) return true;
+    }
+    LOG("quiet lane not served within two pops");
+    return false;
+}
+
+bool test_drop_oldest_keeps_latest() {
+    MultiLaneQueue mq;
+    int lane = mq.addLane({2, DropPolicy::DropOldest, 1});
+    for (int i = 0; i < 5; ++i) {
+        if (!mq.push(make_frame(lane, i))) { LOG("push rejected"); return false; }
+    }
+    FrameEnvelope a, b;
+    mq.pop(a);
+    mq.pop(b);
+    if (a.seq != 3 || b.seq != 4) { LOG("expected seq 3,4 got " << a.seq << "," << b.seq); return false; }
+    return mq.laneStats(lane).dropped == 3;
+}
+
+bool test_drop_newest_keeps_earliest() {
+    MultiLaneQueue mq;
+    int lane = mq.addLane({2, DropPolicy::DropNewest, 1});
+    for (int i = 0; i < 5; ++i) mq.push(make_frame(lane, i));
+    FrameEnvelope a, b;
+    mq.pop(a);
+    mq.pop(b);
+    if (a.seq != 0 || b.seq != 1) { LOG("expected seq 0,1 got " << a.seq << "," << b.seq); return false; }
+    auto s = mq.laneStats(lane);
+    return s.dropped == 3 && s.pushed == 2 && s.popped == 2;
+}
+
+bool test_full_drop_newest_lane_refuses_frames_ahead_of_push() {
+    MultiLaneQueue mq;
+    int newest = mq.addLane({1, DropPolicy::DropNewest, 1});
+    int oldest = mq.addLane({1, DropPolicy::DropOldest, 1});
+    LaneSink sink(mq, newest);
+    if (!sink.accepts()) { LOG("empty lane refuses frames"); return false; }
+    sink.push(make_frame(0, 0));
+    mq.push(make_frame(oldest, 0));
+    if (sink.accepts()) { LOG("full drop-newest lane still accepts"); return false; }
+    if (!mq.accepts(oldest)) { LOG("drop-oldest lane refuses frames"); return false; }
+    FrameEnvelope f;
+    while (mq.size() > 0 && mq.pop(f)) {}
+    return sink.accepts();
+}
+
+bool test_closes_when_all_lanes_closed() {
+    MultiLaneQueue mq;
+    int a = mq.addLane({4, DropPolicy::Block, 1});
+    int b = mq.addLane({4, DropPolicy::Block, 1});
+    mq.push(make_frame(a, 0));
+    mq.closeLane(a);
+    if (mq.isClosed()) { LOG("closed with a lane still open"); return false; }
+    if (mq.push(make_frame(a, 1))) { LOG("push into closed lane succeeded"); return false; }
+    mq.closeLane(b);
+
+    FrameEnvelope f;
+    if (!mq.pop(f)) { LOG("queued frame lost on close"); return false; }
+    return mq.isClosed() && !mq.pop(f);
+}
+
+bool test_threaded_lanes_deliver_everything() {
+    MultiLaneQueue mq;
+    const int lanes = 4, per_lane = 50;
+    for (int i = 0; i < lanes; ++i) mq.addLane({4, DropPolicy::Block, static_cast<unsigned>(i + 1)});
+
+    vector<thread> producers;
+    for (int l = 0; l < lanes; ++l) {
+        producers.emplace_back([&, l] {
+            for (int i = 0; i < per_lane; ++i) mq.push(make_frame(l, i));
+            mq.closeLane(l);
+        });
+    }
+
+    vector<uint64_t> next_seq(lanes, 0);
+    bool in_order = true;
+    int received = 0;
+    FrameEnvelope f;
+    while (mq.pop(f)) {
+        if (f.seq != next_seq[f.source_id]++) in_order = false;
+        received++;
+    }
+    for (auto& p : producers) p.join();
+
+    if (!in_order) LOG("frames reordered within a lane");
+    if (received != lanes * per_lane) LOG("received " << received);
+    return in_order && received == lanes * per_lane;
+}
+
+bool test_lane_sink_stamps_and_closes_its_lane() {
+    MultiLaneQueue mq;
+    int a = mq.addLane({4, DropPolicy::Block, 1});
+    int b = mq.addLane({4, DropPolicy::Block, 1});
+    LaneSink sink_a(mq, a), sink_b(mq, b);
+
+    // Producers push with source_id 0; the sink routes by lane.
+    sink_b.push(make_frame(0, 0));
+    sink_b.close();
+    if (mq.isClosed()) { LOG("closing one lane closed the queue"); return false; }
+    if (!sink_a.push(make_frame(0, 0))) { LOG("push to open lane failed"); return false; }
+    sink_a.close();
+
+    int seen_b = 0;
+    FrameEnvelope f;
+    while (mq.pop(f)) {
+        if (f.source_id == b) seen_b++;
+    }
+    if (seen_b != 1) LOG("frames routed to lane b: " << seen_b);
+    return seen_b == 1 && mq.isClosed();
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_weighted_round_robin_order);
+    RUN_TEST(test_busy_lane_does_not_starve_quiet_lane);
+    RUN_TEST(test_drop_oldest_keeps_latest);
+    RUN_TEST(test_drop_newest_keeps_earliest);
+    RUN_TEST(test_full_drop_newest_lane_refuses_frames_ahead_of_push);
+    RUN_TEST(test_closes_when_all_lanes_closed);
+    RUN_TEST(test_threaded_lanes_deliver_everything);
+    RUN_TEST(test_lane_sink_stamps_and_closes_its_lane);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
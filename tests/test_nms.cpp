@@ -1,5 +1,6 @@
 #include <iostream>
 #include <vector>
+#include <cmath>
 #include "../headers/nms.h"
 
 int main() {
@@ -41,6 +42,19 @@ int main() {
             cout << "[TEST4] " << (res.size() == 2 ? "PASS" : "FAIL") << "\n";
         }
 
+        // --- Test 5: Boxes are mapped back through the letterbox transform ---
+        {
+            cv::Mat preds(84, 1, CV_32F, cv::Scalar(0));
+            preds.at<float>(0,0) = 320; preds.at<float>(1,0) = 320; preds.at<float>(2,0) = 100; preds.at<float>(3,0) = 50; preds.at<float>(4,0) = 0.9f;
+            LetterboxTransform lb;
+            lb.scale = 0.5f; lb.padding = cv::Point(0, 140); lb.source_size = cv::Size(1280, 720);
+            auto res = postprocess(preds, lb, 0.5f, 0.5f);
+            bool ok = res.size() == 1 &&
+                      std::abs(res[0].box.x - 540) < 1e-3f && std::abs(res[0].box.y - 310) < 1e-3f &&
+                      std::abs(res[0].box.width - 200) < 1e-3f && std::abs(res[0].box.height - 100) < 1e-3f;
+            cout << "[TEST5] " << (ok ? "PASS" : "FAIL") << "\n";
+        }
+
     } catch (...) {
         cerr << "Error: test failed\n";
         return 1;
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include "../headers/offline.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+Track make_track(int id, float x, int cls = 2) {
+    Track t;
+    t.id = id;
+    t.box = cv::Rect2f(x, 10, 50, 50);
+    t.smooth = t.box;
+    t.conf = 0.9f;
+    t.cls = cls;
+    t.age = 5;
+    t.lost = 0;
+    return t;
+}
+
+FrameResult make_frame(int64_t frame, vector<Track> tracks) {
+    FrameResult f;
+    f.frame = frame;
+    f.tracks = std::move(tracks);
+    return f;
+}
+
+// ---------------- Tests ----------------
+
+bool test_plan_covers_every_frame_once() {
+    auto plan = planSegments(1003, 8);
+    if (plan.size() != 8) { LOG("got " << plan.size() << " segments"); return false; }
+    int64_t expected_begin = 0;
+    for (size_t i = 0; i < plan.size(); ++i) {
+        if (plan[i].index != static_cast<int>(i) || plan[i].begin != expected_begin || plan[i].end <= plan[i].begin) {
+            LOG("segment " << i << " = [" << plan[i].begin << ", " << plan[i].end << ")");
+            return false;
+        }
+        expected_begin = plan[i].end;
+    }
+    return expected_begin == 1003;
+}
+
+bool test_plan_never_makes_empty_segments() {
+    auto plan = planSegments(3, 16);
+    if (plan.size() != 3) { LOG("got " << plan.size() << " segments for 3 frames"); return false; }
+    return planSegments(0, 4).empty();
+}
+
+bool test_stitch_carries_ids_across_boundary() {
+    TrackStitcher stitcher;
+
+    SegmentResult first;
+    first.frames.push_back(make_frame(0, {make_track(1, 0), make_track(2, 200)}));
+    first.frames.push_back(make_frame(1, {make_track(1, 2), make_track(2, 202)}));
+    stitcher.stitch(first);
+    int a = first.frames[1].tracks[0].id, b = first.frames[1].tracks[1].id;
+
+    // The second segment numbers its tracks from 1 again, in a different order,
+    // and sees frame 1 during warm-up.
+    SegmentResult second;
+    second.handoff = make_frame(1, {make_track(1, 203), make_track(2, 3), make_track(3, 400)});
+    second.has_handoff = true;
+    second.frames.push_back(make_frame(2, {make_track(1, 205), make_track(2, 5), make_track(3, 402)}));
+    stitcher.stitch(second);
+
+    const auto& t = second.frames[0].tracks;
+    if (t[0].id != b || t[1].id != a) { LOG("ids " << t[0].id << "," << t[1].id << " expected " << b << "," << a); return false; }
+    if (t[2].id == a || t[2].id == b) { LOG("new track reused an id"); return false; }
+    return stitcher.tracksCarried() == 2 && stitcher.tracksCreated() == 3;
+}
+
+bool test_stitch_does_not_merge_different_classes() {
+    TrackStitcher stitcher;
+    SegmentResult first;
+    first.frames.push_back(make_frame(0, {make_track(1, 0, 2)}));
+    stitcher.stitch(first);
+
+    SegmentResult second;
+    second.handoff = make_frame(0, {make_track(1, 0, 7)});
+    second.has_handoff = true;
+    second.frames.push_back(make_frame(1, {make_track(1, 0, 7)}));
+    stitcher.stitch(second);
+    return second.frames[0].tracks[0].id != first.frames[0].tracks[0].id;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_plan_covers_every_frame_once);
+    RUN_TEST(test_plan_never_makes_empty_segments);
+    RUN_TEST(test_stitch_carries_ids_across_boundary);
+    RUN_TEST(test_stitch_does_not_merge_different_classes);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
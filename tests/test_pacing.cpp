@@ -0,0 +1,80 @@
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include "../headers/pacing.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_parse_modes() {
+    if (parsePacing("max").mode != PacingMode::Max) return false;
+    if (parsePacing("realtime").mode != PacingMode::Realtime) return false;
+    Pacing fixed = parsePacing("fixed=12.5");
+    if (fixed.mode != PacingMode::Fixed || fixed.fps != 12.5) { LOG("fixed parsed as " << toString(fixed)); return false; }
+    for (const char* bad : {"fast", "fixed=0", "fixed=-3", "fixed="}) {
+        try {
+            parsePacing(bad);
+            LOG("accepted " << bad);
+            return false;
+        } catch (const std::exception&) {
+        }
+    }
+    return true;
+}
+
+bool test_max_does_not_sleep() {
+    Pacer pacer(Pacing(), 30.0);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i) pacer.wait(i * 33.3);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    if (ms > 50) LOG("1000 unpaced frames took " << ms << " ms");
+    return ms <= 50 && pacer.targetFps() == 0;
+}
+
+bool test_fixed_rate_is_achieved() {
+    Pacer pacer(parsePacing("fixed=200"), 30.0);
+    for (int i = 0; i < 41; ++i) pacer.wait(-1);
+    double fps = pacer.achievedFps();
+    if (fps < 180 || fps > 205) LOG("achieved " << fps << " fps");
+    return fps >= 180 && fps <= 205;
+}
+
+bool test_realtime_follows_timestamps() {
+    // Timestamps 10 ms apart play at 100 fps whatever the nominal rate says.
+    Pacer pacer(parsePacing("realtime"), 25.0);
+    for (int i = 0; i < 21; ++i) pacer.wait(i * 10.0);
+    double fps = pacer.achievedFps();
+    if (fps < 90 || fps > 103) LOG("achieved " << fps << " fps");
+    return fps >= 90 && fps <= 103;
+}
+
+bool test_realtime_without_timestamps_uses_source_fps() {
+    Pacer pacer(parsePacing("realtime"), 100.0);
+    for (int i = 0; i < 21; ++i) pacer.wait(-1);
+    double fps = pacer.achievedFps();
+    if (fps < 90 || fps > 103) LOG("achieved " << fps << " fps");
+    return fps >= 90 && fps <= 103;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_parse_modes);
+    RUN_TEST(test_max_does_not_sleep);
+    RUN_TEST(test_fixed_rate_is_achieved);
+    RUN_TEST(test_realtime_follows_timestamps);
+    RUN_TEST(test_realtime_without_timestamps_uses_source_fps);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -40,6 +40,42 @@ CaseResult run_case(const std::string &name, int orig_w, int orig_h, int input_w
     }
 }
 
+// The fused path reads 8-bit BGR; grey and BGRA are converted first and
+// anything else is rejected rather than read as BGR bytes.
+CaseResult run_type_case(const std::string &name, int type, const cv::Scalar &fill, float r, float g, float b) {
+    try {
+        const int input = 64;
+        cv::Mat img(48, 64, type, fill);
+        Preprocessor prep(input, input);
+        LetterboxTransform transform;
+        cv::Mat blob = prep.process(img, transform);
+        assertMsg(!blob.empty(), name + ": The output blob should not be empty.");
+        const size_t plane = static_cast<size_t>(input) * input;
+        const float *px = blob.ptr<float>() + 32 * input + 32;
+        assertMsg(std::fabs(px[0] - r) < 1e-5f && std::fabs(px[plane] - g) < 1e-5f && std::fabs(px[2 * plane] - b) < 1e-5f,
+                  name + ": Expected the centre pixel to read back as RGB " + std::to_string(r) + "," +
+                  std::to_string(g) + "," + std::to_string(b));
+        return {name, true, "OK"};
+    } catch (const std::exception &ex) {
+        return {name, false, ex.what()};
+    }
+}
+
+CaseResult run_unsupported_type_case(const std::string &name, int type) {
+    try {
+        cv::Mat img(48, 64, type);
+        Preprocessor prep(64, 64);
+        LetterboxTransform transform;
+        assertMsg(prep.process(img, transform).empty(), name + ": Expected an empty blob for an unsupported type.");
+        std::vector<float> blob(3 * 64 * 64, -1.0f);
+        assertMsg(!prep.processInto(img, blob.data(), transform), name + ": processInto should reject the image.");
+        assertMsg(blob.front() == -1.0f && blob.back() == -1.0f, name + ": A rejected image should leave the blob alone.");
+        return {name, true, "OK"};
+    } catch (const std::exception &ex) {
+        return {name, false, ex.what()};
+    }
+}
+
 int main() {
     std::vector<std::tuple<std::string,int,int>> cases = {
         {"standard_640x480", 640, 480},
@@ -62,6 +98,20 @@ int main() {
         }
     }
 
+    std::vector<CaseResult> type_results = {
+        run_type_case("bgr_8uc3", CV_8UC3, cv::Scalar(51, 102, 153), 153 / 255.0f, 102 / 255.0f, 51 / 255.0f),
+        run_type_case("grey_8uc1", CV_8UC1, cv::Scalar(51), 51 / 255.0f, 51 / 255.0f, 51 / 255.0f),
+        run_type_case("bgra_8uc4", CV_8UC4, cv::Scalar(51, 102, 153, 255), 153 / 255.0f, 102 / 255.0f, 51 / 255.0f),
+        run_unsupported_type_case("float_32fc3", CV_32FC3),
+    };
+    for (auto &res : type_results) {
+        total++;
+        if (res.ok) {
+            std::cout << "[PASS] " << res.name << " : " << res.msg << std::endl;
+            passed++;
+        }
+    }
+
     std::cout << "\n=== Test Summary: " << passed << " / " << total << " passed ===" << std::endl;
     return (passed == total) ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include "../headers/reorder_buffer.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_releases_in_index_order() {
+    ReorderBuffer<int> rb(8);
+    for (uint64_t i : {3, 1, 0, 2, 4}) rb.push(i, static_cast<int>(i) * 10);
+    for (int expected = 0; expected < 5; ++expected) {
+        int v = -1;
+        if (!rb.pop(v)) { LOG("pop failed"); return false; }
+        if (v != expected * 10) { LOG("got " << v << " expected " << expected * 10); return false; }
+    }
+    return rb.held() == 0;
+}
+
+bool test_pop_waits_for_missing_index() {
+    ReorderBuffer<int> rb(8);
+    rb.push(1, 1);
+    atomic<bool> popped(false);
+    thread consumer([&] {
+        int v;
+        rb.pop(v);
+        popped = true;
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    bool early = popped.load();
+    rb.push(0, 0);
+    consumer.join();
+    if (early) LOG("pop returned before index 0 arrived");
+    return !early && popped.load();
+}
+
+bool test_admit_blocks_beyond_window() {
+    ReorderBuffer<int> rb(2);
+    if (!rb.admit(0) || !rb.admit(1)) { LOG("indices inside the window were blocked"); return false; }
+
+    atomic<bool> admitted(false);
+    thread worker([&] {
+        rb.admit(2);
+        admitted = true;
+    });
+    this_thread::sleep_for(chrono::milliseconds(50));
+    bool early = admitted.load();
+
+    rb.push(0, 0);
+    int v;
+    rb.pop(v);
+    worker.join();
+    if (early) LOG("index 2 admitted before index 0 was consumed");
+    return !early && admitted.load();
+}
+
+bool test_close_flushes_remaining_in_order() {
+    ReorderBuffer<int> rb(8);
+    rb.push(5, 5);
+    rb.push(3, 3);
+    rb.close();
+    int a = -1, b = -1, c = -1;
+    bool ok = rb.pop(a) && rb.pop(b) && !rb.pop(c);
+    if (!ok || a != 3 || b != 5) { LOG("got " << a << ", " << b); return false; }
+    return !rb.admit(100);
+}
+
+bool test_parallel_workers_reassemble_sequence() {
+    const int frames = 2000, workers = 4;
+    ReorderBuffer<uint64_t> rb(16);
+    atomic<uint64_t> next_index(0);
+    atomic<int> active(workers);
+
+    vector<thread> pool;
+    for (int w = 0; w < workers; ++w) {
+        pool.emplace_back([&, w] {
+            mt19937 rng(w);
+            for (;;) {
+                uint64_t i = next_index++;
+                if (i >= static_cast<uint64_t>(frames)) break;
+                if (!rb.admit(i)) break;
+                this_thread::sleep_for(chrono::microseconds(rng() % 200));
+                rb.push(i, i);
+            }
+            if (--active == 0) rb.close();
+        });
+    }
+
+    uint64_t expected = 0;
+    bool in_order = true;
+    size_t max_held = 0;
+    uint64_t v;
+    while (rb.pop(v)) {
+        if (v != expected) in_order = false;
+        expected++;
+        max_held = max(max_held, rb.held());
+    }
+    for (auto& t : pool) t.join();
+
+    if (!in_order) LOG("sequence reordered");
+    if (expected != static_cast<uint64_t>(frames)) LOG("received " << expected);
+    if (max_held > rb.window()) LOG("held " << max_held << " items with window " << rb.window());
+    return in_order && expected == static_cast<uint64_t>(frames) && max_held <= rb.window();
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_releases_in_index_order);
+    RUN_TEST(test_pop_waits_for_missing_index);
+    RUN_TEST(test_admit_blocks_beyond_window);
+    RUN_TEST(test_close_flushes_remaining_in_order);
+    RUN_TEST(test_parallel_workers_reassemble_sequence);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
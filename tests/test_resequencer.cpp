@@ -0,0 +1,97 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include "../headers/bounded_queue.h"
+#include "../headers/resequencer.h"
+
+using namespace std;
+using namespace std::chrono;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Resequencer ----------------
+
+bool test_releases_out_of_order_input_in_order() {
+    Resequencer<int> order;
+    vector<int> out;
+    auto emit = [&](int& v) { out.push_back(v); };
+    for (uint64_t i : {3, 1, 0, 2, 4}) order.add(i, static_cast<int>(i) * 10, emit);
+    if (out != vector<int>{0, 10, 20, 30, 40}) { LOG("emitted " << out.size() << " items out of order"); return false; }
+    return order.held() == 0 && order.next() == 5;
+}
+
+bool test_holds_until_gap_is_filled() {
+    Resequencer<int> order;
+    vector<int> out;
+    auto emit = [&](int& v) { out.push_back(v); };
+    order.add(0, 0, emit);
+    order.add(2, 2, emit);
+    order.add(3, 3, emit);
+    if (out != vector<int>{0} || order.held() != 2) { LOG("released past the gap at 1"); return false; }
+    order.add(1, 1, emit);
+    if (out != vector<int>{0, 1, 2, 3}) { LOG("filling the gap did not release the held items"); return false; }
+    return order.held() == 0;
+}
+
+bool test_flush_at_close_emits_held_in_order() {
+    Resequencer<int> order;
+    vector<int> out;
+    auto emit = [&](int& v) { out.push_back(v); };
+    order.add(5, 5, emit);
+    order.add(2, 2, emit);
+    order.add(0, 0, emit);
+    order.add(3, 3, emit);
+    // Index 1 never arrives, as when a frame is lost upstream.
+    order.flush(emit);
+    if (out != vector<int>{0, 2, 3, 5}) { LOG("flush emitted " << out.size() << " items"); return false; }
+    return order.held() == 0;
+}
+
+// ---------------- BoundedQueue hand-off ----------------
+
+bool test_bounded_queue_close_drains_then_fails() {
+    BoundedQueue<int> q(4);
+    for (int i = 0; i < 3; ++i) q.push(i);
+    q.close();
+    if (q.push(99)) { LOG("push accepted after close"); return false; }
+    vector<int> got;
+    int v;
+    while (q.pop(v)) got.push_back(v);
+    if (got != vector<int>{0, 1, 2}) { LOG("drained " << got.size() << " of 3 items"); return false; }
+    return q.isClosed() && q.size() == 0;
+}
+
+bool test_bounded_queue_close_wakes_blocked_push() {
+    BoundedQueue<int> q(1);
+    q.push(1);
+    bool pushed = true;
+    thread producer([&] { pushed = q.push(2); });
+    this_thread::sleep_for(milliseconds(50));
+    q.close();
+    producer.join();
+    int v = 0;
+    bool drained = q.pop(v) && v == 1 && !q.pop(v);
+    if (pushed) LOG("blocked push succeeded after close");
+    return !pushed && drained;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_releases_out_of_order_input_in_order);
+    RUN_TEST(test_holds_until_gap_is_filled);
+    RUN_TEST(test_flush_at_close_emits_held_in_order);
+    RUN_TEST(test_bounded_queue_close_drains_then_fails);
+    RUN_TEST(test_bounded_queue_close_wakes_blocked_push);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <chrono>
+#include "../headers/result_sink.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+FrameRecord make_result(int stream, uint64_t seq, int objects) {
+    FrameRecord r;
+    r.stream = stream;
+    r.seq = seq;
+    r.timestamp_ms = seq * 40.0;
+    for (int i = 0; i < objects; ++i) {
+        r.detections.push_back({cv::Rect2f(10.f * i, 20.f, 30.f, 40.f), 0.5f, 2});
+        Track t{};
+        t.id = i + 1; t.cls = 2; t.conf = 0.5f; t.age = 3; t.lost = 0;
+        t.box = t.smooth = cv::Rect2f(10.f * i, 20.f, 30.f, 40.f);
+        r.tracks.push_back(t);
+    }
+    return r;
+}
+
+string read_file(const string& path) {
+    ifstream in(path, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+size_t count_lines(const string& text) {
+    size_t n = 0;
+    for (char c : text) if (c == '\n') n++;
+    return n;
+}
+
+// ---------------- Tests ----------------
+
+bool test_json_line_format() {
+    string out;
+    appendJsonLine(out, make_result(1, 7, 1));
+    const string expected =
+        "{\"stream\":1,\"seq\":7,\"ts_ms\":280.00,\"inferred\":true,"
+        "\"detections\":[{\"cls\":2,\"conf\":0.500,\"box\":[0.0,20.0,30.0,40.0]}],"
+        "\"tracks\":[{\"id\":1,\"cls\":2,\"conf\":0.500,\"age\":3,\"lost\":0,\"box\":[0.0,20.0,30.0,40.0]}]}\n";
+    if (out != expected) { LOG("got " << out); return false; }
+    return true;
+}
+
+bool test_binary_record_layout() {
+    string out;
+    appendBinaryRecord(out, make_result(3, 9, 2));
+    uint32_t body = 0;
+    memcpy(&body, out.data(), 4);
+    if (out.size() != 4 + body) { LOG("size " << out.size() << " body " << body); return false; }
+    if (body != 29 + 2 * 24 + 2 * 36) { LOG("body " << body); return false; }
+    int32_t stream = 0; uint64_t seq = 0; uint32_t dets = 0, tracks = 0;
+    memcpy(&stream, out.data() + 4, 4);
+    memcpy(&seq, out.data() + 8, 8);
+    memcpy(&dets, out.data() + 25, 4);
+    memcpy(&tracks, out.data() + 29, 4);
+    float x = 0;
+    memcpy(&x, out.data() + 33 + 24, 4);  // second detection
+    return stream == 3 && seq == 9 && dets == 2 && tracks == 2 && x == 10.f;
+}
+
+bool test_sink_writes_every_record_on_close() {
+    const string path = "test_results.jsonl";
+    remove(path.c_str());
+    ResultSinkConfig config;
+    config.path = path;
+    config.drop_when_behind = false;
+    {
+        ResultSink sink(config);
+        for (int i = 0; i < 500; ++i) sink.write(make_result(0, i, 3));
+        sink.close();
+        if (sink.written() != 500 || sink.dropped() != 0) { LOG("written " << sink.written()); return false; }
+    }
+    string text = read_file(path);
+    remove(path.c_str());
+    if (count_lines(text) != 500) { LOG("lines " << count_lines(text)); return false; }
+    return text.rfind("{\"stream\":0,\"seq\":499,", text.size() - 1) != string::npos;
+}
+
+bool test_partial_buffer_is_flushed_after_interval() {
+    const string path = "test_results_flush.jsonl";
+    remove(path.c_str());
+    ResultSinkConfig config;
+    config.path = path;
+    config.flush_sec = 0.05;
+    ResultSink sink(config);
+    sink.write(make_result(0, 0, 1));
+    this_thread::sleep_for(chrono::milliseconds(300));
+    size_t lines = count_lines(read_file(path));
+    sink.close();
+    remove(path.c_str());
+    if (lines != 1) LOG("lines on disk before close: " << lines);
+    return lines == 1;
+}
+
+bool test_rotates_by_size_without_splitting_records() {
+    const string base = "test_results_rot.bin";
+    ResultSinkConfig config;
+    config.path = base;
+    config.format = ResultFormat::Binary;
+    config.rotate_bytes = 4096;
+    config.drop_when_behind = false;
+    int files = 0;
+    {
+        ResultSink sink(config);
+        for (int i = 0; i < 200; ++i) sink.write(make_result(0, i, 2));
+        sink.close();
+        files = sink.files();
+    }
+    if (files < 2) { LOG("files " << files); return false; }
+    uint64_t records = 0;
+    bool ok = true;
+    for (int f = 0; f < files; ++f) {
+        string path = ResultSink::rotatedPath(base, f);
+        string data = read_file(path);
+        remove(path.c_str());
+        if (data.size() < 8 || memcmp(data.data(), kBinaryMagic, 4) != 0) { LOG("bad header in " << path); ok = false; continue; }
+        size_t pos = 8;
+        while (pos + 4 <= data.size()) {
+            uint32_t body = 0;
+            memcpy(&body, data.data() + pos, 4);
+            pos += 4 + body;
+            records++;
+        }
+        if (pos != data.size()) { LOG("record split in " << path); ok = false; }
+    }
+    if (records != 200) LOG("records " << records);
+    return ok && records == 200;
+}
+
+bool test_rotated_path_keeps_extension() {
+    return ResultSink::rotatedPath("out/run.jsonl", 3) == "out/run_3.jsonl" &&
+           ResultSink::rotatedPath("dir.v2/results", 0) == "dir.v2/results_0";
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_json_line_format);
+    RUN_TEST(test_binary_record_layout);
+    RUN_TEST(test_sink_writes_every_record_on_close);
+    RUN_TEST(test_partial_buffer_is_flushed_after_interval);
+    RUN_TEST(test_rotates_by_size_without_splitting_records);
+    RUN_TEST(test_rotated_path_keeps_extension);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <opencv2/opencv.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../headers/shm_frame_queue.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static string test_name(const string& suffix) {
+    return "yolo_test_" + to_string(getpid()) + "_" + suffix;
+}
+
+static cv::Mat pattern_frame(int seed, int w = 64, int h = 48) {
+    cv::Mat frame(h, w, CV_8UC3);
+    for (int r = 0; r < h; ++r)
+        for (int c = 0; c < w * 3; ++c)
+            frame.ptr<uchar>(r)[c] = static_cast<uchar>((seed + r + c) & 0xFF);
+    return frame;
+}
+
+// Child process: attach as producer, push n frames, then either close or die.
+static void run_child_producer(const string& name, int n, bool crash) {
+    ShmFrameQueue q(name, ShmFrameQueue::Role::Producer, 4, 64 * 48 * 3);
+    for (int i = 0; i < n; ++i) {
+        if (!q.push(FrameEnvelope(pattern_frame(i), 3, static_cast<uint64_t>(i)))) _exit(2);
+    }
+    if (crash) _exit(0);  // skips the destructor, so the queue is never closed
+    q.close();
+    _exit(0);
+}
+
+// ---------------- Tests ----------------
+
+bool test_frames_cross_process_in_order() {
+    string name = test_name("order");
+    ShmFrameQueue::unlink(name);
+    ShmFrameQueue consumer(name, ShmFrameQueue::Role::Consumer, 4, 64 * 48 * 3);
+
+    const int n = 50;
+    pid_t pid = fork();
+    if (pid == 0) run_child_producer(name, n, false);
+
+    int received = 0;
+    bool intact = true;
+    FrameEnvelope f;
+    while (consumer.pop(f)) {
+        if (f.seq != static_cast<uint64_t>(received) || f.source_id != 3) intact = false;
+        cv::Mat expected = pattern_frame(received);
+        if (f.image.rows != 48 || f.image.cols != 64 ||
+            memcmp(f.image.data, expected.data, 64 * 48 * 3) != 0) intact = false;
+        received++;
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if (received != n) LOG("received " << received << " of " << n);
+    if (!intact) LOG("frame contents or metadata corrupted");
+    return received == n && intact && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool test_producer_crash_unblocks_consumer() {
+    string name = test_name("crash");
+    ShmFrameQueue::unlink(name);
+    ShmFrameQueue consumer(name, ShmFrameQueue::Role::Consumer, 4, 64 * 48 * 3);
+
+    pid_t pid = fork();
+    if (pid == 0) run_child_producer(name, 2, true);
+    waitpid(pid, nullptr, 0);
+
+    auto start = chrono::steady_clock::now();
+    int received = 0;
+    FrameEnvelope f;
+    while (consumer.pop(f)) received++;
+    auto waited = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    consumer.close();  // a crash leaves the segment for re-attaching; this run is over
+
+    if (received != 2) LOG("received " << received << " frames queued before the crash");
+    if (waited > 2000) LOG("consumer took " << waited << "ms to notice the crash");
+    return received == 2 && waited <= 2000;
+}
+
+bool test_restarted_producer_reattaches() {
+    string name = test_name("reattach");
+    ShmFrameQueue::unlink(name);
+    ShmFrameQueue consumer(name, ShmFrameQueue::Role::Consumer, 4, 64 * 48 * 3);
+    consumer.setReattachTimeout(5000);
+
+    pid_t first = fork();
+    if (first == 0) run_child_producer(name, 2, true);
+    waitpid(first, nullptr, 0);
+
+    int received = 0;
+    FrameEnvelope f;
+    while (received < 2 && consumer.pop(f)) received++;
+    // The consumer is now waiting on a dead producer; a new one takes over.
+    pid_t second = fork();
+    if (second == 0) run_child_producer(name, 3, false);
+    bool fresh_numbering = true;
+    while (consumer.pop(f)) {
+        if (f.seq != static_cast<uint64_t>(received - 2)) fresh_numbering = false;
+        received++;
+    }
+    int status = 0;
+    waitpid(second, &status, 0);
+
+    if (received != 5) LOG("received " << received << " of 2 + 3 frames across the restart");
+    if (!fresh_numbering) LOG("frames from the restarted producer out of order");
+    return received == 5 && fresh_numbering && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static bool segment_exists(const string& name) {
+    int fd = shm_open(("/" + name).c_str(), O_RDWR, 0600);
+    if (fd < 0) return false;
+    ::close(fd);
+    return true;
+}
+
+bool test_segment_kept_until_orderly_close() {
+    string name = test_name("lifetime");
+    ShmFrameQueue::unlink(name);
+    {
+        // Never closed: as if the peer died and nobody re-attached in time.
+        ShmFrameQueue consumer(name, ShmFrameQueue::Role::Consumer, 2, 16);
+    }
+    bool kept = segment_exists(name);
+    bool reused = false, removed = false;
+    {
+        ShmFrameQueue consumer(name, ShmFrameQueue::Role::Consumer, 2, 16);
+        reused = !consumer.isClosed();  // the stale close was reset on attach
+        consumer.close();
+    }
+    removed = !segment_exists(name);
+    ShmFrameQueue::unlink(name);
+
+    if (!kept) LOG("segment removed without an orderly close");
+    if (!reused) LOG("left-over segment still closed after re-attaching");
+    if (!removed) LOG("segment still present after close");
+    return kept && reused && removed;
+}
+
+bool test_oversized_frame_rejected() {
+    string name = test_name("oversize");
+    ShmFrameQueue::unlink(name);
+    ShmFrameQueue producer(name, ShmFrameQueue::Role::Producer, 2, 16 * 16 * 3);
+    bool pushed = producer.push(FrameEnvelope(pattern_frame(0), 0, 0));
+    bool dropped = producer.stats().dropped == 1;
+    ShmFrameQueue::unlink(name);
+    return !pushed && dropped;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_frames_cross_process_in_order);
+    RUN_TEST(test_producer_crash_unblocks_consumer);
+    RUN_TEST(test_restarted_producer_reattaches);
+    RUN_TEST(test_segment_kept_until_orderly_close);
+    RUN_TEST(test_oversized_frame_rejected);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,238 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <opencv2/opencv.hpp>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../headers/shm_ingest.h"
+#include "../headers/frame_queue.h"
+#include "../headers/multi_lane_queue.h"
+#include "../headers/yolo_ingest.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static const int kW = 64, kH = 48, kStride = 64 * 3 + 32;
+
+static string test_name(const string& suffix) {
+    return "/yolo_ingest_test_" + to_string(getpid()) + "_" + suffix;
+}
+
+static uchar pattern(int seed, int r, int c) {
+    return static_cast<uchar>((seed + r + c) & 0xFF);
+}
+
+// Writes frame `seed` into a slot the way an external producer would: through
+// the C API only, rows kStride bytes apart.
+static bool publish(yolo_ingest& q, int seed, int timeout_ms = 1000) {
+    uint8_t* pixels = nullptr;
+    int slot = yolo_ingest_acquire(&q, timeout_ms, &pixels);
+    if (slot < 0) return false;
+    for (int r = 0; r < kH; ++r)
+        for (int c = 0; c < kW * 3; ++c)
+            pixels[r * kStride + c] = pattern(seed, r, c);
+    return yolo_ingest_publish(&q, slot, kW, kH, kStride, seed * 10.0) == 0;
+}
+
+// Child process: publish n frames, then either close the stream or die.
+static void run_child_producer(const string& name, int n, bool crash) {
+    yolo_ingest q;
+    if (yolo_ingest_open(&q, name.c_str(), YOLO_INGEST_PRODUCER, 4, kH * kStride) != 0) _exit(2);
+    for (int i = 0; i < n; ++i) {
+        if (!publish(q, i)) _exit(3);
+    }
+    if (crash) _exit(0);  // never closes the stream
+    yolo_ingest_close(&q);
+    yolo_ingest_detach(&q);
+    _exit(0);
+}
+
+// ---------------- Tests ----------------
+
+bool test_frames_cross_process_without_copy() {
+    string name = test_name("order");
+    shm_unlink(name.c_str());
+    ShmIngestSource source(name, 2, 4, kH * kStride);
+
+    const int n = 40;
+    pid_t pid = fork();
+    if (pid == 0) run_child_producer(name, n, false);
+
+    int received = 0;
+    bool intact = true;
+    FrameEnvelope f;
+    while (source.pop(f)) {
+        // A view into the slot keeps the producer's row stride.
+        if (f.seq != static_cast<uint64_t>(received) || f.source_id != 2 || f.timestamp_ms != received * 10.0 ||
+            f.image.rows != kH || f.image.cols != kW || f.image.step != static_cast<size_t>(kStride)) {
+            intact = false;
+        }
+        for (int r = 0; r < kH && intact; ++r)
+            for (int c = 0; c < kW * 3; ++c)
+                if (f.image.ptr<uchar>(r)[c] != pattern(received, r, c)) intact = false;
+        f.releaseImage();
+        received++;
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if (received != n) LOG("received " << received << " of " << n);
+    if (!intact) LOG("a frame arrived with wrong metadata or pixels");
+    if (source.released() != source.taken()) LOG("slots still held: " << source.taken() - source.released());
+    return received == n && intact && source.released() == static_cast<uint64_t>(n) &&
+           WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+bool test_slots_return_in_any_order() {
+    string name = test_name("release");
+    shm_unlink(name.c_str());
+    yolo_ingest q;
+    if (yolo_ingest_open(&q, name.c_str(), YOLO_INGEST_PRODUCER, 2, kH * kStride) != 0) return false;
+    ShmIngestSource source(name);
+
+    bool ok = publish(q, 0) && publish(q, 1);
+    FrameEnvelope first, second;
+    ok = ok && source.popFor(first, 100) && source.popFor(second, 100);
+    uint8_t* pixels = nullptr;
+    bool full = yolo_ingest_acquire(&q, 0, &pixels) == YOLO_INGEST_TIMEOUT;
+
+    // Releasing the newer frame first frees exactly its slot, which still
+    // holds that frame's pixels.
+    second.releaseImage();
+    int slot = yolo_ingest_acquire(&q, 0, &pixels);
+    bool reused = slot >= 0 && pixels[0] == pattern(1, 0, 0) && first.image.at<uchar>(0, 0) == pattern(0, 0, 0);
+
+    yolo_ingest_close(&q);
+    yolo_ingest_detach(&q);
+    if (!full) LOG("producer found a free slot while both were held");
+    if (!reused) LOG("the released slot was not handed back");
+    return ok && full && reused;
+}
+
+bool test_copies_share_the_slot() {
+    string name = test_name("copies");
+    shm_unlink(name.c_str());
+    yolo_ingest q;
+    if (yolo_ingest_open(&q, name.c_str(), YOLO_INGEST_PRODUCER, 2, kH * kStride) != 0) return false;
+    ShmIngestSource source(name);
+
+    FrameEnvelope frame;
+    bool ok = publish(q, 7) && source.popFor(frame, 100);
+    const uchar* slot_pixels = frame.image.data;
+    FrameQueue queue(4);
+    FrameEnvelope queued;
+    ok = ok && queue.push(frame) && queue.pop(queued);
+    bool shared = queued.image.data == slot_pixels && queued.image.step == static_cast<size_t>(kStride);
+    frame.releaseImage();
+    bool held = source.released() == 0;
+    queued.releaseImage();
+    bool freed = source.released() == 1;
+
+    yolo_ingest_close(&q);
+    yolo_ingest_detach(&q);
+    if (!shared) LOG("FrameQueue copied the pixels out of the slot");
+    if (!held) LOG("slot released while a copy still referenced it");
+    if (!freed) LOG("slot not released after the last copy let go");
+    return ok && shared && held && freed;
+}
+
+// The multi-stream path: ingestProducer pushes into a lane of the input queue.
+bool test_lane_queue_shares_the_slot() {
+    string name = test_name("lanes");
+    shm_unlink(name.c_str());
+    yolo_ingest q;
+    if (yolo_ingest_open(&q, name.c_str(), YOLO_INGEST_PRODUCER, 2, kH * kStride) != 0) return false;
+    ShmIngestSource source(name);
+
+    FrameEnvelope frame;
+    bool ok = publish(q, 3) && source.popFor(frame, 100);
+    const uchar* slot_pixels = frame.image.data;
+    MultiLaneQueue lanes;
+    LaneSink sink(lanes, lanes.addLane({4, DropPolicy::Block, 1}));
+    FrameEnvelope popped;
+    ok = ok && sink.push(frame) && lanes.pop(popped);
+    frame.releaseImage();
+    bool shared = popped.image.data == slot_pixels && source.released() == 0;
+    popped.releaseImage();
+    bool freed = source.released() == 1;
+
+    yolo_ingest_close(&q);
+    yolo_ingest_detach(&q);
+    if (!shared) LOG("the lane copied the pixels out of the slot");
+    return ok && shared && freed;
+}
+
+// ingestProducer must not keep a reference to the frame it handed on: with a
+// one-slot ring that would stop the producer from ever getting the slot back.
+bool test_ingest_producer_keeps_no_slot() {
+    string name = test_name("pin");
+    shm_unlink(name.c_str());
+    yolo_ingest q;
+    if (yolo_ingest_open(&q, name.c_str(), YOLO_INGEST_PRODUCER, 1, kH * kStride) != 0) return false;
+    FrameQueue queue(4);
+    atomic<bool> running(true);
+    thread ingest(ingestProducer, ref(queue), name, 0, ref(running));
+
+    FrameEnvelope popped;
+    bool ok = publish(q, 0) && queue.pop(popped);
+    popped.releaseImage();
+    bool reused = ok && publish(q, 1, 500);
+    ok = reused && queue.pop(popped);
+    popped.releaseImage();
+
+    running = false;
+    yolo_ingest_close(&q);
+    ingest.join();
+    yolo_ingest_detach(&q);
+    if (!reused) LOG("the only slot was still held after the queued frame was released");
+    return ok;
+}
+
+bool test_producer_crash_unblocks_consumer() {
+    string name = test_name("crash");
+    shm_unlink(name.c_str());
+    ShmIngestSource source(name, 0, 4, kH * kStride);
+
+    pid_t pid = fork();
+    if (pid == 0) run_child_producer(name, 2, true);
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    auto start = chrono::steady_clock::now();
+    int received = 0;
+    FrameEnvelope f;
+    while (source.pop(f)) {
+        f.releaseImage();
+        received++;
+    }
+    auto waited = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    shm_unlink(name.c_str());
+
+    if (received != 2) LOG("received " << received << " frames published before the crash");
+    if (waited > 2000) LOG("consumer took " << waited << "ms to notice the crash");
+    return received == 2 && waited <= 2000;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_frames_cross_process_without_copy);
+    RUN_TEST(test_slots_return_in_any_order);
+    RUN_TEST(test_copies_share_the_slot);
+    RUN_TEST(test_lane_queue_shares_the_slot);
+    RUN_TEST(test_ingest_producer_keeps_no_slot);
+    RUN_TEST(test_producer_crash_unblocks_consumer);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,181 @@
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/tracker.h"
+#include "../headers/assignment.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static Detection det(float x, float y, float w, float h, float conf = 0.9f, int cls = 2) {
+    return {cv::Rect2f(x, y, w, h), conf, cls};
+}
+
+static TrackerConfig config(TrackMatch match) {
+    TrackerConfig c;
+    c.match = match;
+    c.match_iou = 0.1f;
+    return c;
+}
+
+static int idAt(const vector<Track>& tracks, float x) {
+    for (const auto& t : tracks) {
+        if (t.box.x == x) return t.id;
+    }
+    return -1;
+}
+
+// ---------------- Tests ----------------
+
+bool test_solver_maximises_summed_score() {
+    // Greedy by row would take (0,0) = 0.9 and leave row 1 with nothing.
+    vector<AssignmentEdge> edges = {{0, 0, 0.9f}, {0, 1, 0.8f}, {1, 0, 0.7f}};
+    vector<int> match = solveAssignment(2, 2, edges);
+    bool ok = match.size() == 2 && match[0] == 1 && match[1] == 0;
+    if (!ok) LOG("match " << match[0] << ", " << match[1]);
+    return ok;
+}
+
+bool test_solver_leaves_unlisted_pairs_unmatched() {
+    // Three rows competing for one column, plus an independent pair and a
+    // row with no edges at all.
+    vector<AssignmentEdge> edges = {{0, 0, 0.5f}, {1, 0, 0.6f}, {2, 0, 0.4f}, {3, 2, 0.3f}};
+    vector<int> match = solveAssignment(5, 3, edges);
+    bool ok = match == vector<int>({-1, 0, -1, 2, -1});
+    if (!ok) LOG("match " << match[0] << " " << match[1] << " " << match[2] << " " << match[3] << " " << match[4]);
+    return ok && solveAssignment(3, 0, {}) == vector<int>(3, -1);
+}
+
+// Two cars, the first moving left and the second right: the first track
+// overlaps where the second car went more than where it went itself, so
+// greedy takes that box and leaves the second track without one.
+bool test_optimal_keeps_ids_where_greedy_mixes_them() {
+    auto run = [](TrackMatch match, int& left_id, int& right_id) {
+        Tracker tracker(config(match));
+        tracker.update({det(0, 0, 100, 100), det(80, 0, 100, 100)});
+        const auto& tracks = tracker.update({det(-60, 0, 100, 100), det(30, 0, 100, 100)});
+        left_id = idAt(tracks, -60);
+        right_id = idAt(tracks, 30);
+    };
+    int greedy_left, greedy_right, optimal_left, optimal_right;
+    run(TrackMatch::Greedy, greedy_left, greedy_right);
+    run(TrackMatch::Optimal, optimal_left, optimal_right);
+
+    if (optimal_left != 1 || optimal_right != 2) LOG("optimal ids " << optimal_left << ", " << optimal_right);
+    if (greedy_right != 1) LOG("greedy ids " << greedy_left << ", " << greedy_right << ", expected a mix-up");
+    return optimal_left == 1 && optimal_right == 2 && greedy_right == 1;
+}
+
+bool test_gates_apply_to_both_modes() {
+    bool ok = true;
+    for (TrackMatch match : {TrackMatch::Greedy, TrackMatch::Optimal}) {
+        Tracker tracker(config(match));
+        tracker.update({det(0, 0, 50, 50), det(500, 0, 50, 50, 0.9f, 3)});
+        // Other class on top of the first track, a weak detection on the
+        // second, and a box far from both.
+        const auto& tracks = tracker.update({det(5, 0, 50, 50, 0.9f, 7), det(505, 0, 50, 50, 0.1f, 3),
+                                             det(1000, 0, 50, 50)});
+        int matched = 0;
+        for (const auto& t : tracks) matched += (t.lost == 0 && t.age > 0);
+        if (matched != 0 || tracks.size() != 4) {
+            LOG("mode " << (match == TrackMatch::Greedy ? "greedy" : "optimal") << ": " << matched
+                << " matched of " << tracks.size() << " tracks");
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool test_many_separate_objects_keep_ids() {
+    vector<Detection> frame0, frame1;
+    for (int i = 0; i < 200; i++) {
+        frame0.push_back(det((i % 20) * 60.0f, (i / 20) * 60.0f, 40, 40));
+        frame1.push_back(det((i % 20) * 60.0f + 5, (i / 20) * 60.0f + 3, 40, 40));
+    }
+    Tracker tracker(config(TrackMatch::Optimal));
+    tracker.update(frame0);
+    const auto& tracks = tracker.update(frame1);
+    bool ok = tracks.size() == 200;
+    for (size_t i = 0; ok && i < tracks.size(); i++) {
+        ok = tracks[i].id == static_cast<int>(i) + 1 && tracks[i].age == 1 && tracks[i].box.x == frame1[i].box.x;
+    }
+    if (!ok) LOG(tracks.size() << " tracks for 200 objects");
+    return ok;
+}
+
+// A car fades to 0.2 (partly occluded) for two frames: with low_conf the
+// second pass keeps matching it, without it the track goes unmatched.
+// The weak box of another car never starts a track.
+bool test_low_confidence_pass_holds_occluded_tracks() {
+    auto run = [](TrackMatch match, float low_conf, int& lost, size_t& count) {
+        TrackerConfig c = config(match);
+        c.low_conf = low_conf;
+        Tracker tracker(c);
+        tracker.update({det(0, 0, 80, 80)});
+        tracker.update({det(4, 0, 80, 80)});
+        tracker.update({det(8, 0, 80, 80, 0.2f), det(300, 0, 80, 80, 0.2f)});
+        const auto& tracks = tracker.update({det(12, 0, 80, 80, 0.2f), det(304, 0, 80, 80, 0.2f)});
+        lost = tracks.empty() ? -1 : tracks[0].lost;
+        count = tracks.size();
+        return tracks.empty() ? 0.0f : tracks[0].box.x;
+    };
+    bool ok = true;
+    for (TrackMatch match : {TrackMatch::Greedy, TrackMatch::Optimal}) {
+        int lost_two_stage, lost_one_stage;
+        size_t count_two_stage, count_one_stage;
+        float x = run(match, 0.1f, lost_two_stage, count_two_stage);
+        run(match, 0.0f, lost_one_stage, count_one_stage);
+        if (lost_two_stage != 0 || x != 12.0f || count_two_stage != 1 || lost_one_stage != 2) {
+            LOG("two-stage: lost " << lost_two_stage << ", x " << x << ", " << count_two_stage
+                << " tracks; one stage: lost " << lost_one_stage);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// A new track has not been confirmed, so a weak detection cannot carry it.
+bool test_low_confidence_pass_skips_unconfirmed_tracks() {
+    TrackerConfig c = config(TrackMatch::Optimal);
+    c.low_conf = 0.1f;
+    Tracker tracker(c);
+    tracker.update({det(0, 0, 80, 80)});
+    const auto& tracks = tracker.update({det(2, 0, 80, 80, 0.2f)});
+    bool ok = tracks.size() == 1 && tracks[0].lost == 1 && tracks[0].age == 0;
+    if (!ok) LOG(tracks.size() << " tracks, lost " << (tracks.empty() ? -1 : tracks[0].lost));
+    return ok;
+}
+
+bool test_parse_track_match() {
+    bool ok = parseTrackMatch("greedy") == TrackMatch::Greedy && parseTrackMatch("optimal") == TrackMatch::Optimal;
+    try {
+        parseTrackMatch("hungarian");
+        ok = false;
+    } catch (const std::invalid_argument&) {
+    }
+    return ok;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_solver_maximises_summed_score);
+    RUN_TEST(test_solver_leaves_unlisted_pairs_unmatched);
+    RUN_TEST(test_optimal_keeps_ids_where_greedy_mixes_them);
+    RUN_TEST(test_gates_apply_to_both_modes);
+    RUN_TEST(test_many_separate_objects_keep_ids);
+    RUN_TEST(test_low_confidence_pass_holds_occluded_tracks);
+    RUN_TEST(test_low_confidence_pass_skips_unconfirmed_tracks);
+    RUN_TEST(test_parse_track_match);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+#include <iostream>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/video_writer.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static VideoWriterConfig config(const string& name, double fps) {
+    VideoWriterConfig c;
+    c.path = "test_videowriter_" + to_string(getpid()) + "_" + name + ".avi";
+    c.codec = "MJPG";
+    c.fps = fps;
+    return c;
+}
+
+static cv::Mat frame() {
+    return cv::Mat::zeros(48, 64, CV_8UC3);
+}
+
+// Writes frames at the given timestamps and reports what went into the file.
+static void encode(const string& name, double fps, const vector<double>& timestamps_ms,
+                   uint64_t& written, uint64_t& repeated) {
+    VideoWriterConfig c = config(name, fps);
+    {
+        VideoEncoder encoder(c);
+        for (double ts : timestamps_ms) encoder.write(frame(), ts, 0.0);
+        encoder.close();
+        written = encoder.written();
+        repeated = encoder.repeated();
+    }
+    remove(c.path.c_str());
+}
+
+// ---------------- Tests ----------------
+
+bool test_gaps_are_filled_with_the_last_frame() {
+    uint64_t written, repeated;
+    // At 10 fps, 100 ms per frame: 400 ms is frame 4, so frames 2 and 3 repeat frame 1.
+    encode("gap", 10.0, {0, 100, 400}, written, repeated);
+    if (written != 3 || repeated != 2) LOG("written " << written << ", repeated " << repeated);
+    return written == 3 && repeated == 2;
+}
+
+bool test_gap_fill_is_capped_at_one_second() {
+    uint64_t written, repeated;
+    // A 5 s jump at 10 fps would need 49 repeats; at most fps + 1 are written.
+    encode("cap", 10.0, {0, 5000}, written, repeated);
+    if (written != 2 || repeated != 11) LOG("written " << written << ", repeated " << repeated);
+    return written == 2 && repeated == 11;
+}
+
+bool test_late_and_unknown_timestamps_only_append() {
+    uint64_t written, repeated;
+    // 50 ms arrives after 100 ms, and -1 has no timestamp: neither fills,
+    // and the timeline picks up again at 300 ms.
+    encode("order", 10.0, {0, 100, 50, -1, 300}, written, repeated);
+    if (written != 5 || repeated != 0) LOG("written " << written << ", repeated " << repeated);
+    return written == 5 && repeated == 0;
+}
+
+// Every frame is either encoded or counted as dropped, and write() says which.
+bool test_drop_policy_accounts_for_every_frame() {
+    VideoWriterConfig c = config("drop", 30.0);
+    c.queue_capacity = 1;
+    c.drop_when_behind = true;
+    const int n = 200;
+    int refused = 0;
+    uint64_t written, dropped;
+    {
+        AsyncVideoWriter writer(c);
+        for (int i = 0; i < n; i++) refused += writer.write(frame(), -1.0, 0.0) ? 0 : 1;
+        writer.close();
+        written = writer.written();
+        dropped = writer.dropped();
+    }
+    remove(c.path.c_str());
+    bool ok = written + dropped == static_cast<uint64_t>(n) && dropped == static_cast<uint64_t>(refused);
+    if (!ok) LOG("written " << written << ", dropped " << dropped << ", refused " << refused << " of " << n);
+    return ok;
+}
+
+bool test_block_policy_never_drops() {
+    VideoWriterConfig c = config("block", 30.0);
+    c.queue_capacity = 1;
+    c.drop_when_behind = false;
+    const int n = 200;
+    bool all_accepted = true;
+    uint64_t written, dropped;
+    {
+        AsyncVideoWriter writer(c);
+        for (int i = 0; i < n; i++) all_accepted = writer.write(frame(), -1.0, 0.0) && all_accepted;
+        writer.close();
+        written = writer.written();
+        dropped = writer.dropped();
+    }
+    remove(c.path.c_str());
+    if (written != static_cast<uint64_t>(n) || dropped != 0) LOG("written " << written << ", dropped " << dropped);
+    return all_accepted && written == static_cast<uint64_t>(n) && dropped == 0;
+}
+
+// A file that cannot be opened must not leave a blocking caller stuck.
+bool test_failed_open_does_not_block() {
+    VideoWriterConfig c = config("fail", 30.0);
+    c.path = "nonexistent_fail_dir/out.avi";
+    c.queue_capacity = 1;
+    c.drop_when_behind = false;
+    AsyncVideoWriter writer(c);
+    for (int i = 0; i < 20; i++) writer.write(frame(), -1.0, 0.0);
+    writer.close();
+    bool ok = writer.failed() && writer.written() == 0 && !writer.write(frame(), -1.0, 0.0);
+    if (!ok) LOG("failed " << writer.failed() << ", written " << writer.written());
+    return ok;
+}
+
+bool test_parse_fourcc() {
+    bool ok = parseFourcc("MJPG") == cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+    for (const char* bad : {"", "MJP", "MJPGX"}) {
+        try {
+            parseFourcc(bad);
+            LOG("accepted '" << bad << "'");
+            ok = false;
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    return ok;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_gaps_are_filled_with_the_last_frame);
+    RUN_TEST(test_gap_fill_is_capped_at_one_second);
+    RUN_TEST(test_late_and_unknown_timestamps_only_append);
+    RUN_TEST(test_drop_policy_accounts_for_every_frame);
+    RUN_TEST(test_block_policy_never_drops);
+    RUN_TEST(test_failed_open_does_not_block);
+    RUN_TEST(test_parse_fourcc);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/work_stealing_pool.h"
+#include "../headers/nms.h"
+#include "../headers/preprocess.h"
+#include "../headers/tracker.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+// ---------------- Tests ----------------
+
+bool test_parallel_for_covers_each_index_once() {
+    WorkStealingPool pool(3);
+    vector<atomic<int>> hits(10007);
+    pool.parallelFor(hits.size(), 64, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++) hits[i]++;
+    });
+    for (size_t i = 0; i < hits.size(); i++) {
+        if (hits[i] != 1) { LOG("index " << i << " hit " << hits[i] << " times"); return false; }
+    }
+    return true;
+}
+
+bool test_nested_parallel_for_completes() {
+    // Inner loops run from pool tasks; the waiting caller must help rather
+    // than block a worker.
+    WorkStealingPool pool(2);
+    atomic<int> sum{0};
+    pool.parallelFor(16, 1, [&](size_t, size_t) {
+        pool.parallelFor(100, 10, [&](size_t b, size_t e) { sum += static_cast<int>(e - b); });
+    });
+    if (sum != 1600) { LOG("sum " << sum); return false; }
+    return true;
+}
+
+bool test_submitted_tasks_run() {
+    WorkStealingPool pool(2);
+    atomic<int> done{0};
+    for (int i = 0; i < 100; i++) pool.submit([&] { done++; });
+    for (int spin = 0; spin < 2000 && done < 100; spin++) this_thread::sleep_for(chrono::milliseconds(1));
+    return done == 100;
+}
+
+bool test_exception_reaches_caller() {
+    WorkStealingPool pool(2);
+    try {
+        pool.parallelFor(100, 10, [](size_t b, size_t) {
+            if (b == 50) throw runtime_error("band failed");
+        });
+    } catch (const runtime_error& e) {
+        return string(e.what()) == "band failed";
+    }
+    LOG("exception was swallowed");
+    return false;
+}
+
+bool test_postprocess_matches_serial() {
+    // 84 x 8400 like YOLOv8n at 640x640, with a few hundred confident anchors.
+    const int rows = 84, cols = 8400;
+    cv::Mat predictions(rows, cols, CV_32F);
+    mt19937 rng(7);
+    uniform_real_distribution<float> pos(0.0f, 600.0f), size(5.0f, 80.0f), conf(0.0f, 1.0f);
+    for (int i = 0; i < cols; i++) {
+        predictions.at<float>(0, i) = pos(rng);
+        predictions.at<float>(1, i) = pos(rng);
+        predictions.at<float>(2, i) = size(rng);
+        predictions.at<float>(3, i) = size(rng);
+        for (int j = 4; j < rows; j++) predictions.at<float>(j, i) = conf(rng) < 0.97f ? 0.0f : conf(rng);
+    }
+    LetterboxTransform lb;
+    lb.source_size = cv::Size(640, 640);
+    WorkStealingPool pool(3);
+    auto serial = postprocess(predictions, lb, 0.25f, 0.45f);
+    auto parallel = postprocess(predictions, lb, 0.25f, 0.45f, &pool);
+    if (serial.empty() || serial.size() != parallel.size()) {
+        LOG("sizes " << serial.size() << " vs " << parallel.size());
+        return false;
+    }
+    for (size_t i = 0; i < serial.size(); i++) {
+        if (serial[i].cls != parallel[i].cls || serial[i].conf != parallel[i].conf ||
+            serial[i].box.x != parallel[i].box.x || serial[i].box.y != parallel[i].box.y) {
+            LOG("detection " << i << " differs");
+            return false;
+        }
+    }
+    return true;
+}
+
+bool test_preprocess_bands_match_serial() {
+    cv::Mat img(480, 640, CV_8UC3);
+    for (int y = 0; y < img.rows; y++) {
+        for (int x = 0; x < img.cols * 3; x++) img.ptr<uchar>(y)[x] = static_cast<uchar>((x * 7 + y * 13) & 0xFF);
+    }
+    WorkStealingPool pool(3);
+    Preprocessor serial(640, 640), banded(640, 640, &pool);
+    LetterboxTransform t1, t2;
+    cv::Mat a = serial.process(img, t1), b = banded.process(img, t2);
+    if (a.total() != b.total() || a.total() != 3u * 640 * 640) { LOG("blob sizes " << a.total() << " / " << b.total()); return false; }
+    return memcmp(a.ptr<float>(), b.ptr<float>(), a.total() * sizeof(float)) == 0;
+}
+
+bool test_tracker_with_pool_matches_serial() {
+    TrackerConfig config;
+    config.allowed_classes.clear();
+    Tracker serial(config), pooled(config);
+    WorkStealingPool pool(2);
+    pooled.setPool(&pool);
+    mt19937 rng(3);
+    uniform_real_distribution<float> pos(0.0f, 1900.0f), jitter(-3.0f, 3.0f);
+    vector<Detection> dets;
+    for (int i = 0; i < 200; i++) dets.push_back({cv::Rect2f(pos(rng), pos(rng), 40, 40), 0.9f, i % 3});
+    for (int frame = 0; frame < 5; frame++) {
+        for (auto& d : dets) { d.box.x += jitter(rng); d.box.y += jitter(rng); }
+        const auto& a = serial.update(dets);
+        const auto& b = pooled.update(dets);
+        if (a.size() != b.size()) { LOG("frame " << frame << " track counts differ"); return false; }
+        for (size_t i = 0; i < a.size(); i++) {
+            if (a[i].id != b[i].id || a[i].age != b[i].age) { LOG("frame " << frame << " track " << i << " differs"); return false; }
+        }
+    }
+    return serial.tracks().size() == 200;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_parallel_for_covers_each_index_once);
+    RUN_TEST(test_nested_parallel_for_completes);
+    RUN_TEST(test_submitted_tasks_run);
+    RUN_TEST(test_exception_reaches_caller);
+    RUN_TEST(test_postprocess_matches_serial);
+    RUN_TEST(test_preprocess_bands_match_serial);
+    RUN_TEST(test_tracker_with_pool_matches_serial);
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
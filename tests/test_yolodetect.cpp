@@ -0,0 +1,215 @@
+#include <cstddef>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "../headers/yolo_detect.h"
+
+using namespace std;
+
+#define LOG(...) do { cerr << __VA_ARGS__ << endl; } while(0)
+#define RUN_TEST(fn) \
+    do { \
+        cout << "Running " << #fn << " ... "; \
+        bool ok = fn(); \
+        if (ok) cout << "[PASS]\n"; else cout << "[FAIL]\n"; \
+        total++; if (ok) passed++; \
+    } while(0)
+
+static const string kModel = "yolov8n.onnx";
+
+static yolo_detection det(float x, float y, float w, float h, float conf, int cls) {
+    return {{x, y, w, h}, conf, cls};
+}
+
+static cv::Mat test_image() {
+    cv::Mat image = cv::Mat::zeros(480, 640, CV_8UC3);
+    cv::rectangle(image, cv::Rect(100, 100, 200, 150), cv::Scalar(200, 180, 160), -1);
+    return image;
+}
+
+// ---------------- Tests ----------------
+
+bool test_errors_are_reported_not_thrown() {
+    yolo_engine* engine = reinterpret_cast<yolo_engine*>(1);
+    yolo_status status = yolo_engine_create("nonexistent_model.onnx", nullptr, &engine);
+    bool reported = status == YOLO_ERROR_MODEL && engine == nullptr &&
+                    string(yolo_last_error()).find("nonexistent_model.onnx") != string::npos;
+
+    int32_t count = 0;
+    bool rejected = yolo_detect(nullptr, nullptr, nullptr, 0, &count) == YOLO_ERROR_INVALID_ARGUMENT &&
+                    yolo_tracker_update(nullptr, nullptr, 0, nullptr, 0, &count) == YOLO_ERROR_INVALID_ARGUMENT;
+
+    if (!reported) LOG("bad model: status " << status << ", message '" << yolo_last_error() << "'");
+    if (!rejected) LOG("null arguments were not rejected");
+    return reported && rejected && yolo_abi_version() == YOLO_ABI_VERSION;
+}
+
+bool test_tracker_keeps_ids_across_frames() {
+    yolo_tracker* tracker = nullptr;
+    if (yolo_tracker_create(nullptr, &tracker) != YOLO_OK) return false;
+
+    // Class 2 (car) is tracked by default, class 0 (person) is not.
+    yolo_track tracks[8];
+    int32_t count = 0;
+    bool ok = true;
+    for (int frame = 0; frame < 3 && ok; frame++) {
+        yolo_detection dets[] = {det(10.0f + frame, 10, 50, 40, 0.9f, 2), det(200, 200, 30, 60, 0.9f, 0)};
+        ok = yolo_tracker_update(tracker, dets, 2, tracks, 8, &count) == YOLO_OK;
+    }
+    bool one_track = ok && count == 1 && tracks[0].id == 1 && tracks[0].cls == 2 && tracks[0].age == 2 &&
+                     tracks[0].box.x == 12.0f;
+    yolo_tracker_destroy(tracker);
+
+    if (!one_track) LOG("count " << count << ", id " << tracks[0].id << ", age " << tracks[0].age);
+    return one_track;
+}
+
+bool test_tracker_reports_all_tracks_beyond_capacity() {
+    yolo_tracker_options options;
+    yolo_tracker_default_options(&options);
+    options.classes = nullptr;  // every class
+    options.class_count = 0;
+    yolo_tracker* tracker = nullptr;
+    if (yolo_tracker_create(&options, &tracker) != YOLO_OK) return false;
+
+    vector<yolo_detection> dets;
+    for (int i = 0; i < 5; i++) dets.push_back(det(i * 100.0f, 0, 50, 50, 0.9f, i));
+    yolo_track tracks[2];
+    int32_t count = 0;
+    bool ok = yolo_tracker_update(tracker, dets.data(), 5, tracks, 2, &count) == YOLO_OK;
+    yolo_tracker_destroy(tracker);
+
+    if (count != 5) LOG("count " << count << " for 5 detections with room for 2");
+    return ok && count == 5 && tracks[0].id == 1 && tracks[1].id == 2;
+}
+
+bool test_options_without_struct_size_are_rejected() {
+    yolo_tracker_options options = {};  // struct_size 0, as from a caller that skipped the defaults
+    options.match_iou = 0.5f;
+    yolo_tracker* tracker = reinterpret_cast<yolo_tracker*>(1);
+    bool rejected = yolo_tracker_create(&options, &tracker) == YOLO_ERROR_INVALID_ARGUMENT && tracker == nullptr;
+
+    // A caller with a larger struct (a newer header) is read up to what
+    // this library knows.
+    struct {
+        yolo_tracker_options known;
+        float newer_field;
+    } larger;
+    yolo_tracker_default_options(&larger.known);
+    larger.known.struct_size = sizeof(larger);
+    larger.newer_field = 1.0f;
+    bool accepted = yolo_tracker_create(&larger.known, &tracker) == YOLO_OK && tracker != nullptr;
+    if (accepted) yolo_tracker_destroy(tracker);
+
+    if (!rejected) LOG("options with struct_size 0 were accepted");
+    if (!accepted) LOG("options from a newer header were rejected: " << yolo_last_error());
+    return rejected && accepted;
+}
+
+bool test_tracker_reports_unmatched_tracks_as_lost() {
+    yolo_tracker* tracker = nullptr;
+    if (yolo_tracker_create(nullptr, &tracker) != YOLO_OK) return false;
+    yolo_track tracks[4];
+    int32_t count = 0;
+    yolo_detection car = det(10, 10, 50, 40, 0.9f, 2);
+    bool ok = yolo_tracker_update(tracker, &car, 1, tracks, 4, &count) == YOLO_OK &&
+              yolo_tracker_update(tracker, nullptr, 0, tracks, 4, &count) == YOLO_OK;
+    bool coasting = ok && count == 1 && tracks[0].lost == 1 && tracks[0].box.x == 10.0f;
+    yolo_tracker_destroy(tracker);
+
+    if (!coasting) LOG("count " << count << ", lost " << (count > 0 ? tracks[0].lost : -1));
+    return coasting;
+}
+
+bool test_tracker_low_conf_option() {
+    yolo_tracker_options options;
+    yolo_tracker_default_options(&options);
+    options.low_conf = 0.1f;
+    yolo_track tracks[4];
+    int32_t lost[2] = {-1, -1};
+    // The same options declared with the original version 2 struct_size
+    // must be accepted and keep the default: no second pass.
+    const uint32_t sizes[2] = {options.struct_size,
+                               static_cast<uint32_t>(offsetof(yolo_tracker_options, grace_lost) + sizeof(int32_t))};
+    for (int i = 0; i < 2; i++) {
+        options.struct_size = sizes[i];
+        yolo_tracker* tracker = nullptr;
+        if (yolo_tracker_create(&options, &tracker) != YOLO_OK) {
+            LOG("struct_size " << sizes[i] << " rejected: " << yolo_last_error());
+            return false;
+        }
+        int32_t count = 0;
+        yolo_detection strong = det(10, 10, 50, 40, 0.9f, 2), weak = det(11, 10, 50, 40, 0.2f, 2);
+        bool ok = yolo_tracker_update(tracker, &strong, 1, tracks, 4, &count) == YOLO_OK &&
+                  yolo_tracker_update(tracker, &strong, 1, tracks, 4, &count) == YOLO_OK &&
+                  yolo_tracker_update(tracker, &weak, 1, tracks, 4, &count) == YOLO_OK;
+        if (ok && count == 1) lost[i] = tracks[0].lost;
+        yolo_tracker_destroy(tracker);
+    }
+
+    options.struct_size = sizes[0];
+    options.match = 7;
+    yolo_tracker* tracker = nullptr;
+    bool rejected = yolo_tracker_create(&options, &tracker) == YOLO_ERROR_INVALID_ARGUMENT && tracker == nullptr;
+
+    if (lost[0] != 0) LOG("the weak detection did not keep the track with low_conf set");
+    if (lost[1] != 1) LOG("a version 2 struct_size read low_conf past its end");
+    if (!rejected) LOG("an unknown match mode was accepted");
+    return lost[0] == 0 && lost[1] == 1 && rejected;
+}
+
+// Needs the model; reading a frame through a padded stride must give the
+// same detections as the compact frame, and a batch the same as singles.
+bool test_strided_and_batched_frames_match() {
+    yolo_engine* engine = nullptr;
+    if (yolo_engine_create(kModel.c_str(), nullptr, &engine) != YOLO_OK) {
+        LOG(yolo_last_error());
+        return false;
+    }
+    cv::Mat compact = test_image();
+    cv::Mat padded(compact.rows, compact.cols + 16, CV_8UC3, cv::Scalar::all(255));
+    compact.copyTo(padded(cv::Rect(0, 0, compact.cols, compact.rows)));
+    cv::Mat strided = padded(cv::Rect(0, 0, compact.cols, compact.rows));
+
+    yolo_image images[2] = {
+        {compact.data, compact.cols, compact.rows, static_cast<int32_t>(compact.step)},
+        {strided.data, strided.cols, strided.rows, static_cast<int32_t>(strided.step)},
+    };
+    yolo_detection single[2][64], batch[2 * 64];
+    int32_t single_counts[2] = {0, 0}, batch_counts[2] = {0, 0};
+    bool ok = yolo_detect(engine, &images[0], single[0], 64, &single_counts[0]) == YOLO_OK &&
+              yolo_detect(engine, &images[1], single[1], 64, &single_counts[1]) == YOLO_OK &&
+              yolo_detect_batch(engine, images, 2, batch, 64, batch_counts) == YOLO_OK;
+    yolo_engine_destroy(engine);
+
+    bool same = ok && single_counts[0] == single_counts[1] && single_counts[0] == batch_counts[0] &&
+                single_counts[0] == batch_counts[1];
+    for (int32_t i = 0; same && i < min(single_counts[0], 64); i++) {
+        same = single[0][i].cls == single[1][i].cls && single[0][i].box.x == single[1][i].box.x &&
+               single[0][i].cls == batch[64 + i].cls;
+    }
+    if (!same) LOG("counts: compact " << single_counts[0] << ", strided " << single_counts[1]
+                   << ", batch " << batch_counts[0] << "/" << batch_counts[1]);
+    return same;
+}
+
+int main() {
+    int passed = 0, total = 0;
+    RUN_TEST(test_errors_are_reported_not_thrown);
+    RUN_TEST(test_tracker_keeps_ids_across_frames);
+    RUN_TEST(test_tracker_reports_all_tracks_beyond_capacity);
+    RUN_TEST(test_options_without_struct_size_are_rejected);
+    RUN_TEST(test_tracker_reports_unmatched_tracks_as_lost);
+    RUN_TEST(test_tracker_low_conf_option);
+    if (ifstream(kModel).good()) {
+        RUN_TEST(test_strided_and_batched_frames_match);
+    } else {
+        cout << "Model not found at " << kModel << ", skipping the inference test\n";
+    }
+
+    cout << "----------------------------------------\n";
+    cout << "Test summary: Passed " << passed << " / " << total << " tests\n";
+    return (passed == total) ? 0 : 1;
+}
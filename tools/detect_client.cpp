@@ -0,0 +1,174 @@
+// Load generator for detect_server: several clients send the same image
+// over their own connections, each keeping a fixed number of requests in
+// flight, and the request latency and throughput are reported. Run it
+// against servers started with different --max-delay-ms / --max-batch to
+// see what batching costs in latency and buys in throughput.
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "../headers/opencv_minimal.h"
+#include "../headers/detect_protocol.h"
+#include "../headers/queue_stats.h"
+using namespace std;
+
+static void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " [options]\n\n"
+         << "  --socket <path>     Server socket. (Default: /tmp/yolo_detect.sock)\n"
+         << "  --clients <int>     Concurrent connections. (Default: 4)\n"
+         << "  --requests <int>    Requests per client. (Default: 200)\n"
+         << "  --inflight <int>    Requests each client keeps outstanding. (Default: 1)\n"
+         << "  --image <path>      Image to send. (Default: a synthetic 1280x720 frame)\n"
+         << "  --shm               Pass frames through shared memory instead of the socket.\n"
+         << "  --help              Show this help message.\n";
+}
+
+struct ClientResult {
+    uint64_t done = 0;
+    uint64_t failed = 0;
+    uint64_t boxes = 0;
+};
+
+// One connection. Frames go out inline or, with shm_name set, as references
+// into a shared-memory object holding the image. The image never changes, so
+// all in-flight requests may point at the same copy.
+static ClientResult runClient(const string& socket_path, const cv::Mat& image, int requests, int inflight,
+                              const string& shm_name, Log2Histogram& latency_us) {
+    ClientResult result;
+    int fd = connectDetectServer(socket_path);
+    if (fd < 0) {
+        cerr << "Error: cannot connect to " << socket_path << endl;
+        result.failed = requests;
+        return result;
+    }
+
+    const size_t frame_bytes = image.total() * image.elemSize();
+    void* shm_base = nullptr;
+    if (!shm_name.empty()) {
+        int shm = shm_open(shm_name.c_str(), O_CREAT | O_RDWR, 0600);
+        size_t bytes = frame_bytes;
+        if (shm < 0 || ftruncate(shm, static_cast<off_t>(bytes)) != 0 ||
+            (shm_base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, shm, 0)) == MAP_FAILED) {
+            cerr << "Error: cannot create shared memory " << shm_name << endl;
+            if (shm >= 0) ::close(shm);
+            ::close(fd);
+            result.failed = requests;
+            return result;
+        }
+        ::close(shm);
+        memcpy(shm_base, image.data, frame_bytes);
+    }
+
+    vector<QueueStats::Clock::time_point> sent(requests);
+    auto send = [&](uint32_t id) {
+        DetectRequest request;
+        request.id = id;
+        request.width = image.cols;
+        request.height = image.rows;
+        request.stride = static_cast<int32_t>(image.cols * 3);
+        if (shm_base) {
+            request.payload = DetectPayload::SharedMemory;
+            strncpy(request.shm_name, shm_name.c_str(), sizeof(request.shm_name) - 1);
+        }
+        sent[id] = QueueStats::Clock::now();
+        return writeFull(fd, &request, sizeof(request)) &&
+               (shm_base || writeFull(fd, image.data, frame_bytes));
+    };
+
+    int next = 0;
+    bool ok = true;
+    while (next < min(inflight, requests) && ok) ok = send(next++);
+    vector<DetectBox> boxes;
+    for (uint64_t received = 0; ok && received < static_cast<uint64_t>(requests); received++) {
+        DetectResponse response;
+        if (!readFull(fd, &response, sizeof(response)) || response.magic != kDetectResponseMagic ||
+            response.id >= static_cast<uint32_t>(requests)) {
+            break;
+        }
+        boxes.resize(response.count);
+        if (response.count > 0 && !readFull(fd, boxes.data(), boxes.size() * sizeof(DetectBox))) break;
+        latency_us.record(QueueStats::elapsedMicros(sent[response.id]));
+        if (response.status == DetectStatus::Ok) {
+            result.done++;
+            result.boxes += response.count;
+        } else {
+            result.failed++;
+        }
+        if (next < requests) ok = send(next++);
+    }
+    result.failed += requests - result.done - result.failed;
+
+    if (shm_base) {
+        munmap(shm_base, frame_bytes);
+        shm_unlink(shm_name.c_str());
+    }
+    ::close(fd);
+    return result;
+}
+
+int main(int argc, char** argv) {
+    string socket_path = "/tmp/yolo_detect.sock", image_path;
+    int clients = 4, requests = 200, inflight = 1;
+    bool use_shm = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--socket" && i + 1 < argc) socket_path = argv[++i];
+        else if (arg == "--clients" && i + 1 < argc) clients = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--requests" && i + 1 < argc) requests = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--inflight" && i + 1 < argc) inflight = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--image" && i + 1 < argc) image_path = argv[++i];
+        else if (arg == "--shm") use_shm = true;
+        else if (arg == "--help") { printUsage(argv[0]); return 0; }
+    }
+
+    cv::Mat image;
+    if (!image_path.empty()) {
+        image = cv::imread(image_path);
+        if (image.empty()) {
+            cerr << "Error: could not read " << image_path << endl;
+            return 1;
+        }
+    } else {
+        image = cv::Mat(720, 1280, CV_8UC3);
+        cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(255));
+    }
+    if (!image.isContinuous()) image = image.clone();
+
+    Log2Histogram latency_us;
+    vector<ClientResult> results(clients);
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int c = 0; c < clients; c++) {
+        string shm_name = use_shm ? "/detect_client_" + to_string(getpid()) + "_" + to_string(c) : string();
+        threads.emplace_back([&, c, shm_name] {
+            results[c] = runClient(socket_path, image, requests, inflight, shm_name, latency_us);
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    ClientResult total;
+    for (const auto& r : results) {
+        total.done += r.done;
+        total.failed += r.failed;
+        total.boxes += r.boxes;
+    }
+    auto lat = latency_us.snapshot();
+    cout << "clients=" << clients << " inflight=" << inflight << (use_shm ? " shm" : " inline")
+         << " image=" << image.cols << "x" << image.rows
+         << " done=" << total.done << " failed=" << total.failed
+         << " throughput=" << (seconds > 0 ? total.done / seconds : 0.0) << " req/s"
+         << " detections/frame=" << (total.done ? static_cast<double>(total.boxes) / total.done : 0.0) << endl;
+    cout << "latency ms mean=" << lat.mean() / 1000.0
+         << " p50<=" << lat.percentile(0.5) / 1000.0
+         << " p99<=" << lat.percentile(0.99) / 1000.0
+         << " max=" << lat.max / 1000.0 << endl;
+    return total.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// Detection server: loads the model once and answers detection requests from
+// other local processes over a Unix domain socket, batching frames from all
+// clients into shared inference calls. See headers/detect_protocol.h.
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <csignal>
+#include "../headers/infer_engine_pool.h"
+#include "../headers/inference_server.h"
+using namespace std;
+
+std::atomic<bool> running(true);
+
+static void signalHandler(int) {
+    running = false;
+}
+
+static void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " --model <path> [options]\n\n"
+         << "  --model <path>         Path to the ONNX model file.\n"
+         << "  --socket <path>        Unix domain socket to listen on. (Default: /tmp/yolo_detect.sock)\n"
+         << "  --sessions <int>       Model sessions, one batch worker each. (Default: 1)\n"
+         << "  --max-batch <int>      Frames per inference call. (Default: 8)\n"
+         << "  --max-delay-ms <ms>    How long a request may wait for others to join its batch. (Default: 2)\n"
+         << "  --conf <float>         Confidence threshold. (Default: 0.25)\n"
+         << "  --nms <float>          NMS IoU threshold. (Default: 0.45)\n"
+         << "  --stats-interval <sec> Print server telemetry every N seconds, 0 to disable. (Default: 5)\n"
+         << "  --help                 Show this help message.\n";
+}
+
+int main(int argc, char** argv) {
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    string model_path;
+    size_t sessions = 1;
+    InferenceServerConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc) model_path = argv[++i];
+        else if (arg == "--socket" && i + 1 < argc) config.socket_path = argv[++i];
+        else if (arg == "--sessions" && i + 1 < argc) sessions = std::stoul(argv[++i]);
+        else if (arg == "--max-batch" && i + 1 < argc) config.max_batch = std::stoi(argv[++i]);
+        else if (arg == "--max-delay-ms" && i + 1 < argc) config.max_delay_ms = std::stod(argv[++i]);
+        else if (arg == "--conf" && i + 1 < argc) config.conf_threshold = std::stof(argv[++i]);
+        else if (arg == "--nms" && i + 1 < argc) config.nms_threshold = std::stof(argv[++i]);
+        else if (arg == "--stats-interval" && i + 1 < argc) config.stats_interval_sec = std::stod(argv[++i]);
+        else if (arg == "--help") { printUsage(argv[0]); return 0; }
+    }
+
+    if (model_path.empty()) {
+        cerr << "Error: --model argument is required." << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    InferEnginePool engines;
+    if (!engines.load(model_path, sessions > 0 ? sessions : 1)) {
+        cerr << "Failed to load model: " << model_path << endl;
+        return 1;
+    }
+
+    InferenceServer server(engines, config);
+    if (!server.start()) {
+        return 1;
+    }
+    server.run(running);
+    return 0;
+}
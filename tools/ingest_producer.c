@@ -0,0 +1,74 @@
+/*
+ * Example external producer for --video shm:<name>: a plain C program that
+ * writes synthetic BGR frames straight into the pipeline's shared-memory
+ * slots through headers/yolo_ingest.h. A capture application does the same
+ * with the buffers it already has.
+ *
+ *     cc -O2 -std=c99 tools/ingest_producer.c -o ingest_producer
+ */
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdlib.h>
+#include "../headers/yolo_ingest.h"
+
+static volatile sig_atomic_t running = 1;
+
+static void on_signal(int sig) {
+    (void)sig;
+    running = 0;
+}
+
+int main(int argc, char** argv) {
+    const char* name = "yolo_ingest";
+    int width = 1280, height = 720, frames = 300, fps = 30, i;
+    long published = 0, dropped = 0;
+    yolo_ingest q;
+
+    for (i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--name") && i + 1 < argc) name = argv[++i];
+        else if (!strcmp(argv[i], "--width") && i + 1 < argc) width = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--height") && i + 1 < argc) height = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--frames") && i + 1 < argc) frames = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--fps") && i + 1 < argc) fps = atoi(argv[++i]);
+        else {
+            printf("Usage: %s [--name id] [--width px] [--height px] [--frames n] [--fps n, 0 for max]\n", argv[0]);
+            return !strcmp(argv[i], "--help") ? 0 : 1;
+        }
+    }
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    int err = yolo_ingest_open(&q, name, YOLO_INGEST_PRODUCER, 8, (uint64_t)width * height * 3);
+    if (err != 0) {
+        fprintf(stderr, "Error: cannot open shared memory '%s': %s\n", name, strerror(-err));
+        return 1;
+    }
+
+    for (i = 0; running && i < frames; i++) {
+        uint8_t* pixels;
+        int y, x, slot;
+        /* A live source would rather drop a frame than fall behind. */
+        slot = yolo_ingest_acquire(&q, fps > 0 ? 1000 / fps : -1, &pixels);
+        if (slot == YOLO_INGEST_CLOSED) break;
+        if (slot < 0) {
+            dropped++;
+            continue;
+        }
+        for (y = 0; y < height; y++) {
+            uint8_t* row = pixels + (size_t)y * width * 3;
+            for (x = 0; x < width; x++) {
+                row[3 * x] = (uint8_t)(x + i);
+                row[3 * x + 1] = (uint8_t)(y + i);
+                row[3 * x + 2] = (uint8_t)(x ^ y);
+            }
+        }
+        yolo_ingest_publish(&q, slot, width, height, width * 3, fps > 0 ? i * 1000.0 / fps : -1.0);
+        published++;
+        if (fps > 0) usleep(1000000 / fps);
+    }
+
+    yolo_ingest_close(&q);
+    yolo_ingest_detach(&q);
+    printf("Producer finished: %ld frames published, %ld dropped waiting for a free slot\n", published, dropped);
+    return 0;
+}
@@ -0,0 +1,81 @@
+// Inference process: attaches to a ShmFrameQueue filled by shm_producer and
+// runs the normal consumer pipeline on the frames it receives.
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <csignal>
+#include "../headers/infer_engine.h"
+#include "../headers/shm_frame_queue.h"
+#include "../headers/stages.h"
+using namespace std;
+
+std::atomic<bool> running(true);
+
+static void signalHandler(int) {
+    running = false;
+}
+
+static void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " --model <path> [options]\n\n"
+         << "  --model <path>         Path to the ONNX model file.\n"
+         << "  --name <id>            Shared-memory queue name. (Default: yolo_frames)\n"
+         << "  --conf <float>         Confidence threshold. (Default: 0.25)\n"
+         << "  --nms <float>          NMS IoU threshold. (Default: 0.45)\n"
+         << "  --stats-interval <sec> Print queue telemetry every N seconds. (Default: 5)\n"
+         << "  --headless             No window, nothing drawn or encoded unless --output is given.\n"
+         << "  --output <path>        Write the annotated video here. (Default: output.mp4)\n"
+         << "  --reattach <sec>       Wait this long for a restarted producer. (Default: 30)\n"
+         << "  --help                 Show this help message.\n";
+}
+
+int main(int argc, char** argv) {
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    string model_path, name = "yolo_frames";
+    float conf_threshold = 0.25f, nms_threshold = 0.45f;
+    double stats_interval_sec = 5.0, reattach_sec = 30.0;
+    OutputOptions output;
+    bool headless = false, output_given = false;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--model" && i + 1 < argc) model_path = argv[++i];
+        else if (arg == "--name" && i + 1 < argc) name = argv[++i];
+        else if (arg == "--conf" && i + 1 < argc) conf_threshold = std::stof(argv[++i]);
+        else if (arg == "--nms" && i + 1 < argc) nms_threshold = std::stof(argv[++i]);
+        else if (arg == "--stats-interval" && i + 1 < argc) stats_interval_sec = std::stod(argv[++i]);
+        else if (arg == "--headless") headless = true;
+        else if (arg == "--reattach" && i + 1 < argc) reattach_sec = std::stod(argv[++i]);
+        else if (arg == "--output" && i + 1 < argc) { output.video.path = argv[++i]; output_given = true; }
+        else if (arg == "--help") { printUsage(argv[0]); return 0; }
+    }
+
+    output.display = !headless;
+    output.encode = output_given || !headless;
+
+    if (model_path.empty()) {
+        cerr << "Error: --model argument is required." << endl;
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    InferEngine engine;
+    if (!engine.loadModel(model_path)) {
+        cerr << "Failed to load model: " << model_path << endl;
+        return 1;
+    }
+
+    try {
+        ShmFrameQueue queue(name, ShmFrameQueue::Role::Consumer);
+        queue.setReattachTimeout(static_cast<int>(reattach_sec * 1000));
+        cout << "Consuming frames from shared memory '" << name << "'" << endl;
+        FrameSkipController skip{FrameSkipConfig()};
+        consumer(queue, engine, running, conf_threshold, nms_threshold, stats_interval_sec, output, skip,
+                 TrackerConfig(), nullptr);
+    } catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,68 @@
+// Decoder process: reads a video and publishes its frames into a shared-memory
+// ShmFrameQueue for a separate shm_consumer process to run inference on.
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <csignal>
+#include "../headers/shm_frame_queue.h"
+#include "../headers/stages.h"
+using namespace std;
+
+std::atomic<bool> running(true);
+
+static void signalHandler(int) {
+    running = false;
+}
+
+static void printUsage(const char* prog) {
+    cout << "Usage: " << prog << " [options]\n\n"
+         << "  --name <id>         Shared-memory queue name. (Default: yolo_frames)\n"
+         << "  --video <path>      Video file or '0' for webcam. (Default: data/sample_video.mp4)\n"
+         << "  --pace <mode>       max, realtime or fixed=N. (Default: max)\n"
+         << "  --slots <int>       Number of frame slots. (Default: 8)\n"
+         << "  --slot-bytes <int>  Max bytes per frame. (Default: 1920*1080*3)\n"
+         << "  --reattach <sec>    Wait this long for a restarted consumer. (Default: 30)\n"
+         << "  --help              Show this help message.\n";
+}
+
+int main(int argc, char** argv) {
+    signal(SIGINT, signalHandler);
+    signal(SIGTERM, signalHandler);
+
+    string name = "yolo_frames", video_path = "data/sample_video.mp4";
+    size_t slots = 8, slot_bytes = 1920 * 1080 * 3;
+    double reattach_sec = 30.0;
+    Pacing pacing;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--name" && i + 1 < argc) name = argv[++i];
+        else if (arg == "--video" && i + 1 < argc) video_path = argv[++i];
+        else if (arg == "--pace" && i + 1 < argc) {
+            try {
+                pacing = parsePacing(argv[++i]);
+            } catch (const std::exception& e) {
+                cerr << "Error: invalid --pace: " << e.what() << endl;
+                return 1;
+            }
+        }
+        else if (arg == "--slots" && i + 1 < argc) slots = std::stoul(argv[++i]);
+        else if (arg == "--slot-bytes" && i + 1 < argc) slot_bytes = std::stoul(argv[++i]);
+        else if (arg == "--reattach" && i + 1 < argc) reattach_sec = std::stod(argv[++i]);
+        else if (arg == "--help") { printUsage(argv[0]); return 0; }
+    }
+
+    try {
+        ShmFrameQueue queue(name, ShmFrameQueue::Role::Producer, slots, slot_bytes);
+        queue.setReattachTimeout(static_cast<int>(reattach_sec * 1000));
+        cout << "Publishing frames to shared memory '" << name << "' ("
+             << queue.slotCount() << " slots x " << queue.slotBytes() << " bytes)" << endl;
+        producer(queue, video_path, running, pacing, 1);
+        queue.close();
+        queue.reportStats(cout);
+    } catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}